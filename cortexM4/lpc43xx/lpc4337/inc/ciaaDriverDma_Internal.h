@@ -0,0 +1,116 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERDMA_INTERNAL_H_
+#define _CIAADRIVERDMA_INTERNAL_H_
+/** \brief Internal Header file of the GPDMA shared by the LPC4337 Drivers
+ **
+ ** The GPDMA controller and its interrupt are shared by the drivers, each
+ ** driver gets its channels with Chip_GPDMA_GetFreeChannel and provides an
+ ** handler called from the common interrupt.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+#include "ciaaPOSIX_stdbool.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief owners of the request lines of the DMAMUX
+ **
+ ** Each line selects one of the peripherals requesting it, e.g. line 3 is
+ ** the match 0 of TIMER1 or the transmitter of UART1.
+ **/
+#define CIAADRVDMA_OWNER_NONE    0
+#define CIAADRVDMA_OWNER_UART    1
+#define CIAADRVDMA_OWNER_DIO     2
+
+/** \brief count of request lines of the DMAMUX */
+#define CIAADRVDMA_LINES         16
+
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/** \brief initializes the GPDMA controller and its interrupt
+ **
+ ** May be called by each driver using the GPDMA, only the first call
+ ** initializes the controller.
+ **/
+extern void ciaaDriverDma_init(void);
+
+/** \brief takes a request line of the DMAMUX
+ **
+ ** \param[in] line      0 to CIAADRVDMA_LINES - 1
+ ** \param[in] owner     one of CIAADRVDMA_OWNER_*
+ ** \return true if the line was free or already taken by owner
+ **/
+extern bool ciaaDriverDma_takeLine(uint8_t line, uint8_t owner);
+
+/** \brief gives a request line of the DMAMUX back, if taken by owner
+ **
+ ** \param[in] line      0 to CIAADRVDMA_LINES - 1
+ ** \param[in] owner     one of CIAADRVDMA_OWNER_*
+ **/
+extern void ciaaDriverDma_giveLine(uint8_t line, uint8_t owner);
+
+/** \brief GPDMA interrupt handler of the AIO Driver */
+extern void ciaaDriverAio_dmaIRQHandler(void);
+
+/** \brief GPDMA interrupt handler of the UART Driver */
+extern void ciaaDriverUart_dmaIRQHandler(void);
+
+/** \brief GPDMA interrupt handler of the DIO Driver */
+extern void ciaaDriverDio_dmaIRQHandler(void);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERDMA_INTERNAL_H_ */
+
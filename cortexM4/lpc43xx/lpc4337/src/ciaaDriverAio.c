@@ -57,6 +57,13 @@
 
 /*==================[inclusions]=============================================*/
 #include "ciaaDriverAio.h"
+#include "ciaaDriverAio_Ioctl.h"
+#include "ciaaDriverAio_Filter.h"
+#include "ciaaDriverAio_Conv.h"
+#include "ciaaDriverDma_Internal.h"
+#include "ciaaDriverTime_Internal.h"
+#include "ciaaDriverSct_Internal.h"
+#include "ciaaDriverTrace.h"
 #include "ciaaPOSIX_stdio.h"
 #include "ciaaPOSIX_stdlib.h"
 #include "ciaaPOSIX_string.h"
@@ -75,12 +82,88 @@ typedef uint8_t ContextType;
 
 #define AIO_FIFO_SIZE       (16)
 
-typedef struct {
+/** \brief size in samples of the DAC buffer
+ **
+ ** May be overwritten from the makefile to trade RAM for longer waveforms.
+ **/
+#ifndef AIO_DAC_BUFFER_SIZE
+#define AIO_DAC_BUFFER_SIZE (1024)
+#endif
+
+/** \brief max count of transfers of a single GPDMA descriptor */
+#define AIO_DMA_MAX_TRANSFER (4095)
+
+/** \brief count of GPDMA descriptors needed to cover the DAC buffer */
+#define AIO_DAC_LLI_COUNT   ((AIO_DAC_BUFFER_SIZE + AIO_DMA_MAX_TRANSFER - 1) / AIO_DMA_MAX_TRANSFER + 1)
+
+/** \brief count of DAC descriptor lists, the circular mode links a new
+ ** table in the second one while the first one is output */
+#define AIO_DAC_LLI_TABLES  (2)
+
+/** \brief size in samples of each ADC DMA buffer
+ **
+ ** May be overwritten from the makefile, shall be even.
+ **/
+#ifndef AIO_ADC_BUFFER_SIZE
+#define AIO_ADC_BUFFER_SIZE (256)
+#endif
+
+/** \brief size of the window comparator event queue of each input
+ **
+ ** May be overwritten from the makefile, shall be a power of two.
+ **/
+#ifndef AIO_WINDOW_EVENTS
+#define AIO_WINDOW_EVENTS   (8)
+#endif
+
+/** \brief window zone before the first compared sample */
+#define AIO_WINDOW_UNKNOWN  (0xff)
+
+/** \brief SCT output starting the conversions of ADC0 */
+#define AIO_SCT_OUT_ADC0    (15)
+/** \brief SCT output starting the conversions of ADC1 */
+#define AIO_SCT_OUT_ADC1    (8)
+
+/** \brief SCT counter control register bits, valid for L and H halves */
+#define AIO_SCT_CTRL_HALT   (1 << 2)
+#define AIO_SCT_CTRL_CLRCTR (1 << 3)
+#define AIO_SCT_CTRL_PRE(n) (((n) & 0xff) << 5)
+
+/** \brief SCT event control register bits */
+#define AIO_SCT_EV_MATCHSEL(n)   ((n) & 0xf)
+#define AIO_SCT_EV_HEVENT        (1 << 4)
+#define AIO_SCT_EV_COMBMODE_MATCH (1 << 12)
+
+typedef struct ciaaDriverAdcControlStruct {
    LPC_ADC_T *handler;                  /** <= adc handler */
    int32_t interrupt;                   /** <= adc interrupt */
    ADC_CLOCK_SETUP_T setup;             /** <= adc setup */
    ADC_RESOLUTION_T resolution;         /** <= adc resolution */
    bool start;                          /** <= adc start conversion flag */
+   uint8_t trigger;                     /** <= CIAADRVAIO_ADC_TRIGGER_* */
+   bool paired;                         /** <= started with the other ADC */
+   struct ciaaDriverAdcControlStruct *pair; /** <= second ADC, only in ADC0 */
+   uint32_t rate;                       /** <= sample rate in Hz */
+   uint32_t period;                     /** <= sample period in core clock ticks */
+   uint64_t first;                      /** <= timestamp of the first conversion */
+   uint32_t sequence;                   /** <= sequence of the next half filled */
+   uint32_t seq[2];                     /** <= sequence of the first sample of each half */
+   ADC_START_MODE_T start_mode;         /** <= hardware start mode */
+   uint8_t sct_counter;                 /** <= sct counter, 0: L, 1: H */
+   uint8_t sct_out;                     /** <= sct output starting conversions */
+   LPC_GPDMA_T *dma_handler;            /** <= dma handler */
+   int32_t dma_interrupt;               /** <= dma interrupt */
+   uint8_t dma_conn;                    /** <= dma connection */
+   uint8_t dma_channel;                 /** <= dma channel */
+   bool busy;                           /** <= dma transfer in progress */
+   uint8_t fill;                        /** <= half being filled by the dma */
+   uint8_t rdHalf;                      /** <= half being read */
+   uint32_t rdPos;                      /** <= next sample to read in rdHalf */
+   bool ready[2];                       /** <= half holds unread samples */
+   uint32_t length;                     /** <= samples in use of the buffer */
+   uint32_t overruns;                   /** <= halves overwritten unread */
+   uint32_t *buffer;                    /** <= raw ADC data registers */
+   DMA_TransferDescriptor_t *lli;       /** <= dma linked list */
 } ciaaDriverAdcControlType;
 
 typedef struct {
@@ -88,6 +171,21 @@ typedef struct {
    LPC_GPDMA_T *dma_handler;            /** <= dma handler */
    int32_t dma_interrupt;               /** <= dma interrupt */
    uint8_t dma_channel;                 /** <= dma channel */
+   bool busy;                           /** <= dma transfer in progress */
+   uint8_t mode;                        /** <= CIAADRVAIO_DAC_MODE_* */
+   uint8_t fill;                        /** <= stream half to be written */
+   uint8_t play;                        /** <= stream half being output */
+   bool ready[2];                       /** <= stream half holds new data */
+   uint32_t filled;                     /** <= samples written to the fill half */
+   uint8_t table;                       /** <= circular table being output */
+   bool swap;                           /** <= the other table is linked after it */
+   uint32_t first[AIO_DAC_LLI_TABLES];  /** <= first sample of each table */
+   uint32_t count[AIO_DAC_LLI_TABLES];  /** <= samples of each table */
+   DMA_TransferDescriptor_t *last[AIO_DAC_LLI_TABLES]; /** <= last descriptor of each table */
+   uint32_t length;                     /** <= samples in use of the buffer */
+   uint32_t underruns;                  /** <= stream halves replayed */
+   uint32_t *buffer;                    /** <= DACR formatted samples */
+   DMA_TransferDescriptor_t *lli;       /** <= dma linked lists, one per table */
 } ciaaDriverDacControlType;
 
 typedef union {
@@ -97,8 +195,19 @@ typedef union {
 
 typedef struct {
    int32_t channel;                     /** <= current channel */
-   uint8_t cnt;                         /** <= count */
+   uint32_t cnt;                        /** <= count */
    uint8_t hwbuf[AIO_FIFO_SIZE];        /** <= buffer */
+   uint64_t hwstamp[AIO_FIFO_SIZE / 2]; /** <= timestamp of each sample in hwbuf */
+   uint32_t hwseq;                      /** <= sequence of the first sample in hwbuf */
+   uint32_t convseq;                    /** <= sequence of the next conversion */
+   bool header;                         /** <= read returns a block header */
+   bool window;                         /** <= window comparator enabled */
+   ciaaDriverAio_windowConfigType windowCfg; /** <= window thresholds */
+   uint8_t zone;                        /** <= current window zone */
+   uint8_t evHead;                      /** <= next event written by the irq */
+   uint8_t evTail;                      /** <= next event read */
+   ciaaDriverAio_windowEventType events[AIO_WINDOW_EVENTS]; /** <= window events */
+   ciaaDriverAio_filterType filter;     /** <= oversampling and filter stage */
    ciaaDriverAdcDacControlType adc_dac; /** <= ADC & DAC control */
 } ciaaDriverAioControlType;
 
@@ -111,6 +220,22 @@ typedef struct {
 /** \brief Buffers */
 ciaaDriverAioControlType aioControl[3];
 
+/** \brief DAC samples, already formatted to the DACR register */
+static uint32_t ciaaDriverAio_dacBuffer[AIO_DAC_BUFFER_SIZE];
+
+/** \brief GPDMA linked lists used to output the DAC buffer
+ **
+ ** AIO_DAC_LLI_COUNT descriptors per table. Descriptors shall be word
+ ** aligned.
+ **/
+static DMA_TransferDescriptor_t ciaaDriverAio_dacLli[AIO_DAC_LLI_TABLES * AIO_DAC_LLI_COUNT] __attribute__ ((aligned (4)));
+
+/** \brief raw ADC data registers collected by DMA, one buffer per ADC */
+static uint32_t ciaaDriverAio_adcBuffer[2][AIO_ADC_BUFFER_SIZE];
+
+/** \brief GPDMA linked lists used to collect the ADC data, one per ADC */
+static DMA_TransferDescriptor_t ciaaDriverAio_adcLli[2][2] __attribute__ ((aligned (4)));
+
 /** \brief Device for ADC 0 */
 static ciaaDevices_deviceType ciaaDriverAio_in0 = {
    "aio/in/0",                     /** <= driver name */
@@ -193,73 +318,753 @@ static void ciaaDriverAio_adcIRQHandler(ciaaDevices_deviceType const * const dev
    NVIC_DisableIRQ(pAioControl->adc_dac.adc.interrupt);
    Chip_ADC_Int_SetChannelCmd(pAioControl->adc_dac.adc.handler, pAioControl->channel, DISABLE);
    Chip_ADC_ReadValue(pAioControl->adc_dac.adc.handler, pAioControl->channel, &dataADC);
+   ciaaDriverTrace_record((device == &ciaaDriverAio_in0) ? CIAADRVTRACE_AIO_IN0 : CIAADRVTRACE_AIO_IN1,
+         dataADC, ciaaDriverTime_get());
 
    if (pAioControl->cnt < AIO_FIFO_SIZE)
    {
+      if (pAioControl->cnt == 0)
+      {
+         pAioControl->hwseq = pAioControl->convseq;
+      }
+      pAioControl->hwstamp[pAioControl->cnt / sizeof(dataADC)] = ciaaDriverTime_get();
       ptr = (uint16_t *) &(pAioControl->hwbuf[pAioControl->cnt]);
       *ptr = dataADC;
       pAioControl->cnt += sizeof(dataADC);
    }
+   /* dropped conversions are counted too */
+   pAioControl->convseq++;
    ciaaDriverAio_rxIndication(device, pAioControl->cnt);
 
    NVIC_EnableIRQ(pAioControl->adc_dac.adc.interrupt);
    Chip_ADC_Int_SetChannelCmd(pAioControl->adc_dac.adc.handler, pAioControl->channel, ENABLE);
 }
 
-static void ciaaDriverAio_dacIRQHandler(ciaaDevices_deviceType const * const device)
+/** \brief starts the SCT counter generating the ADC start signal
+ **
+ ** The SCT runs as two 16 bits counters so each ADC has its own rate. Each
+ ** counter uses two events: one at the limit sets the output and a second
+ ** at half period clears it, so the ADC sees one rising edge per period.
+ ** The H counter is also used by the PWM of the DIO driver, it shall be
+ ** taken before.
+ **
+ ** \param[in] counter    0 for the L counter, 1 for the H counter
+ ** \param[in] out        SCT output connected to the ADC start
+ ** \param[in] rate       conversions per second
+ ** \return the period in SCT clock ticks, the SCT runs at the core clock
+ **/
+static uint32_t ciaaDriverAio_sctStart(uint8_t counter, uint8_t out, uint32_t rate)
+{
+   volatile uint16_t * ctrl = (counter == 0) ? &(LPC_SCT->CTRL_L) : &(LPC_SCT->CTRL_H);
+   uint32_t ticks = Chip_Clock_GetRate(CLK_MX_SCT) / rate;
+   uint32_t pre = ticks >> 16;
+   uint8_t ev = counter * 2;
+   uint32_t hevent = (counter == 0) ? 0 : AIO_SCT_EV_HEVENT;
+
+   ticks /= (pre + 1);
+
+   *ctrl = AIO_SCT_CTRL_HALT | AIO_SCT_CTRL_CLRCTR;
+   *ctrl = AIO_SCT_CTRL_HALT | AIO_SCT_CTRL_PRE(pre);
+
+   if (counter == 0)
+   {
+      LPC_SCT->MATCH[0].L = ticks - 1;
+      LPC_SCT->MATCHREL[0].L = ticks - 1;
+      LPC_SCT->MATCH[1].L = ticks / 2;
+      LPC_SCT->MATCHREL[1].L = ticks / 2;
+      LPC_SCT->LIMIT_L = 1 << ev;
+   }
+   else
+   {
+      LPC_SCT->MATCH[0].H = ticks - 1;
+      LPC_SCT->MATCHREL[0].H = ticks - 1;
+      LPC_SCT->MATCH[1].H = ticks / 2;
+      LPC_SCT->MATCHREL[1].H = ticks / 2;
+      LPC_SCT->LIMIT_H = 1 << ev;
+   }
+
+   LPC_SCT->EVENT[ev].STATE = 1;
+   LPC_SCT->EVENT[ev].CTRL = AIO_SCT_EV_MATCHSEL(0) | hevent | AIO_SCT_EV_COMBMODE_MATCH;
+   LPC_SCT->EVENT[ev + 1].STATE = 1;
+   LPC_SCT->EVENT[ev + 1].CTRL = AIO_SCT_EV_MATCHSEL(1) | hevent | AIO_SCT_EV_COMBMODE_MATCH;
+
+   LPC_SCT->OUT[out].SET = 1 << ev;
+   LPC_SCT->OUT[out].CLR = 1 << (ev + 1);
+
+   /* run */
+   *ctrl = AIO_SCT_CTRL_PRE(pre);
+
+   return ticks * (pre + 1);
+}
+
+/** \brief checks a rate can be generated by an SCT counter
+ **
+ ** \param[in] rate       conversions per second
+ ** \return true if the period fits the 16 bits counter with the 8 bits
+ **         prescaler, about 12 Hz or more at 204 MHz
+ **/
+static bool ciaaDriverAio_sctValidRate(uint32_t rate)
+{
+   return (rate != 0) && (((Chip_Clock_GetRate(CLK_MX_SCT) / rate) >> 16) <= 0xff);
+}
+
+/** \brief stops the SCT counter generating the ADC start signal
+ **
+ ** The H counter is left alone while the DIO driver holds it.
+ **/
+static void ciaaDriverAio_sctStop(uint8_t counter)
+{
+   if (counter == 0)
+   {
+      LPC_SCT->CTRL_L |= AIO_SCT_CTRL_HALT;
+   }
+   else if (ciaaDriverSct_takeH(CIAADRVSCT_OWNER_AIO))
+   {
+      LPC_SCT->CTRL_H |= AIO_SCT_CTRL_HALT;
+      ciaaDriverSct_giveH(CIAADRVSCT_OWNER_AIO);
+   }
+}
+
+/** \brief stops the dma transfer of an ADC */
+static void ciaaDriverAio_adcDmaStop(ciaaDriverAdcControlType * pAdc)
+{
+   Chip_ADC_SetStartMode(pAdc->handler, ADC_NO_START, ADC_TRIGGERMODE_RISING);
+
+   NVIC_DisableIRQ(pAdc->dma_interrupt);
+   if (pAdc->busy)
+   {
+      Chip_GPDMA_Stop(pAdc->dma_handler, pAdc->dma_channel);
+      pAdc->busy = false;
+   }
+   pAdc->fill = 0;
+   pAdc->rdHalf = 0;
+   pAdc->rdPos = 0;
+   pAdc->ready[0] = false;
+   pAdc->ready[1] = false;
+   NVIC_EnableIRQ(pAdc->dma_interrupt);
+}
+
+/** \brief stops the hardware triggered conversions and its dma transfer
+ **
+ ** In paired mode the second ADC is stopped too.
+ **/
+static void ciaaDriverAio_adcStop(ciaaDriverAdcControlType * pAdc)
+{
+   ciaaDriverAio_sctStop(pAdc->sct_counter);
+   ciaaDriverAio_adcDmaStop(pAdc);
+   if (pAdc->pair != NULL)
+   {
+      ciaaDriverAio_adcDmaStop(pAdc->pair);
+   }
+}
+
+/** \brief starts the dma collecting the data registers of an ADC
+ **
+ ** The data is collected in the two halves of the buffer and the start of
+ ** the conversions is armed, but not triggered.
+ **/
+static void ciaaDriverAio_adcDmaStart(ciaaDriverAdcControlType * pAdc)
+{
+   uint32_t half;
+
+   /* conversions are collected by the DMA, not by the ADC irq */
+   NVIC_DisableIRQ(pAdc->interrupt);
+
+   if (pAdc->busy == false)
+   {
+      half = pAdc->length / 2;
+      pAdc->sequence = 0;
+      Chip_GPDMA_InitDescriptor(pAdc->dma_handler, &(pAdc->lli[0]),
+            pAdc->dma_conn, (uint32_t) &(pAdc->buffer[0]), half,
+            GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA, &(pAdc->lli[1]));
+      Chip_GPDMA_InitDescriptor(pAdc->dma_handler, &(pAdc->lli[1]),
+            pAdc->dma_conn, (uint32_t) &(pAdc->buffer[half]), half,
+            GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA, &(pAdc->lli[0]));
+      pAdc->lli[0].ctrl |= GPDMA_DMACCxControl_I;
+      pAdc->lli[1].ctrl |= GPDMA_DMACCxControl_I;
+
+      NVIC_DisableIRQ(pAdc->dma_interrupt);
+      pAdc->dma_channel = Chip_GPDMA_GetFreeChannel(pAdc->dma_handler, pAdc->dma_conn);
+      Chip_GPDMA_SGTransfer(pAdc->dma_handler, pAdc->dma_channel, &(pAdc->lli[0]),
+            GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA);
+      pAdc->busy = true;
+      NVIC_EnableIRQ(pAdc->dma_interrupt);
+   }
+
+   Chip_ADC_SetStartMode(pAdc->handler, pAdc->start_mode, ADC_TRIGGERMODE_RISING);
+}
+
+/** \brief starts the conversions of an ADC
+ **
+ ** In software mode a single conversion is started now. In timer mode the
+ ** data registers are collected by DMA in the two halves of the buffer and
+ ** the conversions are started by the SCT at the configured rate. In
+ ** paired mode both ADCs are armed before the common SCT output is started,
+ ** the second ADC is only started through the first one.
+ **
+ ** \return 0 on success, -1 if the SCT counter is held by the PWM of the
+ **         DIO driver
+ **/
+static int32_t ciaaDriverAio_adcStart(ciaaDriverAdcControlType * pAdc)
+{
+   int32_t ret = 0;
+
+   if (pAdc->trigger == CIAADRVAIO_ADC_TRIGGER_TIMER)
+   {
+      if ((pAdc->paired) && (pAdc->pair == NULL))
+      {
+         /* second ADC of a pair, its data is only collected by DMA */
+         NVIC_DisableIRQ(pAdc->interrupt);
+      }
+      else if ((pAdc->busy == false) && (pAdc->rate != 0) &&
+               (pAdc->sct_counter != 0) && (ciaaDriverSct_takeH(CIAADRVSCT_OWNER_AIO) == false))
+      {
+         ret = -1;
+      }
+      else if ((pAdc->busy == false) && (pAdc->rate != 0))
+      {
+         if (pAdc->pair != NULL)
+         {
+            ciaaDriverAio_adcDmaStart(pAdc->pair);
+         }
+         ciaaDriverAio_adcDmaStart(pAdc);
+         pAdc->period = ciaaDriverAio_sctStart(pAdc->sct_counter, pAdc->sct_out, pAdc->rate);
+         /* the first start edge comes at the end of the first period */
+         pAdc->first = ciaaDriverTime_get() + pAdc->period;
+      }
+   }
+   else
+   {
+      Chip_ADC_SetStartMode(pAdc->handler, ADC_START_NOW, ADC_TRIGGERMODE_RISING);
+   }
+
+   return ret;
+}
+
+/** \brief gets the next sample collected by DMA
+ **
+ ** Shall only be called if pAdc->ready[pAdc->rdHalf] is true.
+ **/
+static uint16_t ciaaDriverAio_adcPop(ciaaDriverAdcControlType * pAdc)
+{
+   uint32_t half = pAdc->length / 2;
+   uint32_t raw;
+
+   raw = pAdc->buffer[pAdc->rdHalf * half + pAdc->rdPos];
+
+   pAdc->rdPos++;
+   if (pAdc->rdPos == half)
+   {
+      pAdc->ready[pAdc->rdHalf] = false;
+      pAdc->rdHalf ^= 1;
+      pAdc->rdPos = 0;
+   }
+
+   return (uint16_t) ADC_DR_RESULT(raw);
+}
+
+/** \brief reads the samples collected by DMA
+ **
+ ** In paired mode the samples of both ADCs are interleaved, first the one
+ ** of ADC0 and then the one of ADC1 converted at the same time.
+ **
+ ** \param[out] header   if not NULL filled with the timing of the first
+ **                       sample read, the size is not set
+ ** \return count of bytes stored in buffer
+ **/
+static int32_t ciaaDriverAio_adcDmaRead(ciaaDriverAdcControlType * pAdc, uint8_t * buffer, uint32_t size,
+      ciaaDriverAio_headerType * header)
+{
+   ciaaDriverAdcControlType * pPair = pAdc->pair;
+   uint32_t frame = (pPair == NULL) ? sizeof(uint16_t) : 2 * sizeof(uint16_t);
+   uint16_t sample;
+   int32_t ret = 0;
+
+   uint32_t half = pAdc->length / 2;
+   uint32_t samples;
+
+   NVIC_DisableIRQ(pAdc->dma_interrupt);
+   if (header != NULL)
+   {
+      /* the conversions are started by the SCT, their time is exact */
+      header->sequence = pAdc->seq[pAdc->rdHalf] + pAdc->rdPos;
+      header->period = pAdc->period;
+      header->timestamp = pAdc->first + (uint64_t) header->sequence * pAdc->period;
+   }
+   /* a single ADC converts whole runs of the ready halves at once */
+   while ((pPair == NULL) && ((ret + frame) <= size) && (pAdc->ready[pAdc->rdHalf]))
+   {
+      samples = half - pAdc->rdPos;
+      if (samples > ((size - ret) / frame))
+      {
+         samples = (size - ret) / frame;
+      }
+      ciaaDriverAio_convRegToInt16((int16_t *) &buffer[ret],
+            &(pAdc->buffer[pAdc->rdHalf * half + pAdc->rdPos]), samples);
+      ret += samples * frame;
+
+      pAdc->rdPos += samples;
+      if (pAdc->rdPos == half)
+      {
+         pAdc->ready[pAdc->rdHalf] = false;
+         pAdc->rdHalf ^= 1;
+         pAdc->rdPos = 0;
+      }
+   }
+   while ((pPair != NULL) && ((ret + frame) <= size) && (pAdc->ready[pAdc->rdHalf]) &&
+          (pPair->ready[pPair->rdHalf]))
+   {
+      sample = ciaaDriverAio_adcPop(pAdc);
+      buffer[ret] = (uint8_t) sample;
+      buffer[ret + 1] = (uint8_t) (sample >> 8);
+      sample = ciaaDriverAio_adcPop(pPair);
+      buffer[ret + 2] = (uint8_t) sample;
+      buffer[ret + 3] = (uint8_t) (sample >> 8);
+      ret += frame;
+   }
+   NVIC_EnableIRQ(pAdc->dma_interrupt);
+
+   return ret;
+}
+
+/** \brief compares a block of samples against the window thresholds
+ **
+ ** Most samples stay in their zone, so only the bounds of the current zone
+ ** are checked and the new zone is only searched on a crossing.
+ **
+ ** \param[in] raw        ADC data registers
+ ** \param[in] count      count of samples
+ ** \param[in] sequence   sequence number of the first sample
+ ** \return count of events queued
+ **/
+static uint32_t ciaaDriverAio_windowScan(ciaaDriverAioControlType * pAioControl,
+      uint32_t const * raw, uint32_t count, uint32_t sequence)
+{
+   ciaaDriverAdcControlType *pAdc = &(pAioControl->adc_dac.adc);
+   ciaaDriverAio_windowConfigType const *cfg = &(pAioControl->windowCfg);
+   ciaaDriverAio_windowEventType *event;
+   int32_t lower = 1;
+   int32_t upper = 0;
+   int32_t sample;
+   uint32_t ret = 0;
+   uint32_t i;
+
+   for (i = 0; i < count; i++)
+   {
+      if (pAioControl->zone != AIO_WINDOW_UNKNOWN)
+      {
+         if (pAioControl->zone == CIAADRVAIO_WINDOW_INSIDE)
+         {
+            lower = cfg->low;
+            upper = cfg->high;
+         }
+         else if (pAioControl->zone == CIAADRVAIO_WINDOW_ABOVE)
+         {
+            lower = (int32_t) cfg->high - cfg->hysteresis;
+            upper = INT32_MAX;
+         }
+         else
+         {
+            lower = INT32_MIN;
+            upper = (int32_t) cfg->low + cfg->hysteresis;
+         }
+
+         /* fast path, the sample stays in its zone */
+         while ((i < count) &&
+                ((sample = ADC_DR_RESULT(raw[i])) >= lower) && (sample <= upper))
+         {
+            i++;
+         }
+         if (i == count)
+         {
+            break;
+         }
+      }
+
+      sample = ADC_DR_RESULT(raw[i]);
+      if (sample > cfg->high)
+      {
+         pAioControl->zone = CIAADRVAIO_WINDOW_ABOVE;
+      }
+      else if (sample < cfg->low)
+      {
+         pAioControl->zone = CIAADRVAIO_WINDOW_BELOW;
+      }
+      else
+      {
+         pAioControl->zone = CIAADRVAIO_WINDOW_INSIDE;
+      }
+
+      if ((uint8_t) (pAioControl->evHead - pAioControl->evTail) < AIO_WINDOW_EVENTS)
+      {
+         event = &(pAioControl->events[pAioControl->evHead & (AIO_WINDOW_EVENTS - 1)]);
+         event->sequence = sequence + i;
+         event->timestamp = pAdc->first + (uint64_t) event->sequence * pAdc->period;
+         event->sample = (uint16_t) sample;
+         event->zone = pAioControl->zone;
+         pAioControl->evHead++;
+         ret++;
+      }
+      else
+      {
+         /* the reader did not keep up, the event is lost */
+         pAdc->overruns++;
+      }
+   }
+
+   return ret;
+}
+
+/** \brief reads the queued window comparator events
+ **
+ ** The irq only writes the free slots of the queue, no lock is needed.
+ **
+ ** \return count of bytes stored in buffer
+ **/
+static int32_t ciaaDriverAio_windowRead(ciaaDriverAioControlType * pAioControl, uint8_t * buffer, uint32_t size)
+{
+   uint32_t ret = 0;
+
+   while (((ret + sizeof(ciaaDriverAio_windowEventType)) <= size) &&
+          (pAioControl->evTail != pAioControl->evHead))
+   {
+      ciaaPOSIX_memcpy(&buffer[ret], &(pAioControl->events[pAioControl->evTail & (AIO_WINDOW_EVENTS - 1)]),
+            sizeof(ciaaDriverAio_windowEventType));
+      pAioControl->evTail++;
+      ret += sizeof(ciaaDriverAio_windowEventType);
+   }
+
+   return ret;
+}
+
+static void ciaaDriverAio_adcDmaIRQHandler(ciaaDevices_deviceType const * const device)
 {
    ciaaDriverAioControlType *pAioControl;
+   ciaaDriverAdcControlType *pAdc;
+   ciaaDriverAdcControlType *pMaster;
+   uint8_t half;
+#ifdef CIAADRVTRACE_SIZE
+   uint32_t loopi;
+#endif
 
    pAioControl = (ciaaDriverAioControlType *) device->layer;
-   NVIC_DisableIRQ(pAioControl->adc_dac.dac.dma_interrupt);
+   pAdc = &(pAioControl->adc_dac.adc);
+
+   if ((pAdc->busy) &&
+       (Chip_GPDMA_Interrupt(pAdc->dma_handler, pAdc->dma_channel) == SUCCESS))
+   {
+      half = pAdc->fill;
+      pAdc->seq[half] = pAdc->sequence;
+#ifdef CIAADRVTRACE_SIZE
+      /* the time of each sample follows from its sequence */
+      for (loopi = 0; loopi < pAdc->length / 2; loopi++)
+      {
+         ciaaDriverTrace_record((device == &ciaaDriverAio_in0) ? CIAADRVTRACE_AIO_IN0 : CIAADRVTRACE_AIO_IN1,
+               (uint16_t) ADC_DR_RESULT(pAdc->buffer[half * (pAdc->length / 2) + loopi]),
+               pAdc->first + (uint64_t) (pAdc->seq[half] + loopi) * pAdc->period);
+      }
+#endif
+      pAdc->sequence += pAdc->length / 2;
+      /* keep the time base running */
+      (void) ciaaDriverTime_get();
+      if ((pAioControl->window) && (pAdc->paired == false))
+      {
+         /* the samples are consumed here, only the crossings are reported */
+         if (ciaaDriverAio_windowScan(pAioControl, &(pAdc->buffer[half * (pAdc->length / 2)]),
+                  pAdc->length / 2, pAdc->seq[half]) > 0)
+         {
+            ciaaDriverAio_rxIndication(device, (uint8_t) (pAioControl->evHead - pAioControl->evTail) *
+                  sizeof(ciaaDriverAio_windowEventType));
+         }
+         pAdc->fill ^= 1;
+      }
+      else
+      {
+         if (pAdc->ready[half])
+         {
+            /* the reader did not keep up, drop its pending data */
+            pAdc->overruns++;
+            pAdc->ready[half ^ 1] = false;
+            pAdc->rdHalf = half;
+            pAdc->rdPos = 0;
+         }
+         pAdc->ready[half] = true;
+         pAdc->fill ^= 1;
 
-   if (Chip_GPDMA_Interrupt(pAioControl->adc_dac.dac.dma_handler, pAioControl->adc_dac.dac.dma_channel) == SUCCESS)
+         if (pAdc->paired == false)
+         {
+            ciaaDriverAio_rxIndication(device, pAdc->length / 2 * sizeof(uint16_t));
+         }
+         else
+         {
+            /* ADC0 is notified once both ADCs completed the same half */
+            pMaster = &(aioControl[0].adc_dac.adc);
+            if ((pMaster->ready[half]) && (pMaster->pair->ready[half]))
+            {
+               ciaaDriverAio_rxIndication(&ciaaDriverAio_in0, pAdc->length / 2 * 2 * sizeof(uint16_t));
+            }
+         }
+      }
+   }
+}
+
+/** \brief stops the DAC dma transfer, if any */
+static void ciaaDriverAio_dacStop(ciaaDriverDacControlType * pDac)
+{
+   NVIC_DisableIRQ(pDac->dma_interrupt);
+   if (pDac->busy)
    {
-      ciaaDriverAio_txConfirmation(device, pAioControl->cnt);
-      Chip_GPDMA_Stop(pAioControl->adc_dac.dac.dma_handler, pAioControl->adc_dac.dac.dma_channel);
+      Chip_GPDMA_Stop(pDac->dma_handler, pDac->dma_channel);
+      pDac->busy = false;
+   }
+   pDac->fill = 0;
+   pDac->play = 0;
+   pDac->ready[0] = false;
+   pDac->ready[1] = false;
+   pDac->filled = 0;
+   pDac->table = 0;
+   pDac->swap = false;
+   NVIC_EnableIRQ(pDac->dma_interrupt);
+}
+
+/** \brief links the GPDMA descriptors of a table of the buffer
+ **
+ ** The samples are split in segments of at most segment samples, each one
+ ** described by a descriptor of the list of the table. In loop mode the
+ ** last descriptor points back to the first one, so the DMA outputs the
+ ** samples without CPU intervention.
+ **
+ ** \param[in] pDac       DAC control
+ ** \param[in] table      list of descriptors used, 0 to AIO_DAC_LLI_TABLES - 1
+ ** \param[in] first      first sample of the buffer to be linked
+ ** \param[in] length     count of samples to be linked
+ ** \param[in] segment    max count of samples per descriptor
+ ** \param[in] irq        if true each segment generates a terminal count irq
+ ** \param[in] loop       if true the list is closed in a loop
+ ** \return the last descriptor of the list
+ **/
+static DMA_TransferDescriptor_t * ciaaDriverAio_dacLink(ciaaDriverDacControlType * pDac,
+      uint8_t table, uint32_t first, uint32_t length, uint32_t segment, bool irq, bool loop)
+{
+   DMA_TransferDescriptor_t * lli = &(pDac->lli[table * AIO_DAC_LLI_COUNT]);
+   uint32_t offset = 0;
+   uint32_t size;
+   uint8_t n = 0;
+
+   while (offset < length)
+   {
+      size = length - offset;
+      if (size > segment)
+      {
+         size = segment;
+      }
+      Chip_GPDMA_InitDescriptor(pDac->dma_handler, &(lli[n]),
+            (uint32_t) &(pDac->buffer[first + offset]), GPDMA_CONN_DAC, size,
+            GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, &(lli[n + 1]));
+      if (irq)
+      {
+         lli[n].ctrl |= GPDMA_DMACCxControl_I;
+      }
+      else
+      {
+         lli[n].ctrl &= ~GPDMA_DMACCxControl_I;
+      }
+      offset += size;
+      n++;
+   }
+
+   if (loop)
+   {
+      lli[n - 1].lli = (uint32_t) &(lli[0]);
    }
    else
    {
-       NVIC_EnableIRQ(pAioControl->adc_dac.dac.dma_interrupt);
+      /* the last descriptor ends the transfer and notifies its end */
+      lli[n - 1].lli = 0;
+      lli[n - 1].ctrl |= GPDMA_DMACCxControl_I;
+   }
+
+   return &(lli[n - 1]);
+}
+
+/** \brief starts the DAC dma transfer of the list of the current table */
+static void ciaaDriverAio_dacStart(ciaaDriverDacControlType * pDac)
+{
+   NVIC_DisableIRQ(pDac->dma_interrupt);
+
+   /* Get the free channel for DMA transfer */
+   pDac->dma_channel = Chip_GPDMA_GetFreeChannel(pDac->dma_handler, GPDMA_CONN_DAC);
+
+   /* Start DMA transfer */
+   Chip_GPDMA_SGTransfer(pDac->dma_handler, pDac->dma_channel, &(pDac->lli[pDac->table * AIO_DAC_LLI_COUNT]),
+         GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA);
+   pDac->busy = true;
+
+   NVIC_EnableIRQ(pDac->dma_interrupt);
+}
+
+/** \brief pre-formats up to count samples to the DACR register
+ **
+ ** \return count of bytes consumed of buffer
+ **/
+static uint32_t ciaaDriverAio_dacFormat(uint32_t * dst, uint8_t const * const buffer,
+      uint32_t size, uint32_t count)
+{
+   uint32_t samples = size / sizeof(uint16_t);
+
+   if (samples > count)
+   {
+      samples = count;
+   }
+   ciaaDriverAio_convInt16ToDac(dst, (int16_t const *) buffer, samples, DAC_BIAS_EN);
+
+   return samples * sizeof(uint16_t);
+}
+
+static void ciaaDriverAio_dacIRQHandler(ciaaDevices_deviceType const * const device)
+{
+   ciaaDriverAioControlType *pAioControl;
+   ciaaDriverDacControlType *pDac;
+   uint32_t source;
+   uint8_t next;
+
+   pAioControl = (ciaaDriverAioControlType *) device->layer;
+   pDac = &(pAioControl->adc_dac.dac);
+
+   if ((pDac->busy) &&
+       (Chip_GPDMA_Interrupt(pDac->dma_handler, pDac->dma_channel) == SUCCESS))
+   {
+      if (pDac->mode == CIAADRVAIO_DAC_MODE_STREAM)
+      {
+         /* the played half is free again, the other one is being output */
+         pDac->ready[pDac->play] = false;
+         pDac->play ^= 1;
+         if (pDac->ready[pDac->play] == false)
+         {
+            /* stale data is output again, the half is not written until
+             * its end, the next write goes to the other half to get back
+             * in phase */
+            pDac->underruns++;
+            pDac->ready[pDac->play] = true;
+            pDac->fill = pDac->play ^ 1;
+            pDac->filled = 0;
+         }
+         ciaaDriverAio_txConfirmation(device, pDac->length / 2 * sizeof(uint16_t));
+      }
+      else if (pDac->mode == CIAADRVAIO_DAC_MODE_CIRCULAR)
+      {
+         /* the last descriptor of the old table is complete, the swap is
+          * done if the channel went on with the new table and not back to
+          * the old one, loaded before it was linked */
+         next = pDac->table ^ 1;
+         source = pDac->dma_handler->CH[pDac->dma_channel].SRCADDR;
+         if ((pDac->swap) &&
+             ((source - (uint32_t) &(pDac->buffer[pDac->first[next]])) < (pDac->count[next] * sizeof(uint32_t))))
+         {
+            pDac->table = next;
+            pDac->swap = false;
+            ciaaDriverAio_txConfirmation(device, pDac->count[next] * sizeof(uint16_t));
+         }
+      }
+      else
+      {
+         Chip_GPDMA_Stop(pDac->dma_handler, pDac->dma_channel);
+         pDac->busy = false;
+         ciaaDriverAio_txConfirmation(device, pAioControl->cnt);
+      }
    }
 }
 
 void ciaa_lpc4337_aio_init(void)
 {
    /* ADC0 Init */
+   ciaaDriverAio_filterInit(&(aioControl[0].filter), NULL);
    aioControl[0].adc_dac.adc.handler = LPC_ADC0;
    aioControl[0].adc_dac.adc.interrupt = ADC0_IRQn;
    aioControl[0].adc_dac.adc.start = false;
+   aioControl[0].adc_dac.adc.trigger = CIAADRVAIO_ADC_TRIGGER_SOFTWARE;
+   aioControl[0].adc_dac.adc.paired = false;
+   aioControl[0].adc_dac.adc.pair = NULL;
+   aioControl[0].adc_dac.adc.rate = 0;
+   aioControl[0].adc_dac.adc.start_mode = ADC_START_ON_CTOUT15;
+   aioControl[0].adc_dac.adc.sct_counter = 0;
+   aioControl[0].adc_dac.adc.sct_out = AIO_SCT_OUT_ADC0;
+   aioControl[0].adc_dac.adc.dma_handler = LPC_GPDMA;
+   aioControl[0].adc_dac.adc.dma_interrupt = DMA_IRQn;
+   aioControl[0].adc_dac.adc.dma_conn = GPDMA_CONN_ADC_0;
+   aioControl[0].adc_dac.adc.busy = false;
+   aioControl[0].adc_dac.adc.length = AIO_ADC_BUFFER_SIZE;
+   aioControl[0].adc_dac.adc.overruns = 0;
+   aioControl[0].adc_dac.adc.period = 0;
+   aioControl[0].header = false;
+   aioControl[0].convseq = 0;
+   aioControl[0].window = false;
+   aioControl[0].adc_dac.adc.buffer = ciaaDriverAio_adcBuffer[0];
+   aioControl[0].adc_dac.adc.lli = ciaaDriverAio_adcLli[0];
    Chip_ADC_Init(aioControl[0].adc_dac.adc.handler, &(aioControl[0].adc_dac.adc.setup));
    aioControl[0].channel = -1;
    Chip_ADC_SetBurstCmd(aioControl[0].adc_dac.adc.handler, DISABLE);
 
    /* ADC1 Init */
+   ciaaDriverAio_filterInit(&(aioControl[1].filter), NULL);
    aioControl[1].adc_dac.adc.handler = LPC_ADC1;
    aioControl[1].adc_dac.adc.interrupt = ADC1_IRQn;
    aioControl[1].adc_dac.adc.start = false;
+   aioControl[1].adc_dac.adc.trigger = CIAADRVAIO_ADC_TRIGGER_SOFTWARE;
+   aioControl[1].adc_dac.adc.paired = false;
+   aioControl[1].adc_dac.adc.pair = NULL;
+   aioControl[1].adc_dac.adc.rate = 0;
+   aioControl[1].adc_dac.adc.start_mode = ADC_START_ON_CTOUT8;
+   aioControl[1].adc_dac.adc.sct_counter = 1;
+   aioControl[1].adc_dac.adc.sct_out = AIO_SCT_OUT_ADC1;
+   aioControl[1].adc_dac.adc.dma_handler = LPC_GPDMA;
+   aioControl[1].adc_dac.adc.dma_interrupt = DMA_IRQn;
+   aioControl[1].adc_dac.adc.dma_conn = GPDMA_CONN_ADC_1;
+   aioControl[1].adc_dac.adc.busy = false;
+   aioControl[1].adc_dac.adc.length = AIO_ADC_BUFFER_SIZE;
+   aioControl[1].adc_dac.adc.overruns = 0;
+   aioControl[1].adc_dac.adc.period = 0;
+   aioControl[1].header = false;
+   aioControl[1].convseq = 0;
+   aioControl[1].window = false;
+   aioControl[1].adc_dac.adc.buffer = ciaaDriverAio_adcBuffer[1];
+   aioControl[1].adc_dac.adc.lli = ciaaDriverAio_adcLli[1];
    Chip_ADC_Init(aioControl[1].adc_dac.adc.handler, &(aioControl[1].adc_dac.adc.setup));
    aioControl[1].channel = -1;
    Chip_ADC_SetBurstCmd(aioControl[1].adc_dac.adc.handler, DISABLE);
 
 
+   /* time base of the block headers */
+   ciaaDriverTime_init();
+   ciaaDriverTrace_init(SystemCoreClock);
+
+   /* SCT Init, used to start the conversions in timer mode */
+   Chip_SCT_Init(LPC_SCT);
+   LPC_SCT->CTRL_L = AIO_SCT_CTRL_HALT;
+   if (ciaaDriverSct_takeH(CIAADRVSCT_OWNER_AIO))
+   {
+      LPC_SCT->CTRL_H = AIO_SCT_CTRL_HALT;
+      ciaaDriverSct_giveH(CIAADRVSCT_OWNER_AIO);
+   }
+
    /* DAC Init */
    aioControl[2].adc_dac.dac.handler = LPC_DAC;
+   aioControl[2].adc_dac.dac.busy = false;
+   aioControl[2].adc_dac.dac.mode = CIAADRVAIO_DAC_MODE_ONESHOT;
+   aioControl[2].adc_dac.dac.length = AIO_DAC_BUFFER_SIZE;
+   aioControl[2].adc_dac.dac.underruns = 0;
+   aioControl[2].adc_dac.dac.buffer = ciaaDriverAio_dacBuffer;
+   aioControl[2].adc_dac.dac.lli = ciaaDriverAio_dacLli;
    Chip_SCU_DAC_Analog_Config(); //select DAC function
    Chip_DAC_Init(aioControl[2].adc_dac.dac.handler); //initialize DAC
    Chip_DAC_SetBias(aioControl[2].adc_dac.dac.handler, DAC_MAX_UPDATE_RATE_400kHz);
    Chip_DAC_SetDMATimeOut(aioControl[2].adc_dac.dac.handler, 0xffff);
-   Chip_DAC_ConfigDAConverterControl(aioControl[2].adc_dac.dac.handler, DAC_CNT_ENA | DAC_DMA_ENA);
+   Chip_DAC_ConfigDAConverterControl(aioControl[2].adc_dac.dac.handler, DAC_DBLBUF_ENA | DAC_CNT_ENA | DAC_DMA_ENA);
 
-   /* Initialize GPDMA controller */
+   /* GPDMA controller, shared with the other drivers */
    aioControl[2].adc_dac.dac.dma_handler = LPC_GPDMA;
-   Chip_GPDMA_Init(aioControl[2].adc_dac.dac.dma_handler);
-
-   /* Setup GPDMA interrupt */
    aioControl[2].adc_dac.dac.dma_interrupt = DMA_IRQn;
-   NVIC_DisableIRQ(aioControl[2].adc_dac.dac.dma_interrupt);
-   NVIC_SetPriority(aioControl[2].adc_dac.dac.dma_interrupt, ((0x01 << 3) | 0x01));
-   NVIC_EnableIRQ(aioControl[2].adc_dac.dac.dma_interrupt);
+   ciaaDriverDma_init();
 }
 
 
@@ -283,12 +1088,17 @@ extern int32_t ciaaDriverAio_close(ciaaDevices_deviceType const * const device)
    {
       NVIC_DisableIRQ(pAioControl->adc_dac.adc.interrupt);
       Chip_ADC_Int_SetChannelCmd(pAioControl->adc_dac.adc.handler, pAioControl->channel, DISABLE);
+      if (pAioControl->adc_dac.adc.trigger == CIAADRVAIO_ADC_TRIGGER_TIMER)
+      {
+         ciaaDriverAio_adcStop(&(pAioControl->adc_dac.adc));
+      }
       ret = 0;
    }
 
    /* Outputs */
    if (device == ciaaDriverAioConst.devices[2])
    {
+      ciaaDriverAio_dacStop(&(pAioControl->adc_dac.dac));
       ret = 0;
    }
 
@@ -298,6 +1108,8 @@ extern int32_t ciaaDriverAio_close(ciaaDevices_deviceType const * const device)
 extern int32_t ciaaDriverAio_ioctl(ciaaDevices_deviceType const * const device, int32_t const request, void * param)
 {
    ciaaDriverAioControlType *pAioControl;
+   ciaaDriverAdcControlType *pAdc1;
+   ciaaDriverAio_windowConfigType const *pWindow;
    uint32_t freq;
    uint32_t value;
    int32_t ret = -1;
@@ -335,7 +1147,11 @@ extern int32_t ciaaDriverAio_ioctl(ciaaDevices_deviceType const * const device,
             }
             if (ret == 0)
             {
-                NVIC_EnableIRQ(pAioControl->adc_dac.adc.interrupt);
+                if (pAioControl->adc_dac.adc.trigger != CIAADRVAIO_ADC_TRIGGER_TIMER)
+                {
+                    /* in timer mode the conversions are collected by dma */
+                    NVIC_EnableIRQ(pAioControl->adc_dac.adc.interrupt);
+                }
                 Chip_ADC_EnableChannel(pAioControl->adc_dac.adc.handler, pAioControl->channel, ENABLE);
                 Chip_ADC_Int_SetChannelCmd(pAioControl->adc_dac.adc.handler, pAioControl->channel, ENABLE);
                 pAioControl->adc_dac.adc.start = true;
@@ -343,9 +1159,165 @@ extern int32_t ciaaDriverAio_ioctl(ciaaDevices_deviceType const * const device,
             break;
 
          case ciaaPOSIX_IOCTL_SET_SAMPLE_RATE:
-            NVIC_DisableIRQ(pAioControl->adc_dac.adc.interrupt);
-            Chip_ADC_SetSampleRate(pAioControl->adc_dac.adc.handler, &(pAioControl->adc_dac.adc.setup), (uint32_t)param);
-            NVIC_EnableIRQ(pAioControl->adc_dac.adc.interrupt);
+            if (pAioControl->adc_dac.adc.trigger == CIAADRVAIO_ADC_TRIGGER_TIMER)
+            {
+               /* the rate of a pair is set through ADC0 */
+               if ((ciaaDriverAio_sctValidRate((uint32_t)param)) && ((uint32_t)param <= ADC_MAX_SAMPLE_RATE) &&
+                   ((pAioControl->adc_dac.adc.paired == false) || (pAioControl->adc_dac.adc.pair != NULL)))
+               {
+                  /* convert as fast as possible, the rate is given by the SCT */
+                  ciaaDriverAio_adcStop(&(pAioControl->adc_dac.adc));
+                  Chip_ADC_SetSampleRate(pAioControl->adc_dac.adc.handler, &(pAioControl->adc_dac.adc.setup), ADC_MAX_SAMPLE_RATE);
+                  pAioControl->adc_dac.adc.rate = (uint32_t)param;
+                  ret = 0;
+               }
+            }
+            else
+            {
+               NVIC_DisableIRQ(pAioControl->adc_dac.adc.interrupt);
+               Chip_ADC_SetSampleRate(pAioControl->adc_dac.adc.handler, &(pAioControl->adc_dac.adc.setup), (uint32_t)param);
+               pAioControl->adc_dac.adc.rate = (uint32_t)param;
+               NVIC_EnableIRQ(pAioControl->adc_dac.adc.interrupt);
+            }
+            break;
+
+         case CIAADRVAIO_IOCTL_SET_ADC_TRIGGER:
+            if (pAioControl->adc_dac.adc.paired)
+            {
+               /* paired ADCs are always hardware triggered */
+               break;
+            }
+            switch((int32_t)param)
+            {
+               case CIAADRVAIO_ADC_TRIGGER_SOFTWARE:
+                  ciaaDriverAio_adcStop(&(pAioControl->adc_dac.adc));
+                  pAioControl->adc_dac.adc.trigger = CIAADRVAIO_ADC_TRIGGER_SOFTWARE;
+                  /* the window is only compared in timer mode */
+                  pAioControl->window = false;
+                  if (pAioControl->adc_dac.adc.start == true)
+                  {
+                     NVIC_EnableIRQ(pAioControl->adc_dac.adc.interrupt);
+                  }
+                  ret = 0;
+                  break;
+               case CIAADRVAIO_ADC_TRIGGER_TIMER:
+                  ciaaDriverAio_adcStop(&(pAioControl->adc_dac.adc));
+                  pAioControl->adc_dac.adc.trigger = CIAADRVAIO_ADC_TRIGGER_TIMER;
+                  pAioControl->adc_dac.adc.overruns = 0;
+                  if (pAioControl->adc_dac.adc.rate > ADC_MAX_SAMPLE_RATE)
+                  {
+                     pAioControl->adc_dac.adc.rate = ADC_MAX_SAMPLE_RATE;
+                  }
+                  else if (ciaaDriverAio_sctValidRate(pAioControl->adc_dac.adc.rate) == false)
+                  {
+                     /* not started until a valid rate is set */
+                     pAioControl->adc_dac.adc.rate = 0;
+                  }
+                  Chip_ADC_SetSampleRate(pAioControl->adc_dac.adc.handler, &(pAioControl->adc_dac.adc.setup), ADC_MAX_SAMPLE_RATE);
+                  ret = 0;
+                  break;
+            }
+            break;
+
+         case CIAADRVAIO_IOCTL_SET_ADC_LENGTH:
+            value = (uint32_t) param;
+            if ((value >= 2) && (value <= AIO_ADC_BUFFER_SIZE) &&
+                ((value % 2) == 0) && ((value / 2) <= AIO_DMA_MAX_TRANSFER) &&
+                ((pAioControl->adc_dac.adc.paired == false) || (pAioControl->adc_dac.adc.pair != NULL)))
+            {
+               ciaaDriverAio_adcStop(&(pAioControl->adc_dac.adc));
+               pAioControl->adc_dac.adc.length = value;
+               if (pAioControl->adc_dac.adc.pair != NULL)
+               {
+                  pAioControl->adc_dac.adc.pair->length = value;
+               }
+               ret = 0;
+            }
+            break;
+
+         case CIAADRVAIO_IOCTL_SET_ADC_PAIRED:
+            if (device == ciaaDriverAioConst.devices[0])
+            {
+               pAdc1 = &(aioControl[1].adc_dac.adc);
+               ciaaDriverAio_adcStop(&(pAioControl->adc_dac.adc));
+               ciaaDriverAio_sctStop(pAdc1->sct_counter);
+               ciaaDriverAio_adcDmaStop(pAdc1);
+               if ((bool)(intptr_t)param == false)
+               {
+                  pAioControl->adc_dac.adc.paired = false;
+                  pAioControl->adc_dac.adc.pair = NULL;
+                  pAdc1->paired = false;
+                  pAdc1->start_mode = ADC_START_ON_CTOUT8;
+               }
+               else
+               {
+                  /* both ADCs are started by the SCT output of ADC0 */
+                  pAioControl->window = false;
+                  aioControl[1].window = false;
+                  pAioControl->adc_dac.adc.trigger = CIAADRVAIO_ADC_TRIGGER_TIMER;
+                  pAioControl->adc_dac.adc.paired = true;
+                  pAioControl->adc_dac.adc.pair = pAdc1;
+                  pAioControl->adc_dac.adc.overruns = 0;
+                  pAdc1->trigger = CIAADRVAIO_ADC_TRIGGER_TIMER;
+                  pAdc1->paired = true;
+                  pAdc1->pair = NULL;
+                  pAdc1->overruns = 0;
+                  pAdc1->start_mode = pAioControl->adc_dac.adc.start_mode;
+                  pAdc1->length = pAioControl->adc_dac.adc.length;
+                  Chip_ADC_SetSampleRate(pAioControl->adc_dac.adc.handler, &(pAioControl->adc_dac.adc.setup), ADC_MAX_SAMPLE_RATE);
+                  Chip_ADC_SetSampleRate(pAdc1->handler, &(pAdc1->setup), ADC_MAX_SAMPLE_RATE);
+                  if (pAioControl->adc_dac.adc.rate > ADC_MAX_SAMPLE_RATE)
+                  {
+                     pAioControl->adc_dac.adc.rate = ADC_MAX_SAMPLE_RATE;
+                  }
+                  else if (ciaaDriverAio_sctValidRate(pAioControl->adc_dac.adc.rate) == false)
+                  {
+                     pAioControl->adc_dac.adc.rate = 0;
+                  }
+                  NVIC_DisableIRQ(pAdc1->interrupt);
+               }
+               ret = 0;
+            }
+            break;
+
+         case CIAADRVAIO_IOCTL_SET_FILTER:
+            ret = ciaaDriverAio_filterInit(&(pAioControl->filter), (ciaaDriverAio_filterConfigType const *) param);
+            break;
+
+         case CIAADRVAIO_IOCTL_SET_HEADER:
+            pAioControl->header = (bool)(intptr_t)param;
+            ret = 0;
+            break;
+
+         case CIAADRVAIO_IOCTL_SET_WINDOW:
+            pWindow = (ciaaDriverAio_windowConfigType const *) param;
+            /* the window is compared by the dma irq, only in timer mode */
+            if ((pAioControl->adc_dac.adc.paired == false) &&
+                ((pWindow == NULL) || ((pWindow->low <= pWindow->high) &&
+                 (pAioControl->adc_dac.adc.trigger == CIAADRVAIO_ADC_TRIGGER_TIMER))))
+            {
+               NVIC_DisableIRQ(pAioControl->adc_dac.adc.dma_interrupt);
+               if (pWindow != NULL)
+               {
+                  pAioControl->windowCfg = *pWindow;
+               }
+               pAioControl->window = (pWindow != NULL);
+               pAioControl->zone = AIO_WINDOW_UNKNOWN;
+               pAioControl->evHead = 0;
+               pAioControl->evTail = 0;
+               /* samples are only read from the halves filled from now on */
+               pAioControl->adc_dac.adc.ready[0] = false;
+               pAioControl->adc_dac.adc.ready[1] = false;
+               pAioControl->adc_dac.adc.rdHalf = pAioControl->adc_dac.adc.fill;
+               pAioControl->adc_dac.adc.rdPos = 0;
+               NVIC_EnableIRQ(pAioControl->adc_dac.adc.dma_interrupt);
+               ret = 0;
+            }
+            break;
+
+         case CIAADRVAIO_IOCTL_GET_ADC_OVERRUNS:
+            *((uint32_t *) param) = pAioControl->adc_dac.adc.overruns;
+            ret = 0;
             break;
 
          case ciaaPOSIX_IOCTL_SET_RESOLUTION:
@@ -407,9 +1379,10 @@ extern int32_t ciaaDriverAio_ioctl(ciaaDevices_deviceType const * const device,
             }
             break;
       }
-      if (pAioControl->adc_dac.adc.start == true)
+      if ((pAioControl->adc_dac.adc.start == true) &&
+          (ciaaDriverAio_adcStart(&(pAioControl->adc_dac.adc)) != 0))
       {
-         Chip_ADC_SetStartMode(pAioControl->adc_dac.adc.handler, ADC_START_NOW, ADC_TRIGGERMODE_RISING);
+         ret = -1;
       }
    }
 
@@ -435,22 +1408,57 @@ extern int32_t ciaaDriverAio_ioctl(ciaaDevices_deviceType const * const device,
 
          case ciaaPOSIX_IOCTL_SET_SAMPLE_RATE:
             freq = (uint32_t) param;
-            if (freq < 7)
+            if ((freq == 0) || (freq > 1000000))
+            {
+               /* the DAC can not be updated faster than 1 MHz */
+               break;
+            }
+            /* the DMA timeout counter runs at the DAC peripheral clock */
+            value = Chip_Clock_GetRate(CLK_APB3_DAC) / freq;
+            if (value > 0xffff)
             {
-                value = 0xffff;
-                Chip_DAC_SetBias(pAioControl->adc_dac.dac.handler, DAC_MAX_UPDATE_RATE_400kHz);
+               value = 0xffff;
             }
-            else if ((freq >= 7) && (freq < 400000))
+            if (freq <= 400000)
             {
-                value = 400000 / freq;
-                Chip_DAC_SetBias(pAioControl->adc_dac.dac.handler, DAC_MAX_UPDATE_RATE_400kHz);
+               Chip_DAC_SetBias(pAioControl->adc_dac.dac.handler, DAC_MAX_UPDATE_RATE_400kHz);
             }
             else
             {
-                value = 10000000 / freq;
-                Chip_DAC_SetBias(pAioControl->adc_dac.dac.handler, DAC_MAX_UPDATE_RATE_1MHz);
+               Chip_DAC_SetBias(pAioControl->adc_dac.dac.handler, DAC_MAX_UPDATE_RATE_1MHz);
             }
             Chip_DAC_SetDMATimeOut(pAioControl->adc_dac.dac.handler, value);
+            ret = 0;
+            break;
+
+         case CIAADRVAIO_IOCTL_SET_DAC_MODE:
+            switch((int32_t)param)
+            {
+               case CIAADRVAIO_DAC_MODE_ONESHOT:
+               case CIAADRVAIO_DAC_MODE_CIRCULAR:
+               case CIAADRVAIO_DAC_MODE_STREAM:
+                  ciaaDriverAio_dacStop(&(pAioControl->adc_dac.dac));
+                  pAioControl->adc_dac.dac.mode = (uint8_t)(int32_t)param;
+                  ret = 0;
+                  break;
+            }
+            break;
+
+         case CIAADRVAIO_IOCTL_SET_DAC_LENGTH:
+            value = (uint32_t) param;
+            /* each half shall fit in a single descriptor */
+            if ((value >= 2) && (value <= AIO_DAC_BUFFER_SIZE) &&
+                ((value % 2) == 0) && ((value / 2) <= AIO_DMA_MAX_TRANSFER))
+            {
+               ciaaDriverAio_dacStop(&(pAioControl->adc_dac.dac));
+               pAioControl->adc_dac.dac.length = value;
+               ret = 0;
+            }
+            break;
+
+         case CIAADRVAIO_IOCTL_GET_DAC_UNDERRUNS:
+            *((uint32_t *) param) = pAioControl->adc_dac.dac.underruns;
+            ret = 0;
             break;
       }
    }
@@ -460,7 +1468,11 @@ extern int32_t ciaaDriverAio_ioctl(ciaaDevices_deviceType const * const device,
 extern int32_t ciaaDriverAio_read(ciaaDevices_deviceType const * const device, uint8_t* buffer, uint32_t size)
 {
    ciaaDriverAioControlType *pAioControl;
+   ciaaDriverAio_headerType header;
+   ciaaDriverAio_headerType *pHeader = NULL;
+   uint8_t *data = buffer;
    int32_t ret = -1;
+   uint32_t first = 0;
    uint8_t i;
 
    if (size != 0)
@@ -471,28 +1483,99 @@ extern int32_t ciaaDriverAio_read(ciaaDevices_deviceType const * const device, u
       {
          pAioControl = (ciaaDriverAioControlType *) device->layer;
 
-         if (size > pAioControl->cnt)
+         if (pAioControl->window)
          {
-            /* buffer has enough space */
-            ret = pAioControl->cnt;
-            pAioControl->cnt = 0;
+            /* window comparator events, without header nor filter */
+            ret = ciaaDriverAio_windowRead(pAioControl, buffer, size);
          }
          else
          {
-            /* buffer hasn't enough space */
-            ret = size;
-            pAioControl->cnt -= size;
-         }
-         for(i = 0; i < ret; i++)
-         {
-            buffer[i] = pAioControl->hwbuf[i];
-         }
-         if (pAioControl->cnt != 0)
-         {
-            /* We removed data from the buffer, it is time to reorder it */
-            for(i = 0; i < pAioControl->cnt ; i++)
+            if (pAioControl->header)
             {
-               pAioControl->hwbuf[i] = pAioControl->hwbuf[i + ret];
+               /* the samples are stored after the header */
+               pHeader = &header;
+               data = &buffer[sizeof(ciaaDriverAio_headerType)];
+               size = (size > sizeof(ciaaDriverAio_headerType)) ? (size - sizeof(ciaaDriverAio_headerType)) : 0;
+               header.frequency = SystemCoreClock;
+            }
+
+            if ((pAioControl->filter.enabled) && (pAioControl->adc_dac.adc.pair == NULL))
+            {
+               /* the header refers to the first output sample, taken after
+                * the input sample completing it */
+               first = ciaaDriverAio_filterNext(&(pAioControl->filter));
+            }
+
+            if ((pAioControl->adc_dac.adc.paired) && (pAioControl->adc_dac.adc.pair == NULL))
+            {
+               /* the samples of a pair are read through aio/in/0 */
+               ret = 0;
+            }
+            else if (pAioControl->adc_dac.adc.trigger == CIAADRVAIO_ADC_TRIGGER_TIMER)
+            {
+               ret = ciaaDriverAio_adcDmaRead(&(pAioControl->adc_dac.adc), data, size, pHeader);
+            }
+            else
+            {
+               if (pHeader != NULL)
+               {
+                  /* software started conversions are not periodic, the
+                   * stamp is the one of the sample completing the output */
+                  header.timestamp = pAioControl->hwstamp[
+                     (first < (pAioControl->cnt / sizeof(uint16_t))) ? first : 0];
+                  header.period = 0;
+                  header.sequence = pAioControl->hwseq;
+               }
+               if (size > pAioControl->cnt)
+               {
+                  /* buffer has enough space */
+                  ret = pAioControl->cnt;
+                  pAioControl->cnt = 0;
+               }
+               else
+               {
+                  /* buffer hasn't enough space */
+                  ret = size;
+                  pAioControl->cnt -= size;
+               }
+               for(i = 0; i < ret; i++)
+               {
+                  data[i] = pAioControl->hwbuf[i];
+               }
+               if (pAioControl->cnt != 0)
+               {
+                  /* We removed data from the buffer, it is time to reorder it */
+                  for(i = 0; i < pAioControl->cnt ; i++)
+                  {
+                     pAioControl->hwbuf[i] = pAioControl->hwbuf[i + ret];
+                  }
+                  for(i = 0; i < (pAioControl->cnt / sizeof(uint16_t)); i++)
+                  {
+                     pAioControl->hwstamp[i] = pAioControl->hwstamp[i + (ret / sizeof(uint16_t))];
+                  }
+                  pAioControl->hwseq += ret / sizeof(uint16_t);
+               }
+            }
+
+            if ((ret > 0) && (pAioControl->filter.enabled) &&
+                (pAioControl->adc_dac.adc.pair == NULL))
+            {
+               /* decimate in place, the samples are still in the cache */
+               ret = sizeof(int16_t) * ciaaDriverAio_filterProcess(&(pAioControl->filter),
+                     (int16_t *) data, ret / sizeof(int16_t));
+               if (pHeader != NULL)
+               {
+                  header.sequence += first;
+                  header.timestamp += (uint64_t) first * header.period;
+                  header.period *= pAioControl->filter.oversampling;
+               }
+            }
+
+            if ((ret > 0) && (pHeader != NULL))
+            {
+               header.size = ret;
+               ciaaPOSIX_memcpy(buffer, &header, sizeof(ciaaDriverAio_headerType));
+               ret += sizeof(ciaaDriverAio_headerType);
             }
          }
       }
@@ -510,11 +1593,12 @@ extern int32_t ciaaDriverAio_read(ciaaDevices_deviceType const * const device, u
 extern int32_t ciaaDriverAio_write(ciaaDevices_deviceType const * const device, uint8_t const * const buffer, uint32_t const size)
 {
    ciaaDriverAioControlType *pAioControl;
-   uint16_t *ptr;
+   ciaaDriverDacControlType *pDac;
+   DMA_TransferDescriptor_t *pLast;
    int32_t ret = -1;
-   int32_t count;
-   uint32_t dmaBuffer[AIO_FIFO_SIZE];
-   uint8_t samples;
+   uint32_t half;
+   uint32_t samples;
+   uint8_t next;
 
    if (size != 0)
    {
@@ -530,33 +1614,105 @@ extern int32_t ciaaDriverAio_write(ciaaDevices_deviceType const * const device,
       if (device == ciaaDriverAioConst.devices[2])
       {
          pAioControl = (ciaaDriverAioControlType *) device->layer;
+         pDac = &(pAioControl->adc_dac.dac);
 
-         /* pre-format the data to DACR register */
-         samples = 0;
-         count = size;
-         ptr = (uint16_t *) buffer;
-         while((count > 1) && (samples < AIO_FIFO_SIZE))
+         switch(pDac->mode)
          {
-            dmaBuffer[samples] = (uint32_t) (DAC_VALUE(*ptr) | DAC_BIAS_EN);
-            count -= 2;
-            ptr ++;
-            samples ++;
-         }
-         if (samples)
-         {
-            NVIC_DisableIRQ(pAioControl->adc_dac.dac.dma_interrupt);
-
-            /* Get the free channel for DMA transfer */
-            pAioControl->adc_dac.dac.dma_channel = Chip_GPDMA_GetFreeChannel(pAioControl->adc_dac.dac.dma_handler, GPDMA_CONN_DAC);
-
-            /* Start DMA transfer */
-            Chip_GPDMA_Transfer(pAioControl->adc_dac.dac.dma_handler, pAioControl->adc_dac.dac.dma_channel,
-                                   (uint32_t) &dmaBuffer, GPDMA_CONN_DAC,
-                                   GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, samples);
-
-            /* Bytes transfered */
-            pAioControl->cnt = size - count;
-            ret = pAioControl->cnt;
+            case CIAADRVAIO_DAC_MODE_STREAM:
+               half = pDac->length / 2;
+               ret = 0;
+               /* the dma irq moves fill on underrun */
+               NVIC_DisableIRQ(pDac->dma_interrupt);
+               if (pDac->ready[pDac->fill] == false)
+               {
+                  /* the half not being output is filled by one or more
+                   * writes, it is output once complete */
+                  ret = ciaaDriverAio_dacFormat(&(pDac->buffer[pDac->fill * half + pDac->filled]), buffer, size,
+                        half - pDac->filled);
+                  pDac->filled += ret / sizeof(uint16_t);
+                  if (pDac->filled == half)
+                  {
+                     pDac->ready[pDac->fill] = true;
+                     pDac->fill ^= 1;
+                     pDac->filled = 0;
+                  }
+
+                  if ((pDac->busy == false) && (pDac->ready[0]) && (pDac->ready[1]))
+                  {
+                     /* both halves are primed, start streaming */
+                     pDac->underruns = 0;
+                     pDac->play = 0;
+                     ciaaDriverAio_dacLink(pDac, 0, 0, pDac->length, half, true, true);
+                     ciaaDriverAio_dacStart(pDac);
+                  }
+               }
+               NVIC_EnableIRQ(pDac->dma_interrupt);
+               break;
+
+            case CIAADRVAIO_DAC_MODE_CIRCULAR:
+               ret = 0;
+               samples = size / sizeof(uint16_t);
+               if (samples > AIO_DAC_BUFFER_SIZE)
+               {
+                  samples = AIO_DAC_BUFFER_SIZE;
+               }
+               if ((pDac->swap) || (samples == 0))
+               {
+                  /* the table written before is not output yet, the swap
+                   * is confirmed */
+               }
+               else if ((pDac->busy) && ((pDac->count[pDac->table] + samples) <= AIO_DAC_BUFFER_SIZE))
+               {
+                  /* the new table is placed at the other end of the buffer
+                   * and linked after the last descriptor of the one being
+                   * output, the dma swaps them at the end of a period */
+                  next = pDac->table ^ 1;
+                  pDac->first[next] = (next == 0) ? 0 : (AIO_DAC_BUFFER_SIZE - samples);
+                  pDac->count[next] = samples;
+                  ret = ciaaDriverAio_dacFormat(&(pDac->buffer[pDac->first[next]]), buffer, size, samples);
+                  pDac->last[next] = ciaaDriverAio_dacLink(pDac, next, pDac->first[next], samples,
+                        AIO_DMA_MAX_TRANSFER, false, true);
+
+                  /* the irq of the last descriptor tells when the channel
+                   * went on with the new table */
+                  pLast = pDac->last[pDac->table];
+                  NVIC_DisableIRQ(pDac->dma_interrupt);
+                  pDac->swap = true;
+                  pLast->ctrl |= GPDMA_DMACCxControl_I;
+                  __DMB();
+                  pLast->lli = (uint32_t) &(pDac->lli[next * AIO_DAC_LLI_COUNT]);
+                  NVIC_EnableIRQ(pDac->dma_interrupt);
+               }
+               else
+               {
+                  /* nothing output yet, or both tables do not fit in the
+                   * buffer: the output is restarted with the new one */
+                  ciaaDriverAio_dacStop(pDac);
+                  pDac->first[0] = 0;
+                  pDac->count[0] = samples;
+                  ret = ciaaDriverAio_dacFormat(pDac->buffer, buffer, size, samples);
+                  if (ret > 0)
+                  {
+                     pDac->last[0] = ciaaDriverAio_dacLink(pDac, 0, 0, samples, AIO_DMA_MAX_TRANSFER, false, true);
+                     ciaaDriverAio_dacStart(pDac);
+                  }
+               }
+               break;
+
+            default:
+               ret = 0;
+               if (pDac->busy == false)
+               {
+                  ret = ciaaDriverAio_dacFormat(pDac->buffer, buffer, size, AIO_DAC_BUFFER_SIZE);
+                  if (ret > 0)
+                  {
+                     ciaaDriverAio_dacLink(pDac, 0, 0, ret / sizeof(uint16_t), AIO_DMA_MAX_TRANSFER, false, false);
+                     ciaaDriverAio_dacStart(pDac);
+                  }
+               }
+               /* Bytes transfered */
+               pAioControl->cnt = ret;
+               break;
          }
       }
    }
@@ -589,8 +1745,11 @@ ISR(ADC1_IRQHandler)
    ciaaDriverAio_adcIRQHandler(&ciaaDriverAio_in1);
 }
 
-ISR(DMA_IRQHandler)
+/** \brief called from the GPDMA interrupt, see ciaaDriverDma_Internal.h */
+extern void ciaaDriverAio_dmaIRQHandler(void)
 {
+   ciaaDriverAio_adcDmaIRQHandler(&ciaaDriverAio_in0);
+   ciaaDriverAio_adcDmaIRQHandler(&ciaaDriverAio_in1);
    ciaaDriverAio_dacIRQHandler(&ciaaDriverAio_out0);
 }
 
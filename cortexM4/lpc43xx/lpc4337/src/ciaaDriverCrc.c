@@ -0,0 +1,170 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief CRC Driver for LPC4337
+ **
+ ** Uses the CRC engine. The engine is shared, each call loads the state of
+ ** its context as seed and saves the register back, so several CRCs may be
+ ** in progress at the same time.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup CRC CRC Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverCrc.h"
+#include "ciaaPOSIX_stdbool.h"
+#include "chip.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief configuration of the engine for a CRC type
+ **
+ ** The state is the raw CRC register, the sum flags are only applied when
+ ** the CRC is finished.
+ **/
+typedef struct {
+   CRC_POLY_T poly;        /** <= polynomial of the engine */
+   uint32_t mode;          /** <= mode while bytes are added */
+   uint32_t sumMode;       /** <= additional mode to read the result */
+   uint32_t seed;          /** <= initial value of the register */
+} ciaaDriverCrc_paramType;
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief engine configuration, indexed by CIAADRVCRC_* */
+static ciaaDriverCrc_paramType const ciaaDriverCrc_param[CIAADRVCRC_TYPES] = {
+   { CRC_POLY_CRC16, CRC_MODE_WRDATA_BIT_RVS, CRC_MODE_SUM_BIT_RVS, 0x0000FFFF },   /* CIAADRVCRC_16_MODBUS */
+   { CRC_POLY_CCITT, 0, 0, 0x0000FFFF },                                             /* CIAADRVCRC_16_CCITT */
+   { CRC_POLY_CRC32, CRC_MODE_WRDATA_BIT_RVS, CRC_MODE_SUM_BIT_RVS | CRC_MODE_SUM_CMPL, 0xFFFFFFFF } /* CIAADRVCRC_32 */
+};
+
+/** \brief engine clock enabled */
+static bool ciaaDriverCrc_initialized = false;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+extern void ciaaDriverCrc_start(ciaaDriverCrc_contextType * context, uint8_t type)
+{
+   uint32_t primask;
+
+   if(ciaaDriverCrc_initialized == false)
+   {
+      primask = __get_PRIMASK();
+      __disable_irq();
+      if(ciaaDriverCrc_initialized == false)
+      {
+         Chip_CRC_Init();
+         ciaaDriverCrc_initialized = true;
+      }
+      __set_PRIMASK(primask);
+   }
+
+   context->type = type;
+   context->state = ciaaDriverCrc_param[type].seed;
+}
+
+extern void ciaaDriverCrc_update(ciaaDriverCrc_contextType * context, uint8_t const * data, uint32_t size)
+{
+   ciaaDriverCrc_paramType const * param = &ciaaDriverCrc_param[context->type];
+   uint32_t primask;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   Chip_CRC_SetPoly(param->poly, param->mode);
+   Chip_CRC_SetSeed(context->state);
+
+   for(; (size > 0) && (((uint32_t)data & 3) != 0); size--, data++)
+   {
+      Chip_CRC_Write8(*data);
+   }
+   /* a word is taken MSB first, the bit reversal is done per byte */
+   for(; size >= 4; size -= 4, data += 4)
+   {
+      Chip_CRC_Write32(__REV(*(uint32_t const *)data));
+   }
+   for(; size > 0; size--, data++)
+   {
+      Chip_CRC_Write8(*data);
+   }
+
+   context->state = Chip_CRC_Sum();
+
+   __set_PRIMASK(primask);
+}
+
+extern uint32_t ciaaDriverCrc_finish(ciaaDriverCrc_contextType const * context)
+{
+   ciaaDriverCrc_paramType const * param = &ciaaDriverCrc_param[context->type];
+   uint32_t primask;
+   uint32_t ret;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   /* the sum flags are applied when the register is read */
+   Chip_CRC_SetPoly(param->poly, param->mode | param->sumMode);
+   Chip_CRC_SetSeed(context->state);
+   ret = Chip_CRC_Sum();
+
+   __set_PRIMASK(primask);
+
+   return ret;
+}
+
+extern uint32_t ciaaDriverCrc_compute(uint8_t type, uint8_t const * data, uint32_t size)
+{
+   ciaaDriverCrc_contextType context;
+
+   ciaaDriverCrc_start(&context, type);
+   ciaaDriverCrc_update(&context, data, size);
+
+   return ciaaDriverCrc_finish(&context);
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
@@ -58,9 +58,17 @@
 /*==================[inclusions]=============================================*/
 #include "ciaaDriverDio.h"
 #include "ciaaDriverDio_Internal.h"
+#include "ciaaDriverDio_Ioctl.h"
+#include "ciaaDriverDio_Debounce.h"
+#include "ciaaDriverTime_Internal.h"
+#include "ciaaDriverDma_Internal.h"
+#include "ciaaDriverSct_Internal.h"
+#include "ciaaDriverTrace.h"
 #include "ciaaPOSIX_stdlib.h"
 #include "ciaaPOSIX_string.h"
+#include "ciaaPOSIX_stdbool.h"
 #include "chip.h"
+#include "os.h"
 
 /*==================[macros and definitions]=================================*/
 /** \brief Pointer to Devices */
@@ -69,6 +77,174 @@ typedef struct  {
    uint8_t countOfDevices;
 } ciaaDriverConstType;
 
+/** \brief count of inputs, each one uses the pin interrupt of its index */
+#define DIO_INPUTS         (8)
+
+/** \brief size of the input event queue, power of two */
+#define DIO_EVENTS         (16)
+
+/** \brief count of outputs */
+#define DIO_OUTPUTS        (8)
+
+/** \brief RIT control register bit clearing the counter on a match */
+#define DIO_RIT_CTRL_ENCLR (1 << 1)
+
+/** \brief count of GPIO ports with outputs */
+#define DIO_OUTPUT_PORTS   (3)
+
+/** \brief count of outputs with PWM, the MOSFETs */
+#define DIO_PWM_CHANNELS   (4)
+
+/** \brief marks a PWM channel without SCT output */
+#define DIO_PWM_NO_CTOUT   (0xFF)
+
+/** \brief highest PWM frequency in Hz when a channel without SCT output
+ ** is enabled, its pin is driven by the SCT interrupt twice per period.
+ ** May be overwritten from the makefile. */
+#ifndef DIO_PWM_IRQ_FREQUENCY_MAX
+#define DIO_PWM_IRQ_FREQUENCY_MAX   (2000)
+#endif
+
+/** \brief SCT match of the period of the PWM, the channels use the next
+ ** ones. The AIO driver uses the matches 0 and 1. */
+#define DIO_PWM_MATCH      (2)
+
+/** \brief SCT event of the period of the PWM, the channels use the next
+ ** ones. The AIO driver uses the events 0 to 3. */
+#define DIO_PWM_EVENT      (8)
+
+/** \brief SCT counter control register bits, H half */
+#define DIO_SCT_CTRL_HALT        (1 << 2)
+#define DIO_SCT_CTRL_CLRCTR      (1 << 3)
+#define DIO_SCT_CTRL_PRE(n)      (((n) & 0xff) << 5)
+
+/** \brief SCT event control register bits */
+#define DIO_SCT_EV_MATCHSEL(n)   ((n) & 0xf)
+#define DIO_SCT_EV_HEVENT        (1 << 4)
+#define DIO_SCT_EV_COMBMODE_MATCH (1 << 12)
+
+/** \brief GPIO pin of an output */
+typedef struct {
+   uint8_t port;                 /** <= GPIO port */
+   uint8_t pin;                  /** <= GPIO pin */
+   bool inverted;                /** <= the output is active low */
+} ciaaDriverDio_outputType;
+
+/** \brief outputs of a GPIO port
+ **
+ ** The mask register of the port only lets the output pins be written
+ ** through MPIN, so all of them change with a single write. The pins of
+ ** each nibble of the output byte are precomputed.
+ **/
+typedef struct {
+   uint8_t port;                 /** <= GPIO port */
+   uint32_t mask;                /** <= pins of the outputs */
+   uint32_t inverted;            /** <= pins of the active low outputs */
+   uint32_t pwm;                 /** <= pins driven by the PWM */
+   uint32_t pins[2][16];         /** <= pins of the low and high nibble */
+} ciaaDriverDio_outputPortType;
+
+/** \brief pin of an output with PWM
+ **
+ ** Only P1_5 of the MOSFET outputs has an SCT output, the PWM of the
+ ** others is driven from the SCT interrupt.
+ **/
+typedef struct {
+   uint8_t output;               /** <= index of the output */
+   uint8_t port;                 /** <= SCU port of the pin */
+   uint8_t pin;                  /** <= SCU pin */
+   uint8_t gpioFunc;             /** <= SCU function of the GPIO */
+   uint8_t ctout;                /** <= SCT output or DIO_PWM_NO_CTOUT */
+   uint8_t sctFunc;              /** <= SCU function of the SCT output */
+} ciaaDriverDio_pwmPinType;
+
+/** \brief PWM of the outputs
+ **
+ ** The PWM runs on the H counter of the SCT, which the AIO driver also
+ ** uses to pace the conversions of ADC1, so they can not run together:
+ ** the counter is taken through ciaaDriverSct_takeH.
+ ** Each period starts with an event at the limit which turns the outputs
+ ** on, and the match of each channel turns its output off. The interrupt
+ ** SCT_IRQHandler shall be declared in the OIL file.
+ **/
+typedef struct {
+   bool enabled;                 /** <= the H counter runs the PWM */
+   uint8_t channels;             /** <= channels enabled */
+   uint8_t irqChannels;          /** <= channels driven by the interrupt */
+   uint8_t pre;                  /** <= prescaler of the counter */
+   uint32_t ticks;               /** <= period in counter ticks */
+} ciaaDriverDio_pwmControlType;
+
+/** \brief GPIO pin of an input */
+typedef struct {
+   uint8_t port;                 /** <= GPIO port */
+   uint8_t pin;                  /** <= GPIO pin */
+} ciaaDriverDio_inputType;
+
+/** \brief input change events
+ **
+ ** When CIAADRVDIO_EVENTS_TASK and CIAADRVDIO_EVENTS_EVENT are defined in
+ ** the makefile each event is signalled to that task. The pin interrupts
+ ** GPIO0_IRQHandler to GPIO7_IRQHandler shall be declared in the OIL file,
+ ** also for the trace recorder, and RIT_IRQHandler when the inputs are
+ ** debounced. The interrupts, which may preempt each other, write head
+ ** with the irqs disabled and read is the only writer of tail, both run
+ ** free.
+ **/
+typedef struct {
+   bool enabled;                 /** <= events enabled */
+   uint8_t last;                 /** <= inputs at the last event */
+   uint32_t sequence;            /** <= count of events, lost ones included */
+   volatile uint32_t head;       /** <= next event written by the irq */
+   volatile uint32_t tail;       /** <= next event read */
+   ciaaDriverDio_eventType events[DIO_EVENTS]; /** <= queue */
+} ciaaDriverDio_eventQueueType;
+
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+#if (CIAADRVDIO_CAPTURE_SAMPLES > 4095)
+#error CIAADRVDIO_CAPTURE_SAMPLES exceeds the transfer size of a GPDMA channel
+#endif
+
+/** \brief timer pacing the capture */
+#define DIO_CAPTURE_TIMER        LPC_TIMER1
+
+/** \brief clock of the timer pacing the capture */
+#define DIO_CAPTURE_TIMER_CLK    CLK_MX_TIMER1
+
+/** \brief GPDMA requests of MR0 and MR1 of the timer, through DMAMUX
+ ** function 0. They are shared with the UART1 requests, the lines are
+ ** taken with ciaaDriverDma_takeLine while a capture runs. */
+#define DIO_CAPTURE_DMA_PORT2    (3)
+#define DIO_CAPTURE_DMA_PORT3    (4)
+
+/** \brief highest capture rate */
+#define DIO_CAPTURE_MAX_RATE     (5000000)
+
+/** \brief capture states */
+#define DIO_CAPTURE_IDLE         (0)
+#define DIO_CAPTURE_ARMED        (1)
+#define DIO_CAPTURE_RUNNING      (2)
+#define DIO_CAPTURE_DONE         (3)
+
+/** \brief capture of the inputs
+ **
+ ** The inputs are on GPIO ports 2 and 3, so each match of the timer
+ ** requests two GPDMA channels which copy the PIN register of each port
+ ** to its buffer. The samples are packed to bytes when read. Enabled when
+ ** CIAADRVDIO_CAPTURE_SAMPLES is defined in the makefile.
+ **/
+typedef struct {
+   volatile uint8_t state;       /** <= DIO_CAPTURE_IDLE to DIO_CAPTURE_DONE */
+   volatile uint8_t pending;     /** <= channels not completed yet */
+   uint8_t mask;                 /** <= inputs of the trigger */
+   uint8_t value;                /** <= value of the trigger inputs */
+   uint8_t channel[2];           /** <= GPDMA channels of port 2 and 3 */
+   uint32_t samples;             /** <= count of samples */
+   uint32_t position;            /** <= next sample read */
+   uint32_t raw[2][CIAADRVDIO_CAPTURE_SAMPLES]; /** <= PIN of port 2 and 3 */
+} ciaaDriverDio_captureControlType;
+#endif /* #ifdef CIAADRVDIO_CAPTURE_SAMPLES */
+
 /*==================[internal data declaration]==============================*/
 
 /*==================[internal functions declaration]=========================*/
@@ -112,6 +288,54 @@ static ciaaDriverConstType const ciaaDriverDioConst = {
    2
 };
 
+/** \brief pins of the inputs, indexed by bit of the input byte */
+static ciaaDriverDio_inputType const ciaaDriverDio_inputs[DIO_INPUTS] = {
+   { 2, 0 }, { 2, 1 }, { 2, 2 }, { 2, 3 },
+   { 3, 11 }, { 3, 12 }, { 3, 13 }, { 3, 14 }
+};
+
+/** \brief input change events */
+static ciaaDriverDio_eventQueueType ciaaDriverDio_inputEvents;
+
+/** \brief debounce of the inputs, sampled by the RIT */
+static ciaaDriverDio_debounceStateType ciaaDriverDio_debounce;
+
+/** \brief the pin interrupts of the inputs are enabled */
+static bool ciaaDriverDio_pinInterrupts = false;
+
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+/** \brief capture of the inputs */
+static ciaaDriverDio_captureControlType ciaaDriverDio_capture;
+#endif
+
+/** \brief pins of the outputs, indexed by bit of the output byte */
+static ciaaDriverDio_outputType const ciaaDriverDio_outputs[DIO_OUTPUTS] = {
+   { 2, 4, false },              /* GPIO2[4]: relay */
+   { 2, 5, false },              /* GPIO2[5]: relay */
+   { 2, 6, false },              /* GPIO2[6]: relay */
+   { 5, 1, false },              /* GPIO5[1]: relay */
+   { 5, 12, true },              /* GPIO5[12]: MOSFET */
+   { 5, 13, true },              /* GPIO5[13]: MOSFET */
+   { 5, 14, true },              /* GPIO5[14]: MOSFET */
+   { 1, 8, true }                /* GPIO1[8]: MOSFET */
+};
+
+/** \brief pins of the outputs with PWM, indexed by channel */
+static ciaaDriverDio_pwmPinType const ciaaDriverDio_pwmPins[DIO_PWM_CHANNELS] = {
+   { 4, 4, 8, FUNC4, DIO_PWM_NO_CTOUT, 0 },     /* P4_8: CTIN_5 only */
+   { 5, 4, 9, FUNC4, DIO_PWM_NO_CTOUT, 0 },     /* P4_9: CTIN_6 only */
+   { 6, 4, 10, FUNC4, DIO_PWM_NO_CTOUT, 0 },    /* P4_10: CTIN_2 only */
+   { 7, 1, 5, FUNC0, 10, FUNC1 }                /* P1_5: CTOUT_10 */
+};
+
+/** \brief PWM of the outputs */
+static ciaaDriverDio_pwmControlType ciaaDriverDio_pwm;
+
+/** \brief ports of the outputs, completed by ciaa_lpc4337_gpio_init */
+static ciaaDriverDio_outputPortType ciaaDriverDio_outputPorts[DIO_OUTPUT_PORTS] = {
+   { 2 }, { 5 }, { 1 }
+};
+
 /*==================[external data definition]===============================*/
 /** \brief Dio 0 */
 ciaaDriverDio_dioType ciaaDriverDio_dio0;
@@ -120,11 +344,584 @@ ciaaDriverDio_dioType ciaaDriverDio_dio0;
 ciaaDriverDio_dioType ciaaDriverDio_dio1;
 
 /*==================[internal functions definition]==========================*/
+/** \brief precomputes the masks and values of the output ports */
+static void ciaaDriverDio_initOutputPorts(void)
+{
+   ciaaDriverDio_outputPortType * outputPort;
+   ciaaDriverDio_outputType const * output;
+   uint32_t half;
+   uint32_t nibble;
+   uint32_t bit;
+   uint8_t loopi;
+
+   for(loopi = 0; loopi < DIO_OUTPUT_PORTS; loopi++)
+   {
+      outputPort = &ciaaDriverDio_outputPorts[loopi];
+      outputPort->mask = 0;
+      outputPort->inverted = 0;
+      outputPort->pwm = 0;
+
+      for(half = 0; half < 2; half++)
+      {
+         for(nibble = 0; nibble < 16; nibble++)
+         {
+            outputPort->pins[half][nibble] = 0;
+            for(bit = 0; bit < 4; bit++)
+            {
+               output = &ciaaDriverDio_outputs[half * 4 + bit];
+               if(output->port == outputPort->port)
+               {
+                  outputPort->mask |= 1 << output->pin;
+                  if(output->inverted)
+                  {
+                     outputPort->inverted |= 1 << output->pin;
+                  }
+                  if((nibble >> bit) & 1)
+                  {
+                     outputPort->pins[half][nibble] |= 1 << output->pin;
+                  }
+               }
+            }
+         }
+      }
+
+      Chip_GPIO_SetPortMask(LPC_GPIO_PORT, outputPort->port, ~outputPort->mask);
+   }
+}
+
+/** \brief packs the inputs from the PIN registers of GPIO 2 and 3, they
+ ** are active low */
+static uint8_t ciaaDriverDio_packInputs(uint32_t port2, uint32_t port3)
+{
+   return ~((uint8_t) ((port3 & (0x0F<<11))>>7) | (port2 & 0x0F));
+}
+
+/** \brief reads the inputs */
+static uint8_t ciaaDriverDio_readInputs(void)
+{
+   return ciaaDriverDio_packInputs(Chip_GPIO_ReadValue(LPC_GPIO_PORT,2),
+         Chip_GPIO_ReadValue(LPC_GPIO_PORT,3));
+}
+
+/** \brief reads the inputs through the debounce
+ **
+ ** \param[in] now       current time
+ ** \param[in] periodic  the call is the periodic sample of the RIT
+ ** \return the debounced inputs
+ **/
+static uint8_t ciaaDriverDio_sampleInputs(uint64_t now, bool periodic)
+{
+   uint32_t primask;
+   uint8_t value;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   value = ciaaDriverDio_debounceSample(&ciaaDriverDio_debounce, ciaaDriverDio_readInputs(), now, periodic);
+
+   __set_PRIMASK(primask);
+
+   return value;
+}
+
+/** \brief sets the debounce of some inputs
+ **
+ ** The RIT samples the inputs while any of them is filtered.
+ **
+ ** \param[in] param     filter of the inputs
+ ** \return 0 if the filter was set, -1 if it is not valid
+ **/
+static int32_t ciaaDriverDio_setDebounce(ciaaDriverDio_debounceType const * param)
+{
+   ciaaDriverDio_debounceStateType * debounce = &ciaaDriverDio_debounce;
+   uint32_t ticksPerUs = SystemCoreClock / 1000000;
+   uint32_t primask;
+   int32_t ret = -1;
+
+   if((param != NULL) && (param->mode <= CIAADRVDIO_DEBOUNCE_WINDOW) &&
+      ((param->mode == CIAADRVDIO_DEBOUNCE_NONE) || (param->period != 0)))
+   {
+      primask = __get_PRIMASK();
+      __disable_irq();
+
+      ciaaDriverDio_debounceConfig(debounce, param->inputs, param->mode, param->count,
+            (uint64_t) param->window * ticksPerUs, ciaaDriverTime_get());
+
+      if(param->mode != CIAADRVDIO_DEBOUNCE_NONE)
+      {
+         Chip_RIT_Disable(LPC_RITIMER);
+         LPC_RITIMER->COMPVAL = param->period * ticksPerUs;
+         LPC_RITIMER->COUNTER = 0;
+         LPC_RITIMER->CTRL |= DIO_RIT_CTRL_ENCLR;
+         Chip_RIT_ClearInt(LPC_RITIMER);
+         Chip_RIT_Enable(LPC_RITIMER);
+         NVIC_EnableIRQ(RITIMER_IRQn);
+      }
+      else if((debounce->integrator | debounce->window) == 0)
+      {
+         Chip_RIT_Disable(LPC_RITIMER);
+         NVIC_DisableIRQ(RITIMER_IRQn);
+      }
+
+      __set_PRIMASK(primask);
+
+      ret = 0;
+   }
+
+   return ret;
+}
+
+/** \brief enables the pin interrupts while the events or an armed capture
+ ** need them, disables them otherwise. With the trace recorder they stay
+ ** enabled to record every change of the inputs. */
+static void ciaaDriverDio_setPinInterrupts(void)
+{
+   bool enable = ciaaDriverDio_inputEvents.enabled;
+   uint32_t primask;
+   uint8_t loopi;
+
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+   enable = enable || (ciaaDriverDio_capture.state == DIO_CAPTURE_ARMED);
+#endif
+#ifdef CIAADRVTRACE_SIZE
+   enable = true;
+#endif
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   if(enable != ciaaDriverDio_pinInterrupts)
+   {
+      ciaaDriverDio_pinInterrupts = enable;
+      if(enable)
+      {
+         /* both edges of every input */
+         Chip_PININT_ClearIntStatus(LPC_GPIO_PIN_INT, PININTCH(DIO_INPUTS) - 1);
+         Chip_PININT_EnableIntHigh(LPC_GPIO_PIN_INT, PININTCH(DIO_INPUTS) - 1);
+         Chip_PININT_EnableIntLow(LPC_GPIO_PIN_INT, PININTCH(DIO_INPUTS) - 1);
+         for(loopi = 0; loopi < DIO_INPUTS; loopi++)
+         {
+            NVIC_ClearPendingIRQ(PIN_INT0_IRQn + loopi);
+            NVIC_EnableIRQ(PIN_INT0_IRQn + loopi);
+         }
+      }
+      else
+      {
+         for(loopi = 0; loopi < DIO_INPUTS; loopi++)
+         {
+            NVIC_DisableIRQ(PIN_INT0_IRQn + loopi);
+         }
+         Chip_PININT_DisableIntHigh(LPC_GPIO_PIN_INT, PININTCH(DIO_INPUTS) - 1);
+         Chip_PININT_DisableIntLow(LPC_GPIO_PIN_INT, PININTCH(DIO_INPUTS) - 1);
+         Chip_PININT_ClearIntStatus(LPC_GPIO_PIN_INT, PININTCH(DIO_INPUTS) - 1);
+      }
+   }
+
+   __set_PRIMASK(primask);
+}
+
+/** \brief enables or disables the input change events
+ **
+ ** The pin interrupts skip the queue while it is reset, they may stay
+ ** enabled for an armed capture.
+ **/
+static void ciaaDriverDio_setEvents(bool enable)
+{
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+
+   queue->enabled = false;
+   __DMB();
+   if(enable)
+   {
+      queue->head = 0;
+      queue->tail = 0;
+      queue->sequence = 0;
+      queue->last = ciaaDriverDio_sampleInputs(ciaaDriverTime_get(), false);
+      __DMB();
+      queue->enabled = true;
+   }
+   ciaaDriverDio_setPinInterrupts();
+}
+
+/** \brief copies the queued events to the buffer of read */
+static int32_t ciaaDriverDio_readEvents(uint8_t * buffer, uint32_t size)
+{
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+   int32_t ret = 0;
+
+   while(((ret + sizeof(ciaaDriverDio_eventType)) <= size) && (queue->tail != queue->head))
+   {
+      ciaaPOSIX_memcpy(&buffer[ret], &(queue->events[queue->tail & (DIO_EVENTS - 1)]),
+            sizeof(ciaaDriverDio_eventType));
+      queue->tail++;
+      ret += sizeof(ciaaDriverDio_eventType);
+   }
+
+   return ret;
+}
+
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+/** \brief sets up a GPDMA channel copying a PIN register on each request
+ **
+ ** The transfer is paced by the timer, so the channel is the flow
+ ** controller of a peripheral to memory transfer from the GPIO register.
+ ** LPCOpen only knows the addresses of the peripherals, the channel is
+ ** programmed directly.
+ **/
+static void ciaaDriverDio_setupCaptureChannel(uint8_t channel, uint8_t peripheral,
+      uint32_t source, uint32_t * destination, uint32_t samples)
+{
+   LPC_GPDMA->INTTCCLEAR = 1 << channel;
+   LPC_GPDMA->INTERRCLR = 1 << channel;
+
+   LPC_GPDMA->CH[channel].SRCADDR = source;
+   LPC_GPDMA->CH[channel].DESTADDR = (uint32_t) destination;
+   LPC_GPDMA->CH[channel].LLI = 0;
+   LPC_GPDMA->CH[channel].CONTROL = GPDMA_DMACCxControl_TransferSize(samples)
+         | GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_1)
+         | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_1)
+         | GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD)
+         | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD)
+         | GPDMA_DMACCxControl_DI
+         | GPDMA_DMACCxControl_I;
+
+   /* function 0 of the request is the timer match */
+   LPC_CREG->DMAMUX &= ~(0x03 << (2 * peripheral));
+
+   LPC_GPDMA->CH[channel].CONFIG = GPDMA_DMACCxConfig_E
+         | GPDMA_DMACCxConfig_SrcPeripheral(peripheral)
+         | GPDMA_DMACCxConfig_TransferType(GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA)
+         | GPDMA_DMACCxConfig_IE
+         | GPDMA_DMACCxConfig_ITC;
+}
+
+/** \brief stops the capture and discards its samples */
+static void ciaaDriverDio_stopCapture(void)
+{
+   ciaaDriverDio_captureControlType * capture = &ciaaDriverDio_capture;
+   uint32_t primask;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   if(capture->state != DIO_CAPTURE_IDLE)
+   {
+      Chip_TIMER_Disable(DIO_CAPTURE_TIMER);
+      if(capture->pending & 0x01)
+      {
+         Chip_GPDMA_Stop(LPC_GPDMA, capture->channel[0]);
+      }
+      if(capture->pending & 0x02)
+      {
+         Chip_GPDMA_Stop(LPC_GPDMA, capture->channel[1]);
+      }
+      capture->pending = 0;
+      capture->state = DIO_CAPTURE_IDLE;
+   }
+   ciaaDriverDma_giveLine(DIO_CAPTURE_DMA_PORT2, CIAADRVDMA_OWNER_DIO);
+   ciaaDriverDma_giveLine(DIO_CAPTURE_DMA_PORT3, CIAADRVDMA_OWNER_DIO);
+
+   __set_PRIMASK(primask);
+
+   ciaaDriverDio_setPinInterrupts();
+}
+
+/** \brief starts an armed capture when the trigger is met
+ **
+ ** Called by the pin interrupts, the first sample is taken one period
+ ** after the change of the inputs.
+ **
+ ** \param[in] value     inputs after the change
+ **/
+static void ciaaDriverDio_triggerCapture(uint8_t value)
+{
+   ciaaDriverDio_captureControlType * capture = &ciaaDriverDio_capture;
+   uint32_t primask;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   if((capture->state == DIO_CAPTURE_ARMED) && ((value & capture->mask) == capture->value))
+   {
+      Chip_TIMER_Enable(DIO_CAPTURE_TIMER);
+      capture->state = DIO_CAPTURE_RUNNING;
+   }
+
+   __set_PRIMASK(primask);
+
+   if(capture->state == DIO_CAPTURE_RUNNING)
+   {
+      ciaaDriverDio_setPinInterrupts();
+   }
+}
+
+/** \brief sets up a capture of the inputs
+ **
+ ** \param[inout] param capture, the rate is updated to the rate achieved
+ ** \return 0 if the capture was set up, -1 if it is not valid or the
+ **         UART1 dma uses the request lines
+ **/
+static int32_t ciaaDriverDio_startCapture(ciaaDriverDio_captureType * param)
+{
+   ciaaDriverDio_captureControlType * capture = &ciaaDriverDio_capture;
+   uint32_t clock;
+   uint32_t ticks;
+   int32_t ret = -1;
+
+   ciaaDriverDio_stopCapture();
+
+   if((param != NULL) && (param->rate != 0) && (param->rate <= DIO_CAPTURE_MAX_RATE) &&
+      (param->samples != 0) && (param->samples <= CIAADRVDIO_CAPTURE_SAMPLES) &&
+      (ciaaDriverDma_takeLine(DIO_CAPTURE_DMA_PORT2, CIAADRVDMA_OWNER_DIO)) &&
+      (ciaaDriverDma_takeLine(DIO_CAPTURE_DMA_PORT3, CIAADRVDMA_OWNER_DIO)))
+   {
+      Chip_TIMER_Init(DIO_CAPTURE_TIMER);
+      clock = Chip_Clock_GetRate(DIO_CAPTURE_TIMER_CLK);
+      ticks = (clock + (param->rate / 2)) / param->rate;
+      param->rate = clock / ticks;
+
+      /* MR0 and MR1 match together, the counter is reset by MR0 */
+      Chip_TIMER_Disable(DIO_CAPTURE_TIMER);
+      Chip_TIMER_Reset(DIO_CAPTURE_TIMER);
+      Chip_TIMER_PrescaleSet(DIO_CAPTURE_TIMER, 0);
+      Chip_TIMER_SetMatch(DIO_CAPTURE_TIMER, 0, ticks - 1);
+      Chip_TIMER_SetMatch(DIO_CAPTURE_TIMER, 1, ticks - 1);
+      Chip_TIMER_ResetOnMatchEnable(DIO_CAPTURE_TIMER, 0);
+
+      /* a request may be asserted before the first match */
+      Chip_TIMER_ClearMatch(DIO_CAPTURE_TIMER, 0);
+      Chip_TIMER_ClearMatch(DIO_CAPTURE_TIMER, 1);
+
+      capture->samples = param->samples;
+      capture->position = 0;
+      capture->mask = param->mask;
+      capture->value = param->value & param->mask;
+      capture->channel[0] = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, 0);
+      capture->channel[1] = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, 0);
+      capture->pending = 0x03;
+      ciaaDriverDio_setupCaptureChannel(capture->channel[0], DIO_CAPTURE_DMA_PORT2,
+            (uint32_t) &(LPC_GPIO_PORT->PIN[2]), capture->raw[0], capture->samples);
+      ciaaDriverDio_setupCaptureChannel(capture->channel[1], DIO_CAPTURE_DMA_PORT3,
+            (uint32_t) &(LPC_GPIO_PORT->PIN[3]), capture->raw[1], capture->samples);
+
+      if(capture->mask == 0)
+      {
+         capture->state = DIO_CAPTURE_RUNNING;
+         Chip_TIMER_Enable(DIO_CAPTURE_TIMER);
+      }
+      else
+      {
+         capture->state = DIO_CAPTURE_ARMED;
+         ciaaDriverDio_setPinInterrupts();
+
+         /* the trigger may already be met */
+         ciaaDriverDio_triggerCapture(ciaaDriverDio_readInputs());
+      }
+
+      ret = 0;
+   }
+   else
+   {
+      /* one of the lines may have been taken */
+      ciaaDriverDma_giveLine(DIO_CAPTURE_DMA_PORT2, CIAADRVDMA_OWNER_DIO);
+      ciaaDriverDma_giveLine(DIO_CAPTURE_DMA_PORT3, CIAADRVDMA_OWNER_DIO);
+   }
+
+   return ret;
+}
+
+/** \brief copies the captured samples to the buffer of read */
+static int32_t ciaaDriverDio_readCapture(uint8_t * buffer, uint32_t size)
+{
+   ciaaDriverDio_captureControlType * capture = &ciaaDriverDio_capture;
+   int32_t ret = 0;
+
+   if(capture->state == DIO_CAPTURE_DONE)
+   {
+      while((ret < size) && (capture->position < capture->samples))
+      {
+         buffer[ret] = ciaaDriverDio_packInputs(capture->raw[0][capture->position],
+               capture->raw[1][capture->position]);
+         capture->position++;
+         ret++;
+      }
+   }
+
+   return ret;
+}
+#endif /* #ifdef CIAADRVDIO_CAPTURE_SAMPLES */
+
+/** \brief queues an input change event
+ **
+ ** Called by the interrupts. The inputs changed are the ones differing
+ ** from the last event plus the forced ones, nothing is queued if there
+ ** are none. The event is lost when the queue is full, its sequence
+ ** number is skipped anyway.
+ **
+ ** \param[in] value     inputs after the change
+ ** \param[in] forced    inputs flagged as changed anyway
+ ** \param[in] timestamp time of the change
+ **/
+static void ciaaDriverDio_queueEvent(uint8_t value, uint8_t forced, uint64_t timestamp)
+{
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+   ciaaDriverDio_eventType * event;
+   uint32_t primask;
+   uint8_t changed = 0;
+
+   /* the interrupts of the pins and the RIT may preempt each other */
+   primask = __get_PRIMASK();
+   __disable_irq();
+   if(queue->enabled)
+   {
+      changed = (value ^ queue->last) | forced;
+   }
+   if(changed != 0)
+   {
+      if((queue->head - queue->tail) < DIO_EVENTS)
+      {
+         event = &(queue->events[queue->head & (DIO_EVENTS - 1)]);
+         event->timestamp = timestamp;
+         event->sequence = queue->sequence;
+         event->value = value;
+         event->changed = changed;
+
+         /* the event shall be stored before it is published */
+         __DMB();
+         queue->head++;
+      }
+      queue->sequence++;
+      queue->last = value;
+   }
+   __set_PRIMASK(primask);
+
+#ifdef CIAADRVDIO_EVENTS_TASK
+   if(changed != 0)
+   {
+      SetEvent(CIAADRVDIO_EVENTS_TASK, CIAADRVDIO_EVENTS_EVENT);
+   }
+#endif
+}
+
+/** \brief handles the pin interrupt of an input
+ **
+ ** An input without filter is always flagged as changed: if its value is
+ ** the same as before it went through a pulse shorter than the interrupt
+ ** latency. The changes of a filtered input only reach the debounce, the
+ ** event is queued once its value is steady.
+ **
+ ** \param[in] input     index of the input and of its pin interrupt
+ **/
+static void ciaaDriverDio_pinIRQHandler(uint8_t input)
+{
+   ciaaDriverDio_debounceStateType * debounce = &ciaaDriverDio_debounce;
+   uint64_t timestamp = ciaaDriverTime_get();
+   uint8_t value;
+
+   Chip_PININT_ClearIntStatus(LPC_GPIO_PIN_INT, PININTCH(input));
+
+   ciaaDriverTrace_record(CIAADRVTRACE_DIO_IN, ciaaDriverDio_readInputs(), timestamp);
+
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+   ciaaDriverDio_triggerCapture(ciaaDriverDio_readInputs());
+#endif
+
+   value = ciaaDriverDio_sampleInputs(timestamp, false);
+   ciaaDriverDio_queueEvent(value, (1 << input) & ~(debounce->integrator | debounce->window), timestamp);
+}
+
+/** \brief samples the debounced inputs, called by the RIT */
+static void ciaaDriverDio_debounceIRQHandler(void)
+{
+   uint64_t timestamp = ciaaDriverTime_get();
+   uint8_t value;
+
+   Chip_RIT_ClearInt(LPC_RITIMER);
+
+   value = ciaaDriverDio_sampleInputs(timestamp, true);
+   ciaaDriverDio_queueEvent(value, 0, timestamp);
+}
+
+/** \brief writes all the outputs, one register write per GPIO port
+ **
+ ** The mask register of each port also keeps out the pins driven by the
+ ** PWM. The output byte is saved with the irqs disabled, see
+ ** ciaaDriverDio_modifyOutputs.
+ **/
+static void ciaaDriverDio_writeOutputs(uint8_t value)
+{
+   ciaaDriverDio_outputPortType const * outputPort;
+   uint32_t primask;
+   uint8_t loopi;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   for(loopi = 0; loopi < DIO_OUTPUT_PORTS; loopi++)
+   {
+      outputPort = &ciaaDriverDio_outputPorts[loopi];
+      Chip_GPIO_SetMaskedPortValue(LPC_GPIO_PORT, outputPort->port,
+            (outputPort->pins[0][value & 0x0F] | outputPort->pins[1][value >> 4]) ^ outputPort->inverted);
+   }
+
+   /* save actual output state */
+   ciaaDriverDio_dio1 = value;
+   ciaaDriverTrace_record(CIAADRVTRACE_DIO_OUT, value, ciaaDriverTime_get());
+
+   __set_PRIMASK(primask);
+}
+
+/** \brief sets, clears and toggles outputs
+ **
+ ** Each GPIO port gets at most a SET, a CLR and a NOT write, the pins of
+ ** the active low outputs are swapped between SET and CLR and the pins
+ ** driven by the PWM are left out. The saved
+ ** output byte is updated with the irqs disabled, so tasks changing
+ ** different outputs do not overwrite each other.
+ **
+ ** \param[in] set       outputs to set
+ ** \param[in] clear     outputs to clear
+ ** \param[in] toggle    outputs to toggle
+ **/
+static void ciaaDriverDio_modifyOutputs(uint8_t set, uint8_t clear, uint8_t toggle)
+{
+   ciaaDriverDio_outputPortType const * outputPort;
+   uint32_t setPins;
+   uint32_t clearPins;
+   uint32_t primask;
+   uint8_t loopi;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   for(loopi = 0; loopi < DIO_OUTPUT_PORTS; loopi++)
+   {
+      outputPort = &ciaaDriverDio_outputPorts[loopi];
+      setPins = (outputPort->pins[0][set & 0x0F] | outputPort->pins[1][set >> 4]) & ~outputPort->pwm;
+      clearPins = (outputPort->pins[0][clear & 0x0F] | outputPort->pins[1][clear >> 4]) & ~outputPort->pwm;
+
+      LPC_GPIO_PORT->SET[outputPort->port] = (setPins & ~outputPort->inverted) | (clearPins & outputPort->inverted);
+      LPC_GPIO_PORT->CLR[outputPort->port] = (clearPins & ~outputPort->inverted) | (setPins & outputPort->inverted);
+      if(toggle != 0)
+      {
+         LPC_GPIO_PORT->NOT[outputPort->port] = (outputPort->pins[0][toggle & 0x0F] | outputPort->pins[1][toggle >> 4]) & ~outputPort->pwm;
+      }
+   }
+
+   ciaaDriverDio_dio1 = ((ciaaDriverDio_dio1 | set) & ~clear) ^ toggle;
+   ciaaDriverTrace_record(CIAADRVTRACE_DIO_OUT, ciaaDriverDio_dio1, ciaaDriverTime_get());
+
+   __set_PRIMASK(primask);
+}
 
 void ciaa_lpc4337_gpio_init(void)
 {
+   uint8_t loopi;
+
    Chip_GPIO_Init(LPC_GPIO_PORT);
 
+   ciaaDriverDio_initOutputPorts();
+
    /* Inputs */
    Chip_SCU_PinMux(4,0,MD_PUP|MD_EZI|MD_ZI,FUNC0);	/* GPIO2[0]  */
    Chip_SCU_PinMux(4,1,MD_PUP|MD_EZI|MD_ZI,FUNC0);	/* GPIO2[1]  */
@@ -138,6 +935,29 @@ void ciaa_lpc4337_gpio_init(void)
    Chip_GPIO_SetDir(LPC_GPIO_PORT, 2,0xF, 0);
    Chip_GPIO_SetDir(LPC_GPIO_PORT, 3, 0xF<<11, 0);
 
+   /* pin interrupt of each input, edge sensitive, enabled with the events */
+   for(loopi = 0; loopi < DIO_INPUTS; loopi++)
+   {
+      Chip_SCU_GPIOIntPinSel(loopi, ciaaDriverDio_inputs[loopi].port, ciaaDriverDio_inputs[loopi].pin);
+   }
+   Chip_PININT_SetPinModeEdge(LPC_GPIO_PIN_INT, PININTCH(DIO_INPUTS) - 1);
+   ciaaDriverTime_init();
+   ciaaDriverTrace_init(SystemCoreClock);
+
+   /* no input is filtered until the debounce is set */
+   ciaaDriverDio_debounceInit(&ciaaDriverDio_debounce, ciaaDriverDio_readInputs());
+   Chip_RIT_Init(LPC_RITIMER);
+
+#ifdef CIAADRVTRACE_SIZE
+   /* the trace records the inputs from now on, the events are queued
+    * once enabled */
+   ciaaDriverDio_setPinInterrupts();
+#endif
+
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+   ciaaDriverDma_init();
+#endif
+
    /* MOSFETs */
    Chip_SCU_PinMux(4,8,MD_PUP,FUNC4);  /* GPIO5[12] */
    Chip_SCU_PinMux(4,9,MD_PUP,FUNC4);  /* GPIO5[13] */
@@ -166,90 +986,298 @@ void ciaa_lpc4337_gpio_init(void)
 
 void ciaa_lpc4337_writeOutput(uint32_t outputNumber, uint32_t value)
 {
-   switch(outputNumber)
+   ciaaDriverDio_outputType const * output;
+
+   if(outputNumber < DIO_OUTPUTS)
    {
-      case 0:
-         if(value)
-         {
-            Chip_GPIO_SetValue(LPC_GPIO_PORT, 2, 1<<4);
-         }
-         else
-         {
-            Chip_GPIO_ClearValue(LPC_GPIO_PORT, 2, 1<<4);
-         }
-         break;
-      case 1:
-         if(value)
-         {
-            Chip_GPIO_SetValue(LPC_GPIO_PORT, 2, 1<<5);
-         }
-         else
-         {
-            Chip_GPIO_ClearValue(LPC_GPIO_PORT, 2, 1<<5);
-         }
-         break;
-      case 2:
-         if(value)
-         {
-            Chip_GPIO_SetValue(LPC_GPIO_PORT, 2, 1<<6);
-         }
-         else
-         {
-            Chip_GPIO_ClearValue(LPC_GPIO_PORT, 2, 1<<6);
-         }
-         break;
-      case 3:
-         if(value)
-         {
-            Chip_GPIO_SetValue(LPC_GPIO_PORT, 5, 1<<1);
-         }
-         else
-         {
-            Chip_GPIO_ClearValue(LPC_GPIO_PORT, 5, 1<<1);
-         }
-         break;
-      case 4:
-         if(value)
-         {
-            Chip_GPIO_ClearValue(LPC_GPIO_PORT, 5, 1<<12);
-         }
-         else
-         {
-            Chip_GPIO_SetValue(LPC_GPIO_PORT, 5, 1<<12);
-         }
-         break;
-      case 5:
-         if(value)
+      output = &ciaaDriverDio_outputs[outputNumber];
+      if((value != 0) != output->inverted)
+      {
+         Chip_GPIO_SetValue(LPC_GPIO_PORT, output->port, 1 << output->pin);
+      }
+      else
+      {
+         Chip_GPIO_ClearValue(LPC_GPIO_PORT, output->port, 1 << output->pin);
+      }
+   }
+}
+
+/** \brief hands the pins of the enabled PWM channels over to the PWM and
+ ** the others back to the GPIO writes */
+static void ciaaDriverDio_setPwmPins(void)
+{
+   ciaaDriverDio_outputPortType * outputPort;
+   ciaaDriverDio_outputType const * output;
+   uint32_t primask;
+   uint8_t loopi;
+   uint8_t loopj;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   for(loopi = 0; loopi < DIO_OUTPUT_PORTS; loopi++)
+   {
+      outputPort = &ciaaDriverDio_outputPorts[loopi];
+      outputPort->pwm = 0;
+      for(loopj = 0; loopj < DIO_PWM_CHANNELS; loopj++)
+      {
+         output = &ciaaDriverDio_outputs[ciaaDriverDio_pwmPins[loopj].output];
+         if((ciaaDriverDio_pwm.channels & (1 << loopj)) && (output->port == outputPort->port))
          {
-            Chip_GPIO_ClearValue(LPC_GPIO_PORT, 5, 1<<13);
+            outputPort->pwm |= 1 << output->pin;
          }
-         else
+      }
+      Chip_GPIO_SetPortMask(LPC_GPIO_PORT, outputPort->port, ~(outputPort->mask & ~outputPort->pwm));
+   }
+
+   __set_PRIMASK(primask);
+}
+
+/** \brief sets up or disables the PWM of a channel
+ **
+ ** A duty cycle of 0 or of the whole period needs no edge, the output is
+ ** kept off or on by the event at the limit alone, or written once when
+ ** the channel has no SCT output.
+ **
+ ** \param[in] channel   PWM channel
+ ** \param[in] enable    true to drive the output with the PWM
+ ** \param[in] duty      duty cycle up to CIAADRVDIO_PWM_DUTY_MAX
+ **/
+static void ciaaDriverDio_setPwmChannel(uint8_t channel, bool enable, uint16_t duty)
+{
+   ciaaDriverDio_pwmControlType * pwm = &ciaaDriverDio_pwm;
+   ciaaDriverDio_pwmPinType const * pwmPin = &ciaaDriverDio_pwmPins[channel];
+   ciaaDriverDio_outputType const * output = &ciaaDriverDio_outputs[pwmPin->output];
+   uint32_t dutyTicks = (pwm->ticks * duty) / CIAADRVDIO_PWM_DUTY_MAX;
+   uint32_t onEvents = 0;
+   uint32_t offEvents = 0;
+   uint8_t event = DIO_PWM_EVENT + 1 + channel;
+   uint8_t match = DIO_PWM_MATCH + 1 + channel;
+   uint32_t primask;
+
+   if(enable)
+   {
+      if(dutyTicks == 0)
+      {
+         offEvents = 1 << DIO_PWM_EVENT;
+      }
+      else if(dutyTicks >= pwm->ticks)
+      {
+         onEvents = 1 << DIO_PWM_EVENT;
+      }
+      else
+      {
+         onEvents = 1 << DIO_PWM_EVENT;
+         offEvents = 1 << event;
+      }
+
+      /* the match is reloaded at the limit, so the period is not cut */
+      LPC_SCT->MATCHREL[match].H = dutyTicks;
+      LPC_SCT->EVENT[event].STATE = 1;
+      LPC_SCT->EVENT[event].CTRL = DIO_SCT_EV_MATCHSEL(match) | DIO_SCT_EV_HEVENT | DIO_SCT_EV_COMBMODE_MATCH;
+   }
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+
+   if(pwmPin->ctout != DIO_PWM_NO_CTOUT)
+   {
+      if(output->inverted)
+      {
+         LPC_SCT->OUT[pwmPin->ctout].SET = offEvents;
+         LPC_SCT->OUT[pwmPin->ctout].CLR = onEvents;
+      }
+      else
+      {
+         LPC_SCT->OUT[pwmPin->ctout].SET = onEvents;
+         LPC_SCT->OUT[pwmPin->ctout].CLR = offEvents;
+      }
+      Chip_SCU_PinMux(pwmPin->port, pwmPin->pin, MD_PUP, enable ? pwmPin->sctFunc : pwmPin->gpioFunc);
+   }
+   else if((onEvents != 0) && (offEvents != 0))
+   {
+      pwm->irqChannels |= 1 << channel;
+      LPC_SCT->EVEN |= 1 << event;
+   }
+   else
+   {
+      pwm->irqChannels &= ~(1 << channel);
+      LPC_SCT->EVEN &= ~(1 << event);
+      if(enable)
+      {
+         ciaa_lpc4337_writeOutput(pwmPin->output, onEvents != 0);
+      }
+   }
+
+   if(enable)
+   {
+      pwm->channels |= 1 << channel;
+   }
+   else if(pwm->channels & (1 << channel))
+   {
+      /* back to the value last written */
+      pwm->channels &= ~(1 << channel);
+      ciaa_lpc4337_writeOutput(pwmPin->output, (ciaaDriverDio_dio1 >> pwmPin->output) & 1);
+   }
+
+   if(pwm->irqChannels != 0)
+   {
+      LPC_SCT->EVEN |= 1 << DIO_PWM_EVENT;
+   }
+   else
+   {
+      LPC_SCT->EVEN &= ~(1 << DIO_PWM_EVENT);
+   }
+
+   __set_PRIMASK(primask);
+}
+
+/** \brief stops the PWM of all the outputs */
+static void ciaaDriverDio_stopPwm(void)
+{
+   ciaaDriverDio_pwmControlType * pwm = &ciaaDriverDio_pwm;
+   uint8_t loopi;
+
+   if(pwm->enabled)
+   {
+      for(loopi = 0; loopi < DIO_PWM_CHANNELS; loopi++)
+      {
+         ciaaDriverDio_setPwmChannel(loopi, false, 0);
+      }
+      ciaaDriverDio_setPwmPins();
+
+      LPC_SCT->CTRL_H |= DIO_SCT_CTRL_HALT;
+      NVIC_DisableIRQ(SCT_IRQn);
+      pwm->enabled = false;
+      ciaaDriverSct_giveH(CIAADRVSCT_OWNER_DIO);
+   }
+}
+
+/** \brief sets up the PWM of the outputs
+ **
+ ** The counter is only restarted when the period changes, otherwise the
+ ** new duty cycles take effect at the next period.
+ **
+ ** \param[inout] param PWM, the frequency is updated to the one achieved
+ ** \return 0 if the PWM was set up, -1 if it is not valid, faster than
+ **         DIO_PWM_IRQ_FREQUENCY_MAX with an output without SCT output,
+ **         or the H counter of the SCT is in use by the AIO driver
+ **/
+static int32_t ciaaDriverDio_setPwm(ciaaDriverDio_pwmType * param)
+{
+   ciaaDriverDio_pwmControlType * pwm = &ciaaDriverDio_pwm;
+   uint32_t clock = Chip_Clock_GetRate(CLK_MX_SCT);
+   uint32_t ticks;
+   uint32_t pre;
+   uint32_t frequencyMax = clock / CIAADRVDIO_PWM_DUTY_MAX;
+   uint8_t valid = 0;
+   uint8_t loopi;
+   bool restart;
+   int32_t ret = -1;
+
+   for(loopi = 0; loopi < DIO_PWM_CHANNELS; loopi++)
+   {
+      valid |= 1 << ciaaDriverDio_pwmPins[loopi].output;
+      if((param != NULL) && (ciaaDriverDio_pwmPins[loopi].ctout == DIO_PWM_NO_CTOUT) &&
+         ((param->outputs >> ciaaDriverDio_pwmPins[loopi].output) & 1))
+      {
+         /* keep the load of the SCT interrupt low */
+         frequencyMax = DIO_PWM_IRQ_FREQUENCY_MAX;
+      }
+   }
+
+   if((param == NULL) || (param->outputs == 0))
+   {
+      ciaaDriverDio_stopPwm();
+      ret = 0;
+   }
+   else if(((param->outputs & ~valid) == 0) && (param->frequency != 0) &&
+           (param->frequency <= frequencyMax) &&
+           (ciaaDriverSct_takeH(CIAADRVSCT_OWNER_DIO)))
+   {
+      ticks = clock / param->frequency;
+      pre = ticks >> 16;
+      if(pre <= 0xff)
+      {
+         ticks /= (pre + 1);
+         restart = (pwm->enabled == false) || (ticks != pwm->ticks) || (pre != pwm->pre);
+
+         if(restart)
          {
-            Chip_GPIO_SetValue(LPC_GPIO_PORT, 5, 1<<13);
+            Chip_SCT_Init(LPC_SCT);
+            LPC_SCT->CTRL_H = DIO_SCT_CTRL_HALT | DIO_SCT_CTRL_CLRCTR;
+            LPC_SCT->CTRL_H = DIO_SCT_CTRL_HALT | DIO_SCT_CTRL_PRE(pre);
+            LPC_SCT->MATCH[DIO_PWM_MATCH].H = ticks - 1;
+            LPC_SCT->MATCHREL[DIO_PWM_MATCH].H = ticks - 1;
+            LPC_SCT->LIMIT_H = 1 << DIO_PWM_EVENT;
+            LPC_SCT->EVENT[DIO_PWM_EVENT].STATE = 1;
+            LPC_SCT->EVENT[DIO_PWM_EVENT].CTRL = DIO_SCT_EV_MATCHSEL(DIO_PWM_MATCH) |
+                  DIO_SCT_EV_HEVENT | DIO_SCT_EV_COMBMODE_MATCH;
+            pwm->ticks = ticks;
+            pwm->pre = pre;
+            pwm->enabled = true;
          }
-         break;
-      case 6:
-         if(value)
+
+         for(loopi = 0; loopi < DIO_PWM_CHANNELS; loopi++)
          {
-            Chip_GPIO_ClearValue(LPC_GPIO_PORT, 5, 1<<14);
+            ciaaDriverDio_setPwmChannel(loopi,
+                  (param->outputs >> ciaaDriverDio_pwmPins[loopi].output) & 1,
+                  param->duty[ciaaDriverDio_pwmPins[loopi].output]);
+            if(restart)
+            {
+               /* reload by hand, the counter is not running yet */
+               LPC_SCT->MATCH[DIO_PWM_MATCH + 1 + loopi].H =
+                     LPC_SCT->MATCHREL[DIO_PWM_MATCH + 1 + loopi].H;
+            }
          }
-         else
+         ciaaDriverDio_setPwmPins();
+
+         if(restart)
          {
-            Chip_GPIO_SetValue(LPC_GPIO_PORT, 5, 1<<14);
+            LPC_SCT->EVFLAG = 0x1F << DIO_PWM_EVENT;
+            NVIC_ClearPendingIRQ(SCT_IRQn);
+            NVIC_EnableIRQ(SCT_IRQn);
+            LPC_SCT->CTRL_H = DIO_SCT_CTRL_PRE(pre);
          }
-         break;
-      case 7:
-         if(value)
+
+         param->frequency = clock / (ticks * (pre + 1));
+         ret = 0;
+      }
+      else if(pwm->enabled == false)
+      {
+         ciaaDriverSct_giveH(CIAADRVSCT_OWNER_DIO);
+      }
+   }
+
+   return ret;
+}
+
+/** \brief drives the PWM channels without SCT output
+ **
+ ** Called by the SCT interrupt: the event at the limit turns them on, the
+ ** event of each channel turns it off.
+ **/
+static void ciaaDriverDio_pwmIRQHandler(void)
+{
+   ciaaDriverDio_pwmControlType * pwm = &ciaaDriverDio_pwm;
+   uint32_t flags = LPC_SCT->EVFLAG & (0x1F << DIO_PWM_EVENT);
+   uint8_t loopi;
+
+   LPC_SCT->EVFLAG = flags;
+
+   for(loopi = 0; loopi < DIO_PWM_CHANNELS; loopi++)
+   {
+      if(pwm->irqChannels & (1 << loopi))
+      {
+         if(flags & (1 << DIO_PWM_EVENT))
          {
-            Chip_GPIO_ClearValue(LPC_GPIO_PORT, 1, 1<<8);
+            ciaa_lpc4337_writeOutput(ciaaDriverDio_pwmPins[loopi].output, 1);
          }
-         else
+         if(flags & (1 << (DIO_PWM_EVENT + 1 + loopi)))
          {
-            Chip_GPIO_SetValue(LPC_GPIO_PORT, 1, 1<<8);
+            ciaa_lpc4337_writeOutput(ciaaDriverDio_pwmPins[loopi].output, 0);
          }
-         break;
-      default:
-         break;
+      }
    }
 }
 
@@ -267,7 +1295,72 @@ extern int32_t ciaaDriverDio_close(ciaaDevices_deviceType const * const device)
 
 extern int32_t ciaaDriverDio_ioctl(ciaaDevices_deviceType const * const device, int32_t const request, void * param)
 {
-   return -1;
+   int32_t ret = -1;
+
+   ciaaDriverDio_maskedType const * masked;
+
+   if(device == ciaaDioDevices[0])
+   {
+      switch(request)
+      {
+         case CIAADRVDIO_IOCTL_SET_EVENTS:
+            ciaaDriverDio_setEvents((bool)(intptr_t)param);
+            ret = 0;
+            break;
+
+         case CIAADRVDIO_IOCTL_SET_DEBOUNCE:
+            ret = ciaaDriverDio_setDebounce((ciaaDriverDio_debounceType const *)param);
+            break;
+
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+         case CIAADRVDIO_IOCTL_START_CAPTURE:
+            if(param == NULL)
+            {
+               ciaaDriverDio_stopCapture();
+               ret = 0;
+            }
+            else
+            {
+               ret = ciaaDriverDio_startCapture((ciaaDriverDio_captureType *)param);
+            }
+            break;
+#endif
+      }
+   }
+   else if(device == ciaaDioDevices[1])
+   {
+      switch(request)
+      {
+         case CIAADRVDIO_IOCTL_SET_BITS:
+            ciaaDriverDio_modifyOutputs((uint8_t)(intptr_t)param, 0, 0);
+            ret = 0;
+            break;
+
+         case CIAADRVDIO_IOCTL_CLEAR_BITS:
+            ciaaDriverDio_modifyOutputs(0, (uint8_t)(intptr_t)param, 0);
+            ret = 0;
+            break;
+
+         case CIAADRVDIO_IOCTL_TOGGLE_BITS:
+            ciaaDriverDio_modifyOutputs(0, 0, (uint8_t)(intptr_t)param);
+            ret = 0;
+            break;
+
+         case CIAADRVDIO_IOCTL_WRITE_MASKED:
+            masked = (ciaaDriverDio_maskedType const *)param;
+            if(masked != NULL)
+            {
+               ciaaDriverDio_modifyOutputs(masked->value & masked->mask, ~masked->value & masked->mask, 0);
+               ret = 0;
+            }
+            break;
+
+         case CIAADRVDIO_IOCTL_SET_PWM:
+            ret = ciaaDriverDio_setPwm((ciaaDriverDio_pwmType *)param);
+            break;
+      }
+   }
+   return ret;
 }
 
 extern int32_t ciaaDriverDio_read(ciaaDevices_deviceType const * const device, uint8_t* buffer, uint32_t size)
@@ -277,11 +1370,20 @@ extern int32_t ciaaDriverDio_read(ciaaDevices_deviceType const * const device, u
    /* Can't store read result in buffer. At least 1 byte required. */
    if(size != 0)
    {
-      if(device == ciaaDioDevices[0])
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+      if((device == ciaaDioDevices[0]) && (ciaaDriverDio_capture.state != DIO_CAPTURE_IDLE))
       {
-
-         buffer[0] = ~((uint8_t) ((Chip_GPIO_ReadValue(LPC_GPIO_PORT,3) & (0x0F<<11))>>7)
-                              | (Chip_GPIO_ReadValue(LPC_GPIO_PORT,2) & 0x0F));
+         ret = ciaaDriverDio_readCapture(buffer, size);
+      }
+      else
+#endif
+      if((device == ciaaDioDevices[0]) && (ciaaDriverDio_inputEvents.enabled))
+      {
+         ret = ciaaDriverDio_readEvents(buffer, size);
+      }
+      else if(device == ciaaDioDevices[0])
+      {
+         buffer[0] = ciaaDriverDio_sampleInputs(ciaaDriverTime_get(), false);
 
          /* 1 byte read */
          ret = 1;
@@ -315,15 +1417,8 @@ extern int32_t ciaaDriverDio_write(ciaaDevices_deviceType const * const device,
       }
       else if(device == ciaaDioDevices[1])
       {
-         int32_t i;
-
-         for(i = 0; i < 8; i++)
-         {
-            ciaa_lpc4337_writeOutput(i, buffer[0] & (1 << i));
-         }
-
-         /* save actual output state in layer data */
-         *((ciaaDriverDio_dioType *)device->layer) = buffer[0];
+         /* the output state is saved in layer data */
+         ciaaDriverDio_writeOutputs(buffer[0]);
 
          /* 1 byte written */
          ret = 1;
@@ -352,7 +1447,87 @@ void ciaaDriverDio_init(void)
 }
 
 
+extern void ciaaDriverDio_dmaIRQHandler(void)
+{
+#ifdef CIAADRVDIO_CAPTURE_SAMPLES
+   ciaaDriverDio_captureControlType * capture = &ciaaDriverDio_capture;
+
+   if(capture->state == DIO_CAPTURE_RUNNING)
+   {
+      if((capture->pending & 0x01) &&
+         (Chip_GPDMA_Interrupt(LPC_GPDMA, capture->channel[0]) == SUCCESS))
+      {
+         capture->pending &= ~0x01;
+      }
+      if((capture->pending & 0x02) &&
+         (Chip_GPDMA_Interrupt(LPC_GPDMA, capture->channel[1]) == SUCCESS))
+      {
+         capture->pending &= ~0x02;
+      }
+      if(capture->pending == 0)
+      {
+         Chip_TIMER_Disable(DIO_CAPTURE_TIMER);
+         capture->state = DIO_CAPTURE_DONE;
+         ciaaDriverDma_giveLine(DIO_CAPTURE_DMA_PORT2, CIAADRVDMA_OWNER_DIO);
+         ciaaDriverDma_giveLine(DIO_CAPTURE_DMA_PORT3, CIAADRVDMA_OWNER_DIO);
+#ifdef CIAADRVDIO_EVENTS_TASK
+         SetEvent(CIAADRVDIO_EVENTS_TASK, CIAADRVDIO_EVENTS_EVENT);
+#endif
+      }
+   }
+#endif
+}
+
 /*==================[interrupt hanlders]=====================================*/
+ISR(GPIO0_IRQHandler)
+{
+   ciaaDriverDio_pinIRQHandler(0);
+}
+
+ISR(GPIO1_IRQHandler)
+{
+   ciaaDriverDio_pinIRQHandler(1);
+}
+
+ISR(GPIO2_IRQHandler)
+{
+   ciaaDriverDio_pinIRQHandler(2);
+}
+
+ISR(GPIO3_IRQHandler)
+{
+   ciaaDriverDio_pinIRQHandler(3);
+}
+
+ISR(GPIO4_IRQHandler)
+{
+   ciaaDriverDio_pinIRQHandler(4);
+}
+
+ISR(GPIO5_IRQHandler)
+{
+   ciaaDriverDio_pinIRQHandler(5);
+}
+
+ISR(GPIO6_IRQHandler)
+{
+   ciaaDriverDio_pinIRQHandler(6);
+}
+
+ISR(GPIO7_IRQHandler)
+{
+   ciaaDriverDio_pinIRQHandler(7);
+}
+
+ISR(RIT_IRQHandler)
+{
+   ciaaDriverDio_debounceIRQHandler();
+}
+
+ISR(SCT_IRQHandler)
+{
+   ciaaDriverDio_pwmIRQHandler();
+}
 
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
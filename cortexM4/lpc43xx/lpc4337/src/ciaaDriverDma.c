@@ -0,0 +1,128 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief GPDMA shared by the LPC4337 Drivers
+ **
+ ** Initializes the GPDMA controller once and dispatches its interrupt to
+ ** the drivers using it.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverDma_Internal.h"
+#include "ciaaPOSIX_stdbool.h"
+#include "chip.h"
+#include "os.h"
+
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief the controller was already initialized */
+static bool ciaaDriverDma_initialized = false;
+
+/** \brief owners of the request lines, CIAADRVDMA_OWNER_* */
+static uint8_t ciaaDriverDma_owner[CIAADRVDMA_LINES];
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+extern void ciaaDriverDma_init(void)
+{
+   if (ciaaDriverDma_initialized == false)
+   {
+      /* Initialize GPDMA controller */
+      Chip_GPDMA_Init(LPC_GPDMA);
+
+      /* Setup GPDMA interrupt */
+      NVIC_DisableIRQ(DMA_IRQn);
+      NVIC_SetPriority(DMA_IRQn, ((0x01 << 3) | 0x01));
+      NVIC_EnableIRQ(DMA_IRQn);
+
+      ciaaDriverDma_initialized = true;
+   }
+}
+
+extern bool ciaaDriverDma_takeLine(uint8_t line, uint8_t owner)
+{
+   uint32_t primask;
+   bool ret = false;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+   if ((ciaaDriverDma_owner[line] == CIAADRVDMA_OWNER_NONE) || (ciaaDriverDma_owner[line] == owner))
+   {
+      ciaaDriverDma_owner[line] = owner;
+      ret = true;
+   }
+   __set_PRIMASK(primask);
+
+   return ret;
+}
+
+extern void ciaaDriverDma_giveLine(uint8_t line, uint8_t owner)
+{
+   uint32_t primask;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+   if (ciaaDriverDma_owner[line] == owner)
+   {
+      ciaaDriverDma_owner[line] = CIAADRVDMA_OWNER_NONE;
+   }
+   __set_PRIMASK(primask);
+}
+
+/*==================[interrupt handlers]=====================================*/
+ISR(DMA_IRQHandler)
+{
+   ciaaDriverAio_dmaIRQHandler();
+   ciaaDriverUart_dmaIRQHandler();
+   ciaaDriverDio_dmaIRQHandler();
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+
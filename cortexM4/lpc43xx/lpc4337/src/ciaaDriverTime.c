@@ -0,0 +1,131 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Time base shared by the LPC4337 Drivers
+ **
+ ** Extends the DWT cycle counter to 64 bits. The counter has no overflow
+ ** interrupt, so a timer calls ciaaDriverTime_get once per second to see
+ ** every wrap also when no driver uses the time base for a long time.
+ ** The interrupt TIMER3_IRQHandler shall be declared in the OIL file.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverTime_Internal.h"
+#include "ciaaPOSIX_stdbool.h"
+#include "chip.h"
+#include "os.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief timer keeping the extension running */
+#define TIME_TIMER               LPC_TIMER3
+#define TIME_TIMER_IRQn          TIMER3_IRQn
+#define TIME_TIMER_CLOCK         CLK_MX_TIMER3
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief count of wraps of the cycle counter */
+static uint32_t ciaaDriverTime_high = 0;
+
+/** \brief cycle counter at the last call */
+static uint32_t ciaaDriverTime_last = 0;
+
+/** \brief the cycle counter and the timer run */
+static bool ciaaDriverTime_started = false;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+extern void ciaaDriverTime_init(void)
+{
+   if (ciaaDriverTime_started == false)
+   {
+      CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+      DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+      /* one match per second, far below the 21 s of a wrap at 204 MHz */
+      Chip_TIMER_Init(TIME_TIMER);
+      Chip_TIMER_Reset(TIME_TIMER);
+      Chip_TIMER_PrescaleSet(TIME_TIMER, 0);
+      Chip_TIMER_SetMatch(TIME_TIMER, 0, Chip_Clock_GetRate(TIME_TIMER_CLOCK) - 1);
+      Chip_TIMER_ResetOnMatchEnable(TIME_TIMER, 0);
+      Chip_TIMER_MatchEnableInt(TIME_TIMER, 0);
+      NVIC_ClearPendingIRQ(TIME_TIMER_IRQn);
+      NVIC_EnableIRQ(TIME_TIMER_IRQn);
+      Chip_TIMER_Enable(TIME_TIMER);
+
+      ciaaDriverTime_started = true;
+   }
+}
+
+extern uint64_t ciaaDriverTime_get(void)
+{
+   uint32_t primask;
+   uint32_t now;
+   uint32_t high;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+   now = DWT->CYCCNT;
+   if (now < ciaaDriverTime_last)
+   {
+      ciaaDriverTime_high++;
+   }
+   ciaaDriverTime_last = now;
+   high = ciaaDriverTime_high;
+   __set_PRIMASK(primask);
+
+   return ((uint64_t) high << 32) | now;
+}
+
+/*==================[interrupt handlers]=====================================*/
+ISR(TIMER3_IRQHandler)
+{
+   Chip_TIMER_ClearMatch(TIME_TIMER, 0);
+   (void) ciaaDriverTime_get();
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
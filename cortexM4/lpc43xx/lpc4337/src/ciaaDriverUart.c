@@ -59,8 +59,14 @@
 
 /*==================[inclusions]=============================================*/
 #include "ciaaDriverUart.h"
+#include "ciaaDriverUart_Ioctl.h"
+#include "ciaaDriverUart_Ring.h"
 #include "ciaaPOSIX_stdlib.h"
 #include "ciaaPOSIX_stdio.h"
+#include "ciaaPOSIX_string.h"
+#include "ciaaDriverDma_Internal.h"
+#include "ciaaDriverCrc.h"
+#include "ciaaDriverUart_Deferred.h"
 #include "chip.h"
 #include "os.h"
 
@@ -71,21 +77,248 @@ typedef struct  {
    uint8_t countOfDevices;
 } ciaaDriverConstType;
 
-#define UART_RX_FIFO_SIZE       (16)
+/** \brief default size of the receive buffer of each port
+ **
+ ** May be overwritten from the makefile, for all the ports or for each one
+ ** with UART0_RX_BUFFER_SIZE, UART1_RX_BUFFER_SIZE, UART2_RX_BUFFER_SIZE and
+ ** UART3_RX_BUFFER_SIZE. The sizes shall be powers of two.
+ **/
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE     (256)
+#endif
+
+#ifndef UART0_RX_BUFFER_SIZE
+#define UART0_RX_BUFFER_SIZE    UART_RX_BUFFER_SIZE
+#endif
+
+#ifndef UART1_RX_BUFFER_SIZE
+#define UART1_RX_BUFFER_SIZE    UART_RX_BUFFER_SIZE
+#endif
+
+#ifndef UART2_RX_BUFFER_SIZE
+#define UART2_RX_BUFFER_SIZE    UART_RX_BUFFER_SIZE
+#endif
+
+#ifndef UART3_RX_BUFFER_SIZE
+#define UART3_RX_BUFFER_SIZE    UART_RX_BUFFER_SIZE
+#endif
+
+#if (((UART0_RX_BUFFER_SIZE) & ((UART0_RX_BUFFER_SIZE) - 1)) != 0) || \
+    (((UART1_RX_BUFFER_SIZE) & ((UART1_RX_BUFFER_SIZE) - 1)) != 0) || \
+    (((UART2_RX_BUFFER_SIZE) & ((UART2_RX_BUFFER_SIZE) - 1)) != 0) || \
+    (((UART3_RX_BUFFER_SIZE) & ((UART3_RX_BUFFER_SIZE) - 1)) != 0)
+#error the UART receive buffer sizes shall be powers of two
+#endif
+
+/** \brief size of the transmit DMA buffer of each port
+ **
+ ** May be overwritten from the makefile, not bigger than 4095 bytes, the
+ ** max size of a single GPDMA transfer.
+ **/
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE     (256)
+#endif
+
+#if (UART_TX_BUFFER_SIZE > 4095)
+#error the UART transmit buffer shall not be bigger than 4095 bytes
+#endif
+
+/** \brief default size from which writes are transmitted by DMA
+ **
+ ** Smaller writes are written to the hardware FIFO. May be overwritten
+ ** from the makefile or changed per port with
+ ** CIAADRVUART_IOCTL_SET_TX_DMA_THRESHOLD.
+ **/
+#ifndef UART_TX_DMA_THRESHOLD
+#define UART_TX_DMA_THRESHOLD   (16)
+#endif
+
+/** \brief count of dma blocks of the receive ring
+ **
+ ** In dma receive mode the upper layer is notified each time a block is
+ ** filled and at the end of each burst. Each block shall not be bigger
+ ** than 4095 bytes.
+ **/
+#define UART_RX_DMA_BLOCKS      (4)
+
+#if ((UART0_RX_BUFFER_SIZE) < UART_RX_DMA_BLOCKS) || ((UART0_RX_BUFFER_SIZE) / UART_RX_DMA_BLOCKS > 4095) || \
+    ((UART1_RX_BUFFER_SIZE) < UART_RX_DMA_BLOCKS) || ((UART1_RX_BUFFER_SIZE) / UART_RX_DMA_BLOCKS > 4095) || \
+    ((UART2_RX_BUFFER_SIZE) < UART_RX_DMA_BLOCKS) || ((UART2_RX_BUFFER_SIZE) / UART_RX_DMA_BLOCKS > 4095) || \
+    ((UART3_RX_BUFFER_SIZE) < UART_RX_DMA_BLOCKS) || ((UART3_RX_BUFFER_SIZE) / UART_RX_DMA_BLOCKS > 4095)
+#error the UART receive buffers do not fit the dma blocks
+#endif
+
+/** \brief remaining transfers field of the GPDMA channel control register */
+#define UART_DMA_TRANSFER_SIZE_MASK (0xFFF)
+
+/** \brief depth of the receive FIFO */
+#define UART_RX_FIFO_DEPTH      (16)
+
+/** \brief polls of the line status without progress of the dma after
+ ** which the receive FIFO is no longer waited for
+ **
+ ** Below the trigger level the dma only takes the bytes at the character
+ ** timeout. May be overwritten from the makefile.
+ **/
+#ifndef UART_RX_DMA_DRAIN_POLLS
+#define UART_RX_DMA_DRAIN_POLLS (64)
+#endif
+
+/** \brief max error of the baud rate, in 1/1000 of the requested rate
+ **
+ ** May be overwritten from the makefile.
+ **/
+#ifndef UART_BAUD_TOLERANCE
+#define UART_BAUD_TOLERANCE     (20)
+#endif
+
+/** \brief fractional divider disabled: DIVADDVAL 0, MULVAL 1 */
+#define UART_FDR_DISABLED       (0x10)
+
+/** \brief deferred processing, see ciaaDriverUart_Deferred.h */
+#if (defined CIAADRVUART_DEFERRED_TASK) && !(defined CIAADRVUART_DEFERRED_EVENT)
+#error CIAADRVUART_DEFERRED_EVENT shall be defined together with CIAADRVUART_DEFERRED_TASK
+#endif
+
+/** \brief deferred work of a port: bytes received */
+#define UART_DEFERRED_RX        (0x01)
+
+/** \brief deferred work of a port: transmission of the FIFO completed */
+#define UART_DEFERRED_TX        (0x02)
 
+/** \brief deferred work of a port: dma transmission completed */
+#define UART_DEFERRED_TXDMA     (0x04)
+
+/** \brief count of ports
+ **
+ ** USART0, USART2 and USART3 are wired on the board. UART1 shares its pins
+ ** with other functions and is only added when CIAADRVUART_ENABLE_UART1 is
+ ** defined, its irq shall then be declared in the OIL file too.
+ **/
+#ifdef CIAADRVUART_ENABLE_UART1
+#define UART_PORT_COUNT         (4)
+#else
+#define UART_PORT_COUNT         (3)
+#endif
+
+/** \brief max count of pins of a port */
+#define UART_PORT_PINS          (3)
+
+/** \brief pin muxed to a port */
+typedef struct {
+   uint8_t port;                       /** <= SCU port */
+   uint8_t pin;                        /** <= SCU pin */
+   uint16_t mode;                      /** <= SCU mode */
+   uint16_t func;                      /** <= SCU function */
+} ciaaDriverUartPinType;
+
+/** \brief control of a port
+ **
+ ** The constant part describes the hardware of the port and is used by
+ ** hwInit, the rest is the state of the driver.
+ **
+ ** The irq is the only writer of rxhead and read the only writer of rxtail,
+ ** see ciaaDriverUart_Ring.h.
+ **/
 typedef struct {
-   uint8_t hwbuf[UART_RX_FIFO_SIZE];
-   uint8_t rxcnt;
+   LPC_USART_T * const uart;           /** <= registers of the port */
+   CHIP_CCU_CLK_T const clk;           /** <= clock of the port */
+   uint8_t const pinCount;             /** <= count of pins */
+   ciaaDriverUartPinType const pins[UART_PORT_PINS]; /** <= pins of the port */
+   uint32_t const rs485;               /** <= RS485 flags, 0: no RS485 */
+   uint8_t * const rxbuf;              /** <= receive ring */
+   uint32_t const rxmask;              /** <= size of the ring - 1 */
+   uint8_t * const txbuf;              /** <= transmit DMA buffer */
+   uint8_t const tx_dma_conn;          /** <= transmit dma connection */
+   uint8_t const rx_dma_conn;          /** <= receive dma connection */
+   uint8_t const tx_dma_line;          /** <= DMAMUX line of the transmit requests */
+   uint8_t const rx_dma_line;          /** <= DMAMUX line of the receive requests */
+   DMA_TransferDescriptor_t * const rxlli; /** <= receive dma linked list */
+   volatile uint32_t rxhead;           /** <= next byte written by the irq */
+   volatile uint32_t rxtail;           /** <= next byte read */
+   uint32_t rxoverruns;                /** <= received bytes lost */
+   bool rxdma;                         /** <= bytes received by dma */
+   uint8_t rx_dma_channel;             /** <= receive dma channel */
+   volatile uint32_t rxdmabase;        /** <= index of the block being filled by the dma */
+   bool txbusy;                        /** <= dma transmission in progress */
+   uint8_t tx_dma_channel;             /** <= transmit dma channel */
+   uint32_t txcnt;                     /** <= bytes of the last write */
+   uint32_t txthreshold;               /** <= min write size sent by dma, 0: never */
+   uint8_t rs485mode;                  /** <= one of CIAADRVUART_RS485_* */
+   uint8_t rs485address;               /** <= own RS485 multidrop address */
+   ciaaDriverCrc_contextType * rxcrc;  /** <= CRC of the bytes read, NULL: none */
+   ciaaDriverCrc_contextType * txcrc;  /** <= CRC of the bytes written, NULL: none */
+   volatile uint8_t deferred;          /** <= UART_DEFERRED_* work for the task */
+   uint32_t baudrate;                  /** <= baud rate achieved, 0: autobaud */
+   bool autobaud;                      /** <= autobaud in progress */
 } ciaaDriverUartControl;
 
+/** \brief line control of the RS485 modes
+ **
+ ** In the multidrop modes the parity bit is the 9th bit, forced to 1 for
+ ** address bytes and to 0 for data bytes.
+ **/
+#define UART_LCR_RS485_DATA     (UART_LCR_WLEN8 | UART_LCR_SBS_1BIT | UART_LCR_PARITY_EN | UART_LCR_PARITY_F_0)
+#define UART_LCR_RS485_ADDRESS  (UART_LCR_WLEN8 | UART_LCR_SBS_1BIT | UART_LCR_PARITY_EN | UART_LCR_PARITY_F_1)
+
 /*==================[internal data declaration]==============================*/
 
 /*==================[internal functions declaration]=========================*/
 
 /*==================[internal data definition]===============================*/
 
-/** \brief Buffers */
-ciaaDriverUartControl uartControl[3];
+/** \brief receive rings */
+static uint8_t ciaaDriverUart_rxBuffer0[UART0_RX_BUFFER_SIZE];
+#ifdef CIAADRVUART_ENABLE_UART1
+static uint8_t ciaaDriverUart_rxBuffer1[UART1_RX_BUFFER_SIZE];
+#endif
+static uint8_t ciaaDriverUart_rxBuffer2[UART2_RX_BUFFER_SIZE];
+static uint8_t ciaaDriverUart_rxBuffer3[UART3_RX_BUFFER_SIZE];
+
+/** \brief transmit DMA buffers */
+static uint8_t ciaaDriverUart_txBuffer[UART_PORT_COUNT][UART_TX_BUFFER_SIZE];
+
+/** \brief receive GPDMA linked lists, descriptors shall be word aligned */
+static DMA_TransferDescriptor_t ciaaDriverUart_rxLli[UART_PORT_COUNT][UART_RX_DMA_BLOCKS] __attribute__ ((aligned (4)));
+
+/** \brief Ports, indexed as the devices
+ **
+ ** Only the constant part is initialized here, the state starts zeroed and
+ ** is completed by hwInit.
+ **/
+ciaaDriverUartControl uartControl[UART_PORT_COUNT] = {
+   /* UART0 (RS485/Profibus) */
+   { LPC_USART0, CLK_MX_UART0,
+     3, { { 9, 5, MD_PDN, FUNC7 },                 /* P9_5: UART0_TXD */
+          { 9, 6, MD_PLN|MD_EZI|MD_ZI, FUNC7 },    /* P9_6: UART0_RXD */
+          { 6, 2, MD_PDN, FUNC2 } },               /* P6_2: UART0_DIR */
+     UART_RS485CTRL_DCTRL_EN | UART_RS485CTRL_OINV_1,
+     ciaaDriverUart_rxBuffer0, UART0_RX_BUFFER_SIZE - 1, ciaaDriverUart_txBuffer[0], GPDMA_CONN_UART0_Tx,
+     GPDMA_CONN_UART0_Rx, 1, 2, ciaaDriverUart_rxLli[0] },
+   /* UART2 (USB-UART) */
+   { LPC_USART2, CLK_MX_UART2,
+     2, { { 7, 1, MD_PDN, FUNC6 },                 /* P7_1: UART2_TXD */
+          { 7, 2, MD_PLN|MD_EZI|MD_ZI, FUNC6 } },  /* P7_2: UART2_RXD */
+     0,
+     ciaaDriverUart_rxBuffer2, UART2_RX_BUFFER_SIZE - 1, ciaaDriverUart_txBuffer[1], GPDMA_CONN_UART2_Tx,
+     GPDMA_CONN_UART2_Rx, 5, 6, ciaaDriverUart_rxLli[1] },
+   /* UART3 (RS232) */
+   { LPC_USART3, CLK_MX_UART3,
+     2, { { 2, 3, MD_PDN, FUNC2 },                 /* P2_3: UART3_TXD */
+          { 2, 4, MD_PLN|MD_EZI|MD_ZI, FUNC2 } },  /* P2_4: UART3_RXD */
+     0,
+     ciaaDriverUart_rxBuffer3, UART3_RX_BUFFER_SIZE - 1, ciaaDriverUart_txBuffer[2], GPDMA_CONN_UART3_Tx,
+     GPDMA_CONN_UART3_Rx, 7, 8, ciaaDriverUart_rxLli[2] },
+#ifdef CIAADRVUART_ENABLE_UART1
+   /* UART1 (expansion connector) */
+   { LPC_UART1, CLK_MX_UART1,
+     2, { { 1, 13, MD_PDN, FUNC1 },                /* P1_13: UART1_TXD */
+          { 1, 14, MD_PLN|MD_EZI|MD_ZI, FUNC1 } }, /* P1_14: UART1_RXD */
+     0,
+     ciaaDriverUart_rxBuffer1, UART1_RX_BUFFER_SIZE - 1, ciaaDriverUart_txBuffer[3], GPDMA_CONN_UART1_Tx,
+     GPDMA_CONN_UART1_Rx, 3, 4, ciaaDriverUart_rxLli[3] },
+#endif
+};
 
 /** \brief Device for UART 0 */
 static ciaaDevices_deviceType ciaaDriverUart_device0 = {
@@ -129,77 +362,664 @@ static ciaaDevices_deviceType ciaaDriverUart_device2 = {
    LPC_USART3              /** <= lower layer */
 };
 
+#ifdef CIAADRVUART_ENABLE_UART1
+/** \brief Device for UART 3 */
+static ciaaDevices_deviceType ciaaDriverUart_device3 = {
+   "uart/3",               /** <= driver name */
+   ciaaDriverUart_open,    /** <= open function */
+   ciaaDriverUart_close,   /** <= close function */
+   ciaaDriverUart_read,    /** <= read function */
+   ciaaDriverUart_write,   /** <= write function */
+   ciaaDriverUart_ioctl,   /** <= ioctl function */
+   NULL,                   /** <= seek function is not provided */
+   NULL,                   /** <= uper layer */
+   &(uartControl[3]),      /** <= layer */
+   LPC_UART1               /** <= lower layer */
+};
+#endif
+
 static ciaaDevices_deviceType * const ciaaUartDevices[] = {
    &ciaaDriverUart_device0,
    &ciaaDriverUart_device1,
-   &ciaaDriverUart_device2
+   &ciaaDriverUart_device2,
+#ifdef CIAADRVUART_ENABLE_UART1
+   &ciaaDriverUart_device3,
+#endif
 };
 
 static ciaaDriverConstType const ciaaDriverUartConst = {
    ciaaUartDevices,
-   3
+   UART_PORT_COUNT
 };
 
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
+/** \brief checks that a device belongs to this driver
+ **
+ ** The layer of each device points to its port, this is checked against
+ ** the bounds of the port table instead of comparing with each device.
+ **/
+static bool ciaaDriverUart_isDevice(ciaaDevices_deviceType const * const device)
+{
+   ciaaDriverUartControl const * pUartControl = (ciaaDriverUartControl const *)device->layer;
+
+   return (pUartControl >= &uartControl[0]) && (pUartControl < &uartControl[UART_PORT_COUNT]) &&
+          (pUartControl->uart == (LPC_USART_T *)device->loLayer);
+}
+
+#ifdef CIAADRVUART_DEFERRED_TASK
+/** \brief hands work of a port over to the deferred task
+ **
+ ** Called from the UART and the GPDMA irqs, which may preempt each other.
+ **/
+static void ciaaDriverUart_defer(ciaaDevices_deviceType const * const device, uint8_t const work)
+{
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t primask;
+
+   primask = __get_PRIMASK();
+   __disable_irq();
+   pUartControl->deferred |= work;
+   __set_PRIMASK(primask);
+
+   SetEvent(CIAADRVUART_DEFERRED_TASK, CIAADRVUART_DEFERRED_EVENT);
+}
+#endif
+
 static void ciaaDriverUart_rxIndication(ciaaDevices_deviceType const * const device, uint32_t const nbyte)
 {
+#ifdef CIAADRVUART_DEFERRED_TASK
+   /* the task notifies the bytes in the ring when it runs */
+   ciaaDriverUart_defer(device, UART_DEFERRED_RX);
+#else
    /* receive the data and forward to upper layer */
    ciaaSerialDevices_rxIndication(device->upLayer, nbyte);
+#endif
 }
 
-static void ciaaDriverUart_txConfirmation(ciaaDevices_deviceType const * const device)
+static void ciaaDriverUart_txConfirmation(ciaaDevices_deviceType const * const device, uint32_t const nbyte)
 {
    /* receive the data and forward to upper layer */
-   ciaaSerialDevices_txConfirmation(device->upLayer, 1 );
+   ciaaSerialDevices_txConfirmation(device->upLayer, nbyte);
 }
 
-static void ciaaDriverUart_hwInit(void)
+/** \brief completes the dma transmission of a port, if any
+ **
+ ** The upper layer gets a single confirmation with the count of bytes
+ ** sent. If it writes less than the dma threshold the THRE irq is enabled
+ ** to continue.
+ **/
+static void ciaaDriverUart_txDmaIRQHandler(ciaaDevices_deviceType const * const device)
 {
-   /* UART0 (RS485/Profibus) */
-   Chip_UART_Init(LPC_USART0);
-   Chip_UART_SetBaud(LPC_USART0, 115200);
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
 
-   Chip_UART_SetupFIFOS(LPC_USART0, UART_FCR_FIFO_EN | UART_FCR_TRG_LEV0);
+   if((pUartControl->txbusy) &&
+      (Chip_GPDMA_Interrupt(LPC_GPDMA, pUartControl->tx_dma_channel) == SUCCESS))
+   {
+      pUartControl->txbusy = false;
+      ciaaDriverDma_giveLine(pUartControl->tx_dma_line, CIAADRVDMA_OWNER_UART);
 
-   Chip_UART_TXEnable(LPC_USART0);
+#ifdef CIAADRVUART_DEFERRED_TASK
+      ciaaDriverUart_defer(device, UART_DEFERRED_TXDMA);
+#else
+      /* this one calls write */
+      ciaaDriverUart_txConfirmation(device, pUartControl->txcnt);
 
-   Chip_SCU_PinMux(9, 5, MD_PDN, FUNC7);              /* P9_5: UART0_TXD */
-   Chip_SCU_PinMux(9, 6, MD_PLN|MD_EZI|MD_ZI, FUNC7); /* P9_6: UART0_RXD */
+      if(pUartControl->txbusy == false)
+      {
+         Chip_UART_IntEnable((LPC_USART_T *)device->loLayer, UART_IER_THREINT);
+      }
+#endif
+   }
+}
 
-   Chip_UART_SetRS485Flags(LPC_USART0, UART_RS485CTRL_DCTRL_EN | UART_RS485CTRL_OINV_1);
+/** \brief gets the block being filled by the receive dma
+ **
+ ** A completed block whose irq is still pending is counted, so the
+ ** position is never behind the dma. Called with the dma irq disabled or
+ ** from a task.
+ **
+ ** \param[out] remaining transfers left in the block
+ ** \return index of the start of the block
+ **/
+static uint32_t ciaaDriverUart_rxDmaBlock(ciaaDevices_deviceType const * const device, uint32_t * remaining)
+{
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t block = (pUartControl->rxmask + 1) / UART_RX_DMA_BLOCKS;
+   uint32_t mask = 1 << pUartControl->rx_dma_channel;
+   uint32_t base;
+   uint32_t pending;
+
+   /* read again if the block completed or its irq came meanwhile */
+   do
+   {
+      base = pUartControl->rxdmabase;
+      pending = LPC_GPDMA->INTTCSTAT & mask;
+      *remaining = LPC_GPDMA->CH[pUartControl->rx_dma_channel].CONTROL & UART_DMA_TRANSFER_SIZE_MASK;
+   } while((pending != (LPC_GPDMA->INTTCSTAT & mask)) || (base != pUartControl->rxdmabase));
 
-   Chip_SCU_PinMux(6, 2, MD_PDN, FUNC2);              /* P6_2: UART0_DIR */
+   return base + ((pending != 0) ? block : 0);
+}
 
-   /* UART2 (USB-UART) */
-   Chip_UART_Init(LPC_USART2);
-   Chip_UART_SetBaud(LPC_USART2, 115200);
+/** \brief publishes the bytes stored by the receive dma
+ **
+ ** The head follows the position of the dma, see
+ ** ciaaDriverUart_ringDmaHead. The upper layer is only notified when the
+ ** head moved.
+ **
+ ** At the character timeout the last bytes of a burst may still be in the
+ ** FIFO, the irq source clears with the dma request, so the dma is waited
+ ** for to empty the FIFO, at most UART_RX_FIFO_DEPTH bytes.
+ **/
+static void ciaaDriverUart_rxDmaFlush(ciaaDevices_deviceType const * const device)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t block = (pUartControl->rxmask + 1) / UART_RX_DMA_BLOCKS;
+   uint32_t remaining;
+   uint32_t last;
+   uint32_t base;
+   uint32_t head;
+   uint32_t drained = 0;
+   uint32_t polls = 0;
+   bool moved = false;
+
+   last = LPC_GPDMA->CH[pUartControl->rx_dma_channel].CONTROL & UART_DMA_TRANSFER_SIZE_MASK;
+   while((Chip_UART_ReadLineStatus(uart) & UART_LSR_RDR) &&
+         (drained < UART_RX_FIFO_DEPTH) && (polls < UART_RX_DMA_DRAIN_POLLS))
+   {
+      remaining = LPC_GPDMA->CH[pUartControl->rx_dma_channel].CONTROL & UART_DMA_TRANSFER_SIZE_MASK;
+      if(remaining != last)
+      {
+         last = remaining;
+         drained++;
+         polls = 0;
+      }
+      else
+      {
+         polls++;
+      }
+   }
 
-   Chip_UART_SetupFIFOS(LPC_USART2, UART_FCR_FIFO_EN | UART_FCR_TRG_LEV0);
+   NVIC_DisableIRQ(DMA_IRQn);
+   base = ciaaDriverUart_rxDmaBlock(device, &remaining);
+   head = ciaaDriverUart_ringDmaHead(pUartControl->rxhead, base, block, remaining);
+   if(head != pUartControl->rxhead)
+   {
+      pUartControl->rxhead = head;
+      moved = true;
+   }
+   NVIC_EnableIRQ(DMA_IRQn);
 
-   Chip_UART_TXEnable(LPC_USART2);
+   if(moved)
+   {
+      ciaaDriverUart_rxIndication(device, pUartControl->rxhead - pUartControl->rxtail);
+   }
+}
 
-   Chip_SCU_PinMux(7, 1, MD_PDN, FUNC6);              /* P7_1: UART2_TXD */
-   Chip_SCU_PinMux(7, 2, MD_PLN|MD_EZI|MD_ZI, FUNC6); /* P7_2: UART2_RXD */
+/** \brief starts receiving by dma
+ **
+ ** The ring is split in UART_RX_DMA_BLOCKS blocks linked in a loop, each
+ ** one interrupts when it is filled. The bytes already in the ring are
+ ** discarded.
+ **
+ ** \return 0 if started, -1 if the DMAMUX line is used by another driver,
+ **         the port keeps receiving by irq
+ **/
+static int32_t ciaaDriverUart_rxDmaStart(ciaaDevices_deviceType const * const device)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t block = (pUartControl->rxmask + 1) / UART_RX_DMA_BLOCKS;
+   uint8_t loopi;
+   int32_t ret = -1;
 
-   /* UART3 (RS232) */
-   Chip_UART_Init(LPC_USART3);
-   Chip_UART_SetBaud(LPC_USART3, 115200);
+   if(ciaaDriverDma_takeLine(pUartControl->rx_dma_line, CIAADRVDMA_OWNER_UART))
+   {
+      for(loopi = 0; loopi < UART_RX_DMA_BLOCKS; loopi++)
+      {
+         Chip_GPDMA_InitDescriptor(LPC_GPDMA, &(pUartControl->rxlli[loopi]), pUartControl->rx_dma_conn,
+               (uint32_t)&(pUartControl->rxbuf[loopi * block]), block, GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA,
+               &(pUartControl->rxlli[(loopi + 1) % UART_RX_DMA_BLOCKS]));
+         pUartControl->rxlli[loopi].ctrl |= GPDMA_DMACCxControl_I;
+      }
+
+      /* the bytes arrived meanwhile are discarded with the FIFO */
+      Chip_UART_IntDisable(uart, UART_IER_RBRINT);
+      pUartControl->rxhead = 0;
+      pUartControl->rxtail = 0;
+      pUartControl->rxdmabase = 0;
+      /* the dma moves the bytes from the trigger level on, the character
+       * timeout of the last bytes of a burst flushes the block */
+      Chip_UART_SetupFIFOS(uart, UART_FCR_FIFO_EN | UART_FCR_DMAMODE_SEL | UART_FCR_RX_RS | UART_FCR_TRG_LEV2);
+
+      NVIC_DisableIRQ(DMA_IRQn);
+      pUartControl->rx_dma_channel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, pUartControl->rx_dma_conn);
+      Chip_GPDMA_SGTransfer(LPC_GPDMA, pUartControl->rx_dma_channel, &(pUartControl->rxlli[0]),
+            GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA);
+      pUartControl->rxdma = true;
+      NVIC_EnableIRQ(DMA_IRQn);
+
+      /* the RBR irq also enables the character timeout irq */
+      Chip_UART_IntEnable(uart, UART_IER_RBRINT);
+
+      ret = 0;
+   }
+
+   return ret;
+}
+
+/** \brief stops receiving by dma, the bytes received are kept */
+static void ciaaDriverUart_rxDmaStop(ciaaDevices_deviceType const * const device)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+
+   if(pUartControl->rxdma)
+   {
+      Chip_UART_IntDisable(uart, UART_IER_RBRINT);
+      ciaaDriverUart_rxDmaFlush(device);
+      NVIC_DisableIRQ(DMA_IRQn);
+      Chip_GPDMA_Stop(LPC_GPDMA, pUartControl->rx_dma_channel);
+      pUartControl->rxdma = false;
+      NVIC_EnableIRQ(DMA_IRQn);
+      Chip_UART_SetupFIFOS(uart, UART_FCR_FIFO_EN | UART_FCR_DMAMODE_SEL | UART_FCR_TRG_LEV0);
+      Chip_UART_IntEnable(uart, UART_IER_RBRINT);
+      ciaaDriverDma_giveLine(pUartControl->rx_dma_line, CIAADRVDMA_OWNER_UART);
+   }
+}
+
+/** \brief completes a receive dma block of a port, if any */
+static void ciaaDriverUart_rxDmaIRQHandler(ciaaDevices_deviceType const * const device)
+{
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t block = (pUartControl->rxmask + 1) / UART_RX_DMA_BLOCKS;
+
+   if((pUartControl->rxdma) &&
+      (Chip_GPDMA_Interrupt(LPC_GPDMA, pUartControl->rx_dma_channel) == SUCCESS))
+   {
+      pUartControl->rxdmabase += block;
+      /* the head reaches at least the end of the completed block */
+      pUartControl->rxhead = ciaaDriverUart_ringDmaHead(pUartControl->rxhead,
+            pUartControl->rxdmabase, block, block);
+      ciaaDriverUart_rxIndication(device, pUartControl->rxhead - pUartControl->rxtail);
+   }
+}
+
+/** \brief moves the received bytes from the hardware FIFO to the ring
+ **
+ ** The upper layer is notified with the count of bytes in the ring. Not
+ ** used in dma receive mode, the FIFO is left to the dma.
+ **
+ ** \param[in] status     line status read by the irq, reading it again
+ **                       would clear the overrun flag
+ **/
+static void ciaaDriverUart_rxIRQHandler(ciaaDevices_deviceType const * const device, uint32_t status)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t head = pUartControl->rxhead;
+   uint8_t data;
+   bool drop;
+
+   while(status & UART_LSR_RDR)
+   {
+      data = Chip_UART_ReadByte(uart);
+      drop = false;
+      if(status & UART_LSR_OE)
+      {
+         /* the hardware FIFO was full */
+         pUartControl->rxoverruns++;
+      }
+      if((pUartControl->rs485mode == CIAADRVUART_RS485_MULTIDROP) && (status & UART_LSR_PE))
+      {
+         /* address byte, the data bytes following it are only received
+          * when it is the own address */
+         if(data == pUartControl->rs485address)
+         {
+            Chip_UART_ClearRS485Flags(uart, UART_RS485CTRL_RX_DIS);
+         }
+         else
+         {
+            Chip_UART_SetRS485Flags(uart, UART_RS485CTRL_RX_DIS);
+            drop = true;
+         }
+      }
+      if(drop)
+      {
+         /* not addressed to this node */
+      }
+      else if(ciaaDriverUart_ringPut(pUartControl->rxbuf, pUartControl->rxmask, &head,
+                 pUartControl->rxtail, data) == false)
+      {
+         /* the ring is full, drop the byte */
+         pUartControl->rxoverruns++;
+      }
+      status = Chip_UART_ReadLineStatus(uart);
+   }
+
+   /* the data shall be stored before it is published */
+   __DMB();
+   pUartControl->rxhead = head;
+
+   ciaaDriverUart_rxIndication(device, head - pUartControl->rxtail);
+}
+
+/** \brief sets the RS485 mode of a port
+ **
+ ** The software multidrop mode needs the parity flag of each byte and
+ ** is refused in dma receive mode.
+ **/
+static int32_t ciaaDriverUart_setRs485(ciaaDevices_deviceType const * const device,
+      ciaaDriverUart_rs485Type const * const config)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t rxint = Chip_UART_GetIntsEnabled(uart) & UART_IER_RBRINT;
+   int32_t ret = -1;
+
+   if((pUartControl->rs485 != 0) && (config->mode <= CIAADRVUART_RS485_AUTO_ADDRESS) &&
+      ((config->mode != CIAADRVUART_RS485_MULTIDROP) || (pUartControl->rxdma == false)))
+   {
+      Chip_UART_IntDisable(uart, UART_IER_RBRINT);
+
+      Chip_UART_ClearRS485Flags(uart, UART_RS485CTRL_NMM_EN | UART_RS485CTRL_RX_DIS | UART_RS485CTRL_AADEN);
+      Chip_UART_SetRS485Delay(uart, config->delay);
+      Chip_UART_SetRS485Addr(uart, config->address);
+      pUartControl->rs485address = config->address;
+      pUartControl->rs485mode = config->mode;
+
+      switch(config->mode)
+      {
+         case CIAADRVUART_RS485_MULTIDROP:
+            /* receive nothing until the own address is seen */
+            Chip_UART_ConfigData(uart, UART_LCR_RS485_DATA);
+            Chip_UART_SetRS485Flags(uart, UART_RS485CTRL_NMM_EN | UART_RS485CTRL_RX_DIS);
+            break;
+
+         case CIAADRVUART_RS485_AUTO_ADDRESS:
+            Chip_UART_ConfigData(uart, UART_LCR_RS485_DATA);
+            Chip_UART_SetRS485Flags(uart, UART_RS485CTRL_NMM_EN | UART_RS485CTRL_RX_DIS | UART_RS485CTRL_AADEN);
+            break;
 
-   Chip_UART_SetupFIFOS(LPC_USART3, UART_FCR_FIFO_EN | UART_FCR_TRG_LEV0);
+         default:
+            Chip_UART_ConfigData(uart, UART_LCR_WLEN8 | UART_LCR_SBS_1BIT);
+            break;
+      }
 
-   Chip_UART_TXEnable(LPC_USART3);
+      Chip_UART_IntEnable(uart, rxint);
+      ret = 0;
+   }
 
-   Chip_SCU_PinMux(2, 3, MD_PDN, FUNC2);              /* P2_3: UART3_TXD */
-   Chip_SCU_PinMux(2, 4, MD_PLN|MD_EZI|MD_ZI, FUNC2); /* P2_4: UART3_RXD */
+   return ret;
+}
+
+/** \brief transmits a RS485 address byte
+ **
+ ** The parity is latched when a byte leaves the FIFO, so the line control
+ ** is only changed while the transmitter is empty.
+ **/
+static int32_t ciaaDriverUart_sendRs485Address(ciaaDevices_deviceType const * const device, uint8_t const address)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   int32_t ret = -1;
+
+   if((pUartControl->rs485mode != CIAADRVUART_RS485_NORMAL) && (pUartControl->txbusy == false))
+   {
+      while((Chip_UART_ReadLineStatus(uart) & UART_LSR_TEMT) == 0)
+      {
+         /* wait for the previous bytes */
+      }
+      Chip_UART_ConfigData(uart, UART_LCR_RS485_ADDRESS);
+      Chip_UART_SendByte(uart, address);
+      while((Chip_UART_ReadLineStatus(uart) & UART_LSR_TEMT) == 0)
+      {
+         /* wait for the address */
+      }
+      Chip_UART_ConfigData(uart, UART_LCR_RS485_DATA);
+      ret = 0;
+   }
+
+   return ret;
+}
+
+/** \brief computes the divisor and the fractional divider of a baud rate
+ **
+ ** Searches all the MULVAL and DIVADDVAL pairs for the nearest rate,
+ ** rate = clock * MULVAL / (16 * divisor * (MULVAL + DIVADDVAL)). With
+ ** the fractional divider active the divisor shall be 3 at least.
+ **
+ ** \param[out] divisor    value of DLM:DLL
+ ** \param[out] fdr        value of FDR
+ ** \return the rate achieved, 0 if none
+ **/
+static uint32_t ciaaDriverUart_calcBaud(uint32_t clock, uint32_t baud, uint32_t * divisor, uint32_t * fdr)
+{
+   uint32_t mulval;
+   uint32_t divaddval;
+   uint64_t den;
+   uint32_t dl;
+   uint32_t rate;
+   uint32_t error;
+   uint32_t bestError = 0xFFFFFFFF;
+   uint32_t ret = 0;
+
+   for(mulval = 1; mulval <= 15; mulval++)
+   {
+      for(divaddval = 0; divaddval < mulval; divaddval++)
+      {
+         /* nearest divisor of this pair */
+         den = (uint64_t)16 * baud * (mulval + divaddval);
+         dl = (uint32_t)(((uint64_t)clock * mulval + den / 2) / den);
+
+         if((dl >= ((divaddval == 0) ? 1 : 3)) && (dl <= 0xFFFF))
+         {
+            rate = (uint32_t)(((uint64_t)clock * mulval) / ((uint64_t)16 * dl * (mulval + divaddval)));
+            error = (rate > baud) ? (rate - baud) : (baud - rate);
+            if(error < bestError)
+            {
+               bestError = error;
+               *divisor = dl;
+               *fdr = (mulval << 4) | divaddval;
+               ret = rate;
+            }
+         }
+      }
+   }
+
+   return ret;
+}
+
+/** \brief sets the baud rate of a port with the fractional divider
+ **
+ ** The port is left untouched if the rate is out of tolerance.
+ **
+ ** \return the rate achieved, -1 if it is out of UART_BAUD_TOLERANCE
+ **/
+static int32_t ciaaDriverUart_setBaud(ciaaDevices_deviceType const * const device, uint32_t const baud)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t achieved = 0;
+   uint32_t divisor;
+   uint32_t fdr;
+   uint32_t error;
+   int32_t ret = -1;
+
+   if(baud != 0)
+   {
+      achieved = ciaaDriverUart_calcBaud(Chip_Clock_GetRate(pUartControl->clk), baud, &divisor, &fdr);
+   }
+
+   error = (achieved > baud) ? (achieved - baud) : (baud - achieved);
+   if((achieved != 0) && ((uint64_t)error * 1000 <= (uint64_t)baud * UART_BAUD_TOLERANCE))
+   {
+      /* abort an autobaud in progress */
+      Chip_UART_IntDisable(uart, UART_IER_ABEOINT | UART_IER_ABTOINT);
+      uart->ACR = UART_ACR_ABEOINT_CLR | UART_ACR_ABTOINT_CLR;
+      pUartControl->autobaud = false;
+
+      Chip_UART_EnableDivisorAccess(uart);
+      uart->DLL = divisor & 0xFF;
+      uart->DLM = (divisor >> 8) & 0xFF;
+      Chip_UART_DisableDivisorAccess(uart);
+      uart->FDR = fdr;
+
+      pUartControl->baudrate = achieved;
+      ret = (int32_t)achieved;
+   }
+
+   return ret;
+}
+
+/** \brief starts an autobaud
+ **
+ ** The autobaud only computes the integer divisor, the fractional divider
+ ** is disabled.
+ **/
+static int32_t ciaaDriverUart_startAutobaud(ciaaDevices_deviceType const * const device, uint32_t const mode)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   int32_t ret = -1;
+
+   if(mode <= CIAADRVUART_AUTOBAUD_MODE1)
+   {
+      Chip_UART_IntDisable(uart, UART_IER_ABEOINT | UART_IER_ABTOINT);
+      pUartControl->baudrate = 0;
+      pUartControl->autobaud = true;
+
+      uart->FDR = UART_FDR_DISABLED;
+      uart->ACR = UART_ACR_ABEOINT_CLR | UART_ACR_ABTOINT_CLR;
+      uart->ACR = UART_ACR_START | UART_ACR_AUTO_RESTART |
+         ((mode == CIAADRVUART_AUTOBAUD_MODE1) ? UART_ACR_MODE : 0);
+
+      Chip_UART_IntEnable(uart, UART_IER_ABEOINT | UART_IER_ABTOINT);
+      ret = 0;
+   }
+
+   return ret;
+}
+
+/** \brief completes an autobaud
+ **
+ ** At the end the rate is computed back from the divisor set by the UART,
+ ** a timeout only restarts the measure.
+ **/
+static void ciaaDriverUart_autobaudIRQHandler(ciaaDevices_deviceType const * const device)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint32_t iir = Chip_UART_ReadIntIDReg(uart);
+   uint32_t divisor;
+
+   if(iir & UART_IIR_ABEO_INT)
+   {
+      Chip_UART_IntDisable(uart, UART_IER_ABEOINT | UART_IER_ABTOINT);
+      uart->ACR = UART_ACR_ABEOINT_CLR | UART_ACR_ABTOINT_CLR;
+
+      Chip_UART_EnableDivisorAccess(uart);
+      divisor = (uart->DLL & 0xFF) | ((uart->DLM & 0xFF) << 8);
+      Chip_UART_DisableDivisorAccess(uart);
+
+      if(divisor != 0)
+      {
+         pUartControl->baudrate = Chip_Clock_GetRate(pUartControl->clk) / (16 * divisor);
+      }
+      pUartControl->autobaud = false;
+   }
+   else if(iir & UART_IIR_ABTO_INT)
+   {
+      uart->ACR |= UART_ACR_ABTOINT_CLR;
+   }
+}
+
+/** \brief handles the irq of a port
+ **
+ ** Shared by the irq handlers of all the ports.
+ **/
+static void ciaaDriverUart_IRQHandler(ciaaDevices_deviceType const * const device)
+{
+   LPC_USART_T * uart = (LPC_USART_T *)device->loLayer;
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+   uint8_t status = Chip_UART_ReadLineStatus(uart);
+
+   if(pUartControl->autobaud)
+   {
+      ciaaDriverUart_autobaudIRQHandler(device);
+   }
+
+   if(pUartControl->rxdma)
+   {
+      /* a character timeout also requests the dma, which usually empties
+       * the FIFO before the irq is served, so the received bytes are
+       * looked for on each irq */
+      ciaaDriverUart_rxDmaFlush(device);
+   }
+   else if(status & UART_LSR_RDR)
+   {
+      ciaaDriverUart_rxIRQHandler(device, status);
+   }
+   if((status & UART_LSR_THRE) && (Chip_UART_GetIntsEnabled(uart) & UART_IER_THREINT))
+   {
+#ifdef CIAADRVUART_DEFERRED_TASK
+      /* enabled again by the task if it writes more bytes */
+      Chip_UART_IntDisable(uart, UART_IER_THREINT);
+      ciaaDriverUart_defer(device, UART_DEFERRED_TX);
+#else
+      /* tx confirmation of the bytes of the last write */
+      ciaaDriverUart_txConfirmation(device, pUartControl->txcnt);
+
+      if(Chip_UART_ReadLineStatus(uart) & UART_LSR_THRE)
+      {  /* There is not more bytes to send, disable THRE irq */
+         Chip_UART_IntDisable(uart, UART_IER_THREINT);
+      }
+#endif
+   }
+}
+
+static void ciaaDriverUart_hwInit(void)
+{
+   ciaaDriverUartControl * pUartControl;
+   uint8_t loopi;
+   uint8_t loopj;
+
+   for(loopi = 0; loopi < UART_PORT_COUNT; loopi++)
+   {
+      pUartControl = &uartControl[loopi];
+
+      Chip_UART_Init(pUartControl->uart);
+      pUartControl->baudrate = Chip_UART_SetBaudFDR(pUartControl->uart, 115200);
+
+      Chip_UART_SetupFIFOS(pUartControl->uart, UART_FCR_FIFO_EN | UART_FCR_DMAMODE_SEL | UART_FCR_TRG_LEV0);
+
+      Chip_UART_TXEnable(pUartControl->uart);
+
+      for(loopj = 0; loopj < pUartControl->pinCount; loopj++)
+      {
+         Chip_SCU_PinMux(pUartControl->pins[loopj].port, pUartControl->pins[loopj].pin,
+               pUartControl->pins[loopj].mode, pUartControl->pins[loopj].func);
+      }
+
+      if(pUartControl->rs485 != 0)
+      {
+         Chip_UART_SetRS485Flags(pUartControl->uart, pUartControl->rs485);
+      }
+
+      pUartControl->txthreshold = UART_TX_DMA_THRESHOLD;
+   }
+
+   /* GPDMA controller, used to transmit */
+   ciaaDriverDma_init();
 }
 
 /*==================[external functions definition]==========================*/
 extern ciaaDevices_deviceType * ciaaDriverUart_open(char const * path, ciaaDevices_deviceType * device, uint8_t const oflag)
 {
    /* Restart FIFOS: set Enable, Reset content, set trigger level */
-   Chip_UART_SetupFIFOS((LPC_USART_T *)device->loLayer, UART_FCR_FIFO_EN | UART_FCR_TX_RS | UART_FCR_RX_RS | UART_FCR_TRG_LEV0);
+   Chip_UART_SetupFIFOS((LPC_USART_T *)device->loLayer, UART_FCR_FIFO_EN | UART_FCR_DMAMODE_SEL | UART_FCR_TX_RS | UART_FCR_RX_RS | UART_FCR_TRG_LEV0);
    /* dummy read */
    Chip_UART_ReadByte((LPC_USART_T *)device->loLayer);
    /* enable rx interrupt */
@@ -210,18 +1030,31 @@ extern ciaaDevices_deviceType * ciaaDriverUart_open(char const * path, ciaaDevic
 
 extern int32_t ciaaDriverUart_close(ciaaDevices_deviceType const * const device)
 {
+   ciaaDriverUartControl * pUartControl = (ciaaDriverUartControl *)device->layer;
+
    /* disable tx and rx interrupt */
    Chip_UART_IntDisable((LPC_USART_T *)device->loLayer, UART_IER_THREINT | UART_IER_RBRINT);
+
+   /* abort the dma transfers */
+   ciaaDriverUart_rxDmaStop(device);
+   Chip_UART_IntDisable((LPC_USART_T *)device->loLayer, UART_IER_RBRINT);
+   NVIC_DisableIRQ(DMA_IRQn);
+   if(pUartControl->txbusy)
+   {
+      Chip_GPDMA_Stop(LPC_GPDMA, pUartControl->tx_dma_channel);
+      pUartControl->txbusy = false;
+      ciaaDriverDma_giveLine(pUartControl->tx_dma_line, CIAADRVDMA_OWNER_UART);
+   }
+   NVIC_EnableIRQ(DMA_IRQn);
    return 0;
 }
 
 extern int32_t ciaaDriverUart_ioctl(ciaaDevices_deviceType const * const device, int32_t const request, void * param)
 {
+   ciaaDriverUartControl * pUartControl;
    int32_t ret = -1;
 
-   if((device == ciaaDriverUartConst.devices[0]) ||
-      (device == ciaaDriverUartConst.devices[1]) ||
-      (device == ciaaDriverUartConst.devices[2]) )
+   if(ciaaDriverUart_isDevice(device))
    {
       switch(request)
       {
@@ -229,18 +1062,22 @@ extern int32_t ciaaDriverUart_ioctl(ciaaDevices_deviceType const * const device,
             /* disable THRE irq (TX) */
             Chip_UART_IntDisable((LPC_USART_T *)device->loLayer, UART_IER_THREINT);
             /* this one calls write */
-            ciaaDriverUart_txConfirmation(device);
-            /* enable THRE irq (TX) */
-            Chip_UART_IntEnable((LPC_USART_T *)device->loLayer, UART_IER_THREINT);
+            ciaaDriverUart_txConfirmation(device, 1);
+            pUartControl = (ciaaDriverUartControl *)device->layer;
+            if(pUartControl->txbusy == false)
+            {
+               /* enable THRE irq (TX), dma transmissions are confirmed by the dma irq */
+               Chip_UART_IntEnable((LPC_USART_T *)device->loLayer, UART_IER_THREINT);
+            }
             ret = 0;
             break;
 
          case ciaaPOSIX_IOCTL_SET_BAUDRATE:
-            ret = Chip_UART_SetBaud((LPC_USART_T *)device->loLayer,  (int32_t)param);
+            ret = ciaaDriverUart_setBaud(device, (uint32_t)param);
             break;
 
          case ciaaPOSIX_IOCTL_SET_FIFO_TRIGGER_LEVEL:
-            Chip_UART_SetupFIFOS((LPC_USART_T *)device->loLayer,  UART_FCR_FIFO_EN | UART_FCR_TX_RS | UART_FCR_RX_RS | (int32_t)param);
+            Chip_UART_SetupFIFOS((LPC_USART_T *)device->loLayer,  UART_FCR_FIFO_EN | UART_FCR_DMAMODE_SEL | UART_FCR_TX_RS | UART_FCR_RX_RS | (int32_t)param);
             break;
 
          case ciaaPOSIX_IOCTL_SET_ENABLE_TX_INTERRUPT:
@@ -268,6 +1105,62 @@ extern int32_t ciaaDriverUart_ioctl(ciaaDevices_deviceType const * const device,
                Chip_UART_IntEnable((LPC_USART_T *)device->loLayer, UART_IER_RBRINT);
             }
             break;
+
+         case CIAADRVUART_IOCTL_SET_TX_DMA_THRESHOLD:
+            pUartControl = (ciaaDriverUartControl *)device->layer;
+            pUartControl->txthreshold = (uint32_t)param;
+            ret = 0;
+            break;
+
+         case CIAADRVUART_IOCTL_SET_RX_DMA:
+            pUartControl = (ciaaDriverUartControl *)device->layer;
+            if((bool)(intptr_t)param == false)
+            {
+               ciaaDriverUart_rxDmaStop(device);
+               ret = 0;
+            }
+            else if(pUartControl->rs485mode != CIAADRVUART_RS485_MULTIDROP)
+            {
+               ciaaDriverUart_rxDmaStop(device);
+               ret = ciaaDriverUart_rxDmaStart(device);
+            }
+            break;
+
+         case CIAADRVUART_IOCTL_SET_RS485:
+            ret = ciaaDriverUart_setRs485(device, (ciaaDriverUart_rs485Type const *)param);
+            break;
+
+         case CIAADRVUART_IOCTL_SEND_RS485_ADDRESS:
+            ret = ciaaDriverUart_sendRs485Address(device, (uint8_t)(intptr_t)param);
+            break;
+
+         case CIAADRVUART_IOCTL_GET_BAUDRATE:
+            pUartControl = (ciaaDriverUartControl *)device->layer;
+            *((uint32_t *)param) = pUartControl->baudrate;
+            ret = 0;
+            break;
+
+         case CIAADRVUART_IOCTL_START_AUTOBAUD:
+            ret = ciaaDriverUart_startAutobaud(device, (uint32_t)param);
+            break;
+
+         case CIAADRVUART_IOCTL_SET_RX_CRC:
+            pUartControl = (ciaaDriverUartControl *)device->layer;
+            pUartControl->rxcrc = (ciaaDriverCrc_contextType *)param;
+            ret = 0;
+            break;
+
+         case CIAADRVUART_IOCTL_SET_TX_CRC:
+            pUartControl = (ciaaDriverUartControl *)device->layer;
+            pUartControl->txcrc = (ciaaDriverCrc_contextType *)param;
+            ret = 0;
+            break;
+
+         case CIAADRVUART_IOCTL_GET_RX_OVERRUNS:
+            pUartControl = (ciaaDriverUartControl *)device->layer;
+            *((uint32_t *)param) = pUartControl->rxoverruns;
+            ret = 0;
+            break;
       }
    }
    return ret;
@@ -276,41 +1169,42 @@ extern int32_t ciaaDriverUart_ioctl(ciaaDevices_deviceType const * const device,
 extern int32_t ciaaDriverUart_read(ciaaDevices_deviceType const * const device, uint8_t* buffer, uint32_t size)
 {
    int32_t ret = -1;
-   uint8_t i;
+   uint32_t tail;
+   uint32_t count;
+   uint32_t base;
+   uint32_t remaining;
    ciaaDriverUartControl * pUartControl;
 
    if(size != 0)
    {
-      if((device == ciaaDriverUartConst.devices[0]) ||
-         (device == ciaaDriverUartConst.devices[1]) ||
-         (device == ciaaDriverUartConst.devices[2]) )
+      if(ciaaDriverUart_isDevice(device))
       {
          pUartControl = (ciaaDriverUartControl *)device->layer;
 
-         if(size > pUartControl->rxcnt)
-         {
-            /* buffer has enough space */
-            ret = pUartControl->rxcnt;
-            pUartControl->rxcnt = 0;
-         }
-         else
-         {
-            /* buffer hasn't enough space */
-            ret = size;
-            pUartControl->rxcnt -= size;
-         }
-         for(i = 0; i < ret; i++)
+         /* the dma does not wait for the reader, the bytes it overwrote
+          * are counted as overruns */
+         tail = pUartControl->rxtail;
+         count = ciaaDriverUart_ringGet(pUartControl->rxbuf, pUartControl->rxmask,
+               pUartControl->rxhead, &tail, buffer, size, &pUartControl->rxoverruns);
+
+         if((pUartControl->rxdma) && (count != 0))
          {
-            buffer[i] = pUartControl->hwbuf[i];
+            /* also the ones it overwrote during the copy */
+            base = ciaaDriverUart_rxDmaBlock(device, &remaining);
+            count = ciaaDriverUart_ringLapped(pUartControl->rxmask,
+                  base + (pUartControl->rxmask + 1) / UART_RX_DMA_BLOCKS - remaining,
+                  tail - count, buffer, count, &pUartControl->rxoverruns);
          }
-         if(pUartControl->rxcnt != 0)
+
+         if(pUartControl->rxcrc != NULL)
          {
-            /* We removed data from the buffer, it is time to reorder it */
-            for(i = 0; i < pUartControl->rxcnt ; i++)
-            {
-               pUartControl->hwbuf[i] = pUartControl->hwbuf[i + ret];
-            }
+            ciaaDriverCrc_update(pUartControl->rxcrc, buffer, count);
          }
+
+         /* the data shall be copied before its space is released */
+         __DMB();
+         pUartControl->rxtail = tail;
+         ret = count;
       }
    }
    return ret;
@@ -319,17 +1213,50 @@ extern int32_t ciaaDriverUart_read(ciaaDevices_deviceType const * const device,
 extern int32_t ciaaDriverUart_write(ciaaDevices_deviceType const * const device, uint8_t const * const buffer, uint32_t const size)
 {
    int32_t ret = 0;
+   ciaaDriverUartControl * pUartControl;
 
-   if((device == ciaaDriverUartConst.devices[0]) ||
-      (device == ciaaDriverUartConst.devices[1]) ||
-      (device == ciaaDriverUartConst.devices[2]) )
+   if(ciaaDriverUart_isDevice(device))
    {
-      while((Chip_UART_ReadLineStatus((LPC_USART_T *)device->loLayer) & UART_LSR_THRE) && (ret < size))
+      pUartControl = (ciaaDriverUartControl *)device->layer;
+
+      if(pUartControl->txbusy)
+      {
+         /* the dma transmission in progress will confirm */
+      }
+      else if((pUartControl->txthreshold != 0) && (size >= pUartControl->txthreshold) &&
+              (ciaaDriverDma_takeLine(pUartControl->tx_dma_line, CIAADRVDMA_OWNER_UART)))
+      {
+         /* the caller buffer may be reused, the data is copied */
+         ret = (size > UART_TX_BUFFER_SIZE) ? UART_TX_BUFFER_SIZE : size;
+         ciaaPOSIX_memcpy(pUartControl->txbuf, buffer, ret);
+         pUartControl->txcnt = ret;
+
+         /* no refill irq, the dma irq confirms the whole transmission */
+         Chip_UART_IntDisable((LPC_USART_T *)device->loLayer, UART_IER_THREINT);
+
+         NVIC_DisableIRQ(DMA_IRQn);
+         pUartControl->tx_dma_channel = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, pUartControl->tx_dma_conn);
+         Chip_GPDMA_Transfer(LPC_GPDMA, pUartControl->tx_dma_channel, (uint32_t)pUartControl->txbuf,
+               pUartControl->tx_dma_conn, GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, ret);
+         pUartControl->txbusy = true;
+         NVIC_EnableIRQ(DMA_IRQn);
+      }
+      else
+      {
+         /* also while another driver uses the DMAMUX line */
+         while((Chip_UART_ReadLineStatus((LPC_USART_T *)device->loLayer) & UART_LSR_THRE) && (ret < size))
+         {
+            /* send first byte */
+            Chip_UART_SendByte((LPC_USART_T *)device->loLayer, buffer[ret]);
+            /* bytes written */
+            ret++;
+         }
+         pUartControl->txcnt = ret;
+      }
+
+      if((pUartControl->txcrc != NULL) && (ret > 0))
       {
-         /* send first byte */
-         Chip_UART_SendByte((LPC_USART_T *)device->loLayer, buffer[ret]);
-         /* bytes written */
-         ret++;
+         ciaaDriverCrc_update(pUartControl->txcrc, buffer, ret);
       }
    }
    return ret;
@@ -349,87 +1276,90 @@ void ciaaDriverUart_init(void)
    }
 }
 
-/*==================[interrupt handlers]=====================================*/
-ISR(UART0_IRQHandler)
+/** \brief called from the GPDMA interrupt, see ciaaDriverDma_Internal.h */
+extern void ciaaDriverUart_dmaIRQHandler(void)
 {
-   uint8_t status = Chip_UART_ReadLineStatus(LPC_USART0);
-
-   if(status & UART_LSR_RDR)
-   {
-      do
-      {
-         uartControl[0].hwbuf[uartControl[0].rxcnt] = Chip_UART_ReadByte(LPC_USART0);
-         uartControl[0].rxcnt++;
-      }while((Chip_UART_ReadLineStatus(LPC_USART0) & UART_LSR_RDR) &&
-             (uartControl[0].rxcnt < UART_RX_FIFO_SIZE));
+   uint8_t loopi;
 
-      ciaaDriverUart_rxIndication(&ciaaDriverUart_device0, uartControl[0].rxcnt);
-   }
-   if((status & UART_LSR_THRE) && (Chip_UART_GetIntsEnabled(LPC_USART0) & UART_IER_THREINT))
+   for(loopi = 0; loopi < ciaaDriverUartConst.countOfDevices; loopi++)
    {
-      /* tx confirmation, 1 byte sent */
-      ciaaDriverUart_txConfirmation(&ciaaDriverUart_device0);
-
-      if(Chip_UART_ReadLineStatus(LPC_USART0) & UART_LSR_THRE)
-      {  /* There is not more bytes to send, disable THRE irq */
-         Chip_UART_IntDisable(LPC_USART0, UART_IER_THREINT);
-      }
+      ciaaDriverUart_txDmaIRQHandler(ciaaDriverUartConst.devices[loopi]);
+      ciaaDriverUart_rxDmaIRQHandler(ciaaDriverUartConst.devices[loopi]);
    }
 }
 
-ISR(UART2_IRQHandler)
+#ifdef CIAADRVUART_DEFERRED_TASK
+/** \brief called from the deferred task, see ciaaDriverUart_Deferred.h */
+extern void ciaaDriverUart_deferred(void)
 {
-   uint8_t status = Chip_UART_ReadLineStatus(LPC_USART2);
+   ciaaDevices_deviceType const * device;
+   ciaaDriverUartControl * pUartControl;
+   uint32_t primask;
+   uint32_t count;
+   uint8_t work;
+   uint8_t loopi;
 
-   if(status & UART_LSR_RDR)
+   for(loopi = 0; loopi < ciaaDriverUartConst.countOfDevices; loopi++)
    {
-      do
-      {
-         uartControl[1].hwbuf[uartControl[1].rxcnt] = Chip_UART_ReadByte(LPC_USART2);
-         uartControl[1].rxcnt++;
-      }while((Chip_UART_ReadLineStatus(LPC_USART2) & UART_LSR_RDR) &&
-             (uartControl[1].rxcnt < UART_RX_FIFO_SIZE));
+      device = ciaaDriverUartConst.devices[loopi];
+      pUartControl = (ciaaDriverUartControl *)device->layer;
 
-      ciaaDriverUart_rxIndication(&ciaaDriverUart_device1, uartControl[1].rxcnt);
-   }
-   if((status & UART_LSR_THRE) && (Chip_UART_GetIntsEnabled(LPC_USART2) & UART_IER_THREINT))
-   {
-      /* tx confirmation, 1 byte sent */
-      ciaaDriverUart_txConfirmation(&ciaaDriverUart_device1);
+      primask = __get_PRIMASK();
+      __disable_irq();
+      work = pUartControl->deferred;
+      pUartControl->deferred = 0;
+      __set_PRIMASK(primask);
 
-      if(Chip_UART_ReadLineStatus(LPC_USART2) & UART_LSR_THRE)
-      {  /* There is not more bytes to send, disable THRE irq */
-         Chip_UART_IntDisable(LPC_USART2, UART_IER_THREINT);
+      if(work & UART_DEFERRED_RX)
+      {
+         count = pUartControl->rxhead - pUartControl->rxtail;
+         ciaaSerialDevices_rxIndication(device->upLayer,
+               (count > pUartControl->rxmask + 1) ? (pUartControl->rxmask + 1) : count);
+      }
+      if(work & (UART_DEFERRED_TX | UART_DEFERRED_TXDMA))
+      {
+         count = pUartControl->txcnt;
+         pUartControl->txcnt = 0;
+
+         /* this one calls write */
+         ciaaDriverUart_txConfirmation(device, count);
+
+         /* as in the irqs: after a dma the FIFO may still hold bytes, else
+          * only when the write queued bytes. Dma transmissions are
+          * confirmed by the dma irq */
+         if((pUartControl->txbusy == false) &&
+            ((work & UART_DEFERRED_TXDMA) ||
+             ((Chip_UART_ReadLineStatus((LPC_USART_T *)device->loLayer) & UART_LSR_THRE) == 0)))
+         {
+            Chip_UART_IntEnable((LPC_USART_T *)device->loLayer, UART_IER_THREINT);
+         }
       }
    }
 }
+#endif
 
-ISR(UART3_IRQHandler)
+/*==================[interrupt handlers]=====================================*/
+ISR(UART0_IRQHandler)
 {
-   uint8_t status = Chip_UART_ReadLineStatus(LPC_USART3);
+   ciaaDriverUart_IRQHandler(&ciaaDriverUart_device0);
+}
 
-   if(status & UART_LSR_RDR)
-   {
-      do
-      {
-         uartControl[2].hwbuf[uartControl[2].rxcnt] = Chip_UART_ReadByte(LPC_USART3);
-         uartControl[2].rxcnt++;
-      }while((Chip_UART_ReadLineStatus(LPC_USART3) & UART_LSR_RDR) &&
-             (uartControl[2].rxcnt < UART_RX_FIFO_SIZE));
+ISR(UART2_IRQHandler)
+{
+   ciaaDriverUart_IRQHandler(&ciaaDriverUart_device1);
+}
 
-      ciaaDriverUart_rxIndication(&ciaaDriverUart_device2, uartControl[2].rxcnt);
-   }
-   if((status & UART_LSR_THRE) && (Chip_UART_GetIntsEnabled(LPC_USART3) & UART_IER_THREINT))
-   {
-      /* tx confirmation, 1 byte sent */
-      ciaaDriverUart_txConfirmation(&ciaaDriverUart_device2);
+ISR(UART3_IRQHandler)
+{
+   ciaaDriverUart_IRQHandler(&ciaaDriverUart_device2);
+}
 
-      if(Chip_UART_ReadLineStatus(LPC_USART3) & UART_LSR_THRE)
-      {  /* There is not more bytes to send, disable THRE irq */
-         Chip_UART_IntDisable(LPC_USART3, UART_IER_THREINT);
-      }
-   }
+#ifdef CIAADRVUART_ENABLE_UART1
+ISR(UART1_IRQHandler)
+{
+   ciaaDriverUart_IRQHandler(&ciaaDriverUart_device3);
 }
+#endif
 
 /** @} doxygen end group definition */
 /** @} doxygen end group definition */
@@ -0,0 +1,142 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERAIO_CONV_H_
+#define _CIAADRIVERAIO_CONV_H_
+/** \brief Sample format conversions of the AIO Drivers
+ **
+ ** Bulk conversions between the analog converters register formats, 16
+ ** bits integer samples and calibrated float samples.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup AIO AIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief max value of a 10 bits sample */
+#define CIAADRVAIO_CONV_MAX_10BITS     0x3FF
+
+/** \brief position of a 10 bits sample in the converter registers
+ **
+ ** The ADC data registers and the DAC register keep the sample in bits
+ ** 6 to 15.
+ **/
+#define CIAADRVAIO_CONV_REG_SHIFT      6
+
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/** \brief converts ADC data registers to 16 bits samples
+ **
+ ** \param[out] dst       samples, may be unaligned
+ ** \param[in] src        ADC data registers
+ ** \param[in] count      count of samples
+ **/
+extern void ciaaDriverAio_convRegToInt16(int16_t * dst, uint32_t const * src, uint32_t count);
+
+/** \brief converts packed 10 bits samples to 16 bits samples
+ **
+ ** Four samples are packed in five bytes, little endian, the first sample
+ ** in the lower bits.
+ **
+ ** \param[out] dst       samples
+ ** \param[in] src        packed samples
+ ** \param[in] count      count of samples, multiple of 4
+ **/
+extern void ciaaDriverAio_convPacked10ToInt16(int16_t * dst, uint8_t const * src, uint32_t count);
+
+/** \brief converts 16 bits samples to calibrated float samples
+ **
+ ** dst[i] = src[i] * gain + offset
+ **
+ ** \param[out] dst       calibrated samples
+ ** \param[in] src        samples
+ ** \param[in] count      count of samples
+ ** \param[in] gain       calibration gain
+ ** \param[in] offset     calibration offset
+ **/
+extern void ciaaDriverAio_convInt16ToFloat(float * dst, int16_t const * src, uint32_t count,
+      float gain, float offset);
+
+/** \brief converts 16 bits samples to the DAC register format
+ **
+ ** The samples are saturated to 10 bits, moved to their register position
+ ** and or'ed with flags, e.g. the bias bit.
+ **
+ ** \param[out] dst       register values
+ ** \param[in] src        samples, may be unaligned
+ ** \param[in] count      count of samples
+ ** \param[in] flags      bits set in each register value
+ **/
+extern void ciaaDriverAio_convInt16ToDac(uint32_t * dst, int16_t const * src, uint32_t count,
+      uint32_t flags);
+
+/** \brief converts float samples to the DAC register format
+ **
+ ** The samples are rounded, saturated to 10 bits, moved to their register
+ ** position and or'ed with flags.
+ **
+ ** \param[out] dst       register values
+ ** \param[in] src        samples in DAC counts
+ ** \param[in] count      count of samples
+ ** \param[in] flags      bits set in each register value
+ **/
+extern void ciaaDriverAio_convFloatToDac(uint32_t * dst, float const * src, uint32_t count,
+      uint32_t flags);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERAIO_CONV_H_ */
+
@@ -0,0 +1,119 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERAIO_FILTER_H_
+#define _CIAADRIVERAIO_FILTER_H_
+/** \brief Oversampling and filter stage of the AIO Drivers
+ **
+ ** Decimates the samples read from an analog input, optionally through a
+ ** FIR low pass filter. The samples are processed in place in the buffer
+ ** returned to the upper layer, while they are still in the cache.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup AIO AIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+#include "ciaaPOSIX_stdbool.h"
+#include "ciaaDriverAio_Ioctl.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief max count of FIR coefficients */
+#define CIAADRVAIO_FILTER_MAX_TAPS     32
+
+/*==================[typedef]================================================*/
+/** \brief state of the oversampling and filter stage */
+typedef struct {
+   bool enabled;                 /** <= samples are processed */
+   uint16_t oversampling;        /** <= input samples per output sample */
+   uint16_t count;               /** <= input samples since the last output */
+   uint8_t shift;                /** <= right shift of the accumulator */
+   uint8_t taps;                 /** <= count of coefficients */
+   uint8_t pos;                  /** <= oldest sample of the history */
+   int32_t acc;                  /** <= accumulator without coefficients */
+   int16_t coef[CIAADRVAIO_FILTER_MAX_TAPS];        /** <= reversed coefficients */
+   int16_t history[2 * CIAADRVAIO_FILTER_MAX_TAPS]; /** <= last input samples, twice */
+} ciaaDriverAio_filterType;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/** \brief configures the filter stage
+ **
+ ** \param[out] filter    filter state to be initialized
+ ** \param[in] config     configuration, NULL disables the stage
+ ** \return 0 on success, -1 if the configuration is invalid
+ **/
+extern int32_t ciaaDriverAio_filterInit(ciaaDriverAio_filterType * filter,
+      ciaaDriverAio_filterConfigType const * config);
+
+/** \brief processes samples in place
+ **
+ ** \param[inout] filter  filter state
+ ** \param[inout] samples input samples, replaced by the output samples
+ ** \param[in] count      count of input samples
+ ** \return count of output samples stored at the begin of samples
+ **/
+extern uint32_t ciaaDriverAio_filterProcess(ciaaDriverAio_filterType * filter,
+      int16_t * samples, uint32_t count);
+
+/** \brief position of the input sample completing the next output sample
+ **
+ ** \param[in] filter    filter state
+ ** \return index, in the next samples processed, of the input sample after
+ **         which the next output sample is generated, 0 if disabled
+ **/
+extern uint32_t ciaaDriverAio_filterNext(ciaaDriverAio_filterType const * filter);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERAIO_FILTER_H_ */
+
@@ -0,0 +1,255 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERAIO_IOCTL_H_
+#define _CIAADRIVERAIO_IOCTL_H_
+/** \brief Platform specific ioctl requests of the AIO Drivers
+ **
+ ** Requests and parameter types understood by the ciaaDriverAio_ioctl
+ ** function of the platforms supporting them, in addition to the generic
+ ** ciaaPOSIX_IOCTL_* requests.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup AIO AIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief first request number used by the AIO platform ioctls
+ **
+ ** The value is chosen far above the generic ciaaPOSIX_IOCTL_* requests
+ ** to avoid collisions.
+ **/
+#define CIAADRVAIO_IOCTL_BASE                   0x0100
+
+/** \brief set the DAC output mode
+ **
+ ** param: one of the CIAADRVAIO_DAC_MODE_* values. Changing the mode stops
+ ** any transfer in progress.
+ **/
+#define CIAADRVAIO_IOCTL_SET_DAC_MODE           (CIAADRVAIO_IOCTL_BASE + 0)
+
+/** \brief set the length in samples of the DAC stream buffer
+ **
+ ** param: count of samples, even and not bigger than the driver buffer. Used
+ ** in CIAADRVAIO_DAC_MODE_STREAM, each half of the buffer is refilled by
+ ** one or more writes.
+ **/
+#define CIAADRVAIO_IOCTL_SET_DAC_LENGTH         (CIAADRVAIO_IOCTL_BASE + 1)
+
+/** \brief get the count of DAC stream underruns
+ **
+ ** param: pointer to an uint32_t where the count is stored
+ **/
+#define CIAADRVAIO_IOCTL_GET_DAC_UNDERRUNS      (CIAADRVAIO_IOCTL_BASE + 2)
+
+/** \brief set how the ADC conversions are started
+ **
+ ** param: one of the CIAADRVAIO_ADC_TRIGGER_* values. In timer mode the
+ ** conversions are started by hardware at the rate set with
+ ** ciaaPOSIX_IOCTL_SET_SAMPLE_RATE and collected by DMA.
+ **/
+#define CIAADRVAIO_IOCTL_SET_ADC_TRIGGER        (CIAADRVAIO_IOCTL_BASE + 3)
+
+/** \brief set the length in samples of the ADC DMA buffer
+ **
+ ** param: count of samples, even and not bigger than the driver buffer. The
+ ** upper layer is notified each time half of the buffer is filled.
+ **/
+#define CIAADRVAIO_IOCTL_SET_ADC_LENGTH         (CIAADRVAIO_IOCTL_BASE + 4)
+
+/** \brief get the count of ADC DMA buffer overruns
+ **
+ ** param: pointer to an uint32_t where the count is stored
+ **/
+#define CIAADRVAIO_IOCTL_GET_ADC_OVERRUNS       (CIAADRVAIO_IOCTL_BASE + 5)
+
+/** \brief enable or disable the synchronized sampling of both ADCs
+ **
+ ** Only valid for aio/in/0. param: true to enable. When enabled both ADCs
+ ** are started by the same hardware trigger at the rate of aio/in/0 and
+ ** each read of aio/in/0 returns pairs of samples, first the one of ADC0
+ ** and then the one of ADC1, converted at the same time. The channel of
+ ** ADC1 is still selected through aio/in/1.
+ **/
+#define CIAADRVAIO_IOCTL_SET_ADC_PAIRED         (CIAADRVAIO_IOCTL_BASE + 6)
+
+/** \brief set the oversampling and filter stage of an analog input
+ **
+ ** param: pointer to a ciaaDriverAio_filterConfigType, NULL to disable the
+ ** stage. The samples returned by read are then the decimated ones. The
+ ** stage is not applied to the sample pairs of CIAADRVAIO_IOCTL_SET_ADC_PAIRED.
+ **/
+#define CIAADRVAIO_IOCTL_SET_FILTER             (CIAADRVAIO_IOCTL_BASE + 7)
+
+/** \brief enable or disable the block header of the read function
+ **
+ ** param: true to enable. When enabled each read returns a
+ ** ciaaDriverAio_headerType followed by the samples it describes, read
+ ** returns 0 if the buffer can not hold the header and one sample frame.
+ **/
+#define CIAADRVAIO_IOCTL_SET_HEADER             (CIAADRVAIO_IOCTL_BASE + 8)
+
+/** \brief set the window comparator of an analog input
+ **
+ ** param: pointer to a ciaaDriverAio_windowConfigType, NULL to disable it.
+ ** Only enabled in CIAADRVAIO_ADC_TRIGGER_TIMER mode, not in paired mode,
+ ** and disabled when leaving timer mode. While
+ ** enabled the samples are compared by the driver as they are collected
+ ** and read returns ciaaDriverAio_windowEventType records instead of
+ ** samples. The upper layer is only notified when the signal changes its
+ ** zone, the first sample always generates an event.
+ **/
+#define CIAADRVAIO_IOCTL_SET_WINDOW             (CIAADRVAIO_IOCTL_BASE + 9)
+
+/** \brief DAC mode: each write is output once (default) */
+#define CIAADRVAIO_DAC_MODE_ONESHOT             0
+/** \brief DAC mode: the last written waveform is repeated by the DMA
+ **
+ ** A write while a waveform is output is swapped in at the end of its
+ ** period if both fit in the driver buffer, else the output restarts with
+ ** the new one. Until the swap, confirmed with the size of the new
+ ** waveform, writes return 0.
+ **/
+#define CIAADRVAIO_DAC_MODE_CIRCULAR            1
+/** \brief DAC mode: double buffered continuous stream
+ **
+ ** Writes fill the half not being output, a write returns the bytes that
+ ** fit in it, 0 while both halves are waiting to be output. The output
+ ** starts once both halves are filled and each half output is confirmed.
+ **/
+#define CIAADRVAIO_DAC_MODE_STREAM              2
+
+/** \brief ADC trigger: each conversion is started by software (default) */
+#define CIAADRVAIO_ADC_TRIGGER_SOFTWARE         0
+/** \brief ADC trigger: conversions are started by a hardware timer */
+#define CIAADRVAIO_ADC_TRIGGER_TIMER            1
+
+/** \brief window zone: the signal is below the low threshold */
+#define CIAADRVAIO_WINDOW_BELOW                 0
+/** \brief window zone: the signal is between both thresholds */
+#define CIAADRVAIO_WINDOW_INSIDE                1
+/** \brief window zone: the signal is above the high threshold */
+#define CIAADRVAIO_WINDOW_ABOVE                 2
+
+/*==================[typedef]================================================*/
+/** \brief configuration of the oversampling and filter stage
+ **
+ ** Every oversampling input samples one output sample is generated. Without
+ ** coefficients the output is the sum of the last oversampling samples,
+ ** with coefficients it is the FIR filter output at that time. In both
+ ** cases the result is shifted right by shift bits, e.g. 16 summed 10 bits
+ ** samples are a 14 bits sample with shift 0, a FIR filter with Q15
+ ** coefficients has unity gain with shift 15.
+ **/
+typedef struct {
+   uint16_t oversampling;        /** <= input samples per output sample */
+   uint8_t shift;                /** <= right shift of the accumulator */
+   uint8_t taps;                 /** <= count of coefficients, 0 for none */
+   int16_t const * coef;         /** <= Q15 FIR coefficients */
+} ciaaDriverAio_filterConfigType;
+
+/** \brief header of a block of samples returned by read
+ **
+ ** The timestamp and the period use the same time base, frequency gives its
+ ** ticks per second. The sequence counts every sample converted since the
+ ** conversions were started, including the dropped ones, so a gap between
+ ** the sequence of a block and the end of the previous one is the count of
+ ** lost samples. In paired mode a sample is a pair of samples.
+ **
+ ** If the filter stage is enabled the first sample of the block is the
+ ** first output sample. Its timestamp and sequence are the ones of the input
+ ** sample after which it was generated, the last one of its oversampling
+ ** input samples, so the samples carried over from the previous block are
+ ** accounted for. The sequence still counts input samples, consecutive
+ ** blocks are oversampling input samples apart per output sample, and the
+ ** period is the one of the output samples.
+ **/
+typedef struct {
+   uint64_t timestamp;           /** <= capture time of the first sample */
+   uint32_t frequency;           /** <= ticks per second of the time base */
+   uint32_t period;              /** <= sample period in ticks, 0 if unknown */
+   uint32_t sequence;            /** <= sequence number of the first sample */
+   uint32_t size;                /** <= bytes of samples after the header */
+} ciaaDriverAio_headerType;
+
+/** \brief configuration of the window comparator
+ **
+ ** The signal enters the upper or lower zone when it crosses high or low,
+ ** it only returns to the inside zone after moving back hysteresis counts.
+ **/
+typedef struct {
+   uint16_t low;                 /** <= low threshold */
+   uint16_t high;                /** <= high threshold, not less than low */
+   uint16_t hysteresis;          /** <= counts needed to leave a zone */
+} ciaaDriverAio_windowConfigType;
+
+/** \brief window comparator event
+ **
+ ** The timestamp and the sequence have the same meaning as in
+ ** ciaaDriverAio_headerType.
+ **/
+typedef struct {
+   uint64_t timestamp;           /** <= capture time of the sample */
+   uint32_t sequence;            /** <= sequence number of the sample */
+   uint16_t sample;              /** <= sample entering the zone */
+   uint8_t zone;                 /** <= CIAADRVAIO_WINDOW_* entered */
+} ciaaDriverAio_windowEventType;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERAIO_IOCTL_H_ */
+
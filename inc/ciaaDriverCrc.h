@@ -0,0 +1,131 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERCRC_H_
+#define _CIAADRIVERCRC_H_
+/** \brief CRC Driver
+ **
+ ** CRC over buffers or streams of bytes. The LPC43xx use their CRC engine,
+ ** the other platforms a slicing-by-8 table implementation with the same
+ ** results.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup CRC CRC Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief CRC-16/MODBUS: poly 0x8005 reflected, init 0xFFFF */
+#define CIAADRVCRC_16_MODBUS     0
+
+/** \brief CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF */
+#define CIAADRVCRC_16_CCITT      1
+
+/** \brief CRC-32: poly 0x04C11DB7 reflected, init and final xor 0xFFFFFFFF */
+#define CIAADRVCRC_32            2
+
+/** \brief count of CRC types */
+#define CIAADRVCRC_TYPES         3
+
+/*==================[typedef]================================================*/
+/** \brief CRC in progress
+ **
+ ** The state is kept in the format of the implementation and shall only be
+ ** used through the functions of this driver.
+ **/
+typedef struct {
+   uint32_t state;         /** <= CRC register */
+   uint8_t type;           /** <= one of CIAADRVCRC_* */
+} ciaaDriverCrc_contextType;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/** \brief starts a CRC
+ **
+ ** \param[out] context   CRC to start
+ ** \param[in] type       one of CIAADRVCRC_*
+ **/
+extern void ciaaDriverCrc_start(ciaaDriverCrc_contextType * context, uint8_t type);
+
+/** \brief adds bytes to a CRC
+ **
+ ** May be called from tasks and irqs, on the LPC43xx the engine is used
+ ** with the irqs disabled.
+ **
+ ** \param[inout] context CRC in progress
+ ** \param[in] data       bytes, may be unaligned
+ ** \param[in] size       count of bytes
+ **/
+extern void ciaaDriverCrc_update(ciaaDriverCrc_contextType * context, uint8_t const * data, uint32_t size);
+
+/** \brief returns the CRC of the bytes added so far
+ **
+ ** The context is not modified and more bytes may be added.
+ **
+ ** \param[in] context    CRC in progress
+ ** \return the CRC, 16 bits CRCs in the lower bits
+ **/
+extern uint32_t ciaaDriverCrc_finish(ciaaDriverCrc_contextType const * context);
+
+/** \brief computes the CRC of a buffer
+ **
+ ** \param[in] type       one of CIAADRVCRC_*
+ ** \param[in] data       bytes, may be unaligned
+ ** \param[in] size       count of bytes
+ ** \return the CRC, 16 bits CRCs in the lower bits
+ **/
+extern uint32_t ciaaDriverCrc_compute(uint8_t type, uint8_t const * data, uint32_t size);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERCRC_H_ */
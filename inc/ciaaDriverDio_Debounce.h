@@ -0,0 +1,127 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERDIO_DEBOUNCE_H_
+#define _CIAADRIVERDIO_DEBOUNCE_H_
+/** \brief Debounce of the DIO inputs
+ **
+ ** Filters the inputs of a DIO driver so only steady values are reported.
+ ** Each input may use an integrator, stepped by a periodic sample, or a
+ ** time window, which also follows the changes seen by the pin interrupts.
+ ** The state is not protected, the driver serializes the calls.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup DIO DIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+#include "ciaaPOSIX_stdbool.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief count of inputs of a debounce state */
+#define CIAADRVDIO_DEBOUNCE_INPUTS        8
+
+/*==================[typedef]================================================*/
+/** \brief debounce of up to 8 inputs */
+typedef struct {
+   uint8_t raw;            /** <= inputs at the last sample */
+   uint8_t stable;         /** <= debounced inputs */
+   uint8_t integrator;     /** <= inputs filtered by an integrator */
+   uint8_t window;         /** <= inputs filtered by a time window */
+   uint16_t count[CIAADRVDIO_DEBOUNCE_INPUTS];  /** <= integrator value */
+   uint16_t limit[CIAADRVDIO_DEBOUNCE_INPUTS];  /** <= integrator top */
+   uint64_t changed[CIAADRVDIO_DEBOUNCE_INPUTS]; /** <= time of the last
+                                                        change of the input */
+   uint64_t length[CIAADRVDIO_DEBOUNCE_INPUTS]; /** <= window length */
+} ciaaDriverDio_debounceStateType;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/** \brief starts a debounce state without filtered inputs
+ **
+ ** \param[out] state     debounce state
+ ** \param[in] raw        current inputs
+ **/
+extern void ciaaDriverDio_debounceInit(ciaaDriverDio_debounceStateType * state, uint8_t raw);
+
+/** \brief sets the filter of some inputs
+ **
+ ** The inputs keep their debounced value, the filter starts steady at it.
+ **
+ ** \param[inout] state   debounce state
+ ** \param[in] inputs     mask of the inputs
+ ** \param[in] mode       one of CIAADRVDIO_DEBOUNCE_*
+ ** \param[in] count      integrator: samples to reach a new value
+ ** \param[in] length     window: time the input shall be steady, in the
+ **                       units of the time given to the samples
+ ** \param[in] now        current time
+ **/
+extern void ciaaDriverDio_debounceConfig(ciaaDriverDio_debounceStateType * state,
+      uint8_t inputs, uint8_t mode, uint16_t count, uint64_t length, uint64_t now);
+
+/** \brief samples the inputs
+ **
+ ** Every call follows the changes for the time windows, only the periodic
+ ** ones step the integrators.
+ **
+ ** \param[inout] state   debounce state
+ ** \param[in] raw        current inputs
+ ** \param[in] now        current time
+ ** \param[in] periodic   the call is the periodic sample
+ ** \return the debounced inputs, the inputs without filter as they are
+ **/
+extern uint8_t ciaaDriverDio_debounceSample(ciaaDriverDio_debounceStateType * state,
+      uint8_t raw, uint64_t now, bool periodic);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERDIO_DEBOUNCE_H_ */
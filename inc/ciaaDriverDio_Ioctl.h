@@ -0,0 +1,217 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERDIO_IOCTL_H_
+#define _CIAADRIVERDIO_IOCTL_H_
+/** \brief Platform specific ioctl requests of the DIO Drivers
+ **
+ ** Requests and parameter types understood by the ciaaDriverDio_ioctl
+ ** function of the platforms supporting them.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup DIO DIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief first request number used by the DIO platform ioctls
+ **
+ ** The value is chosen far above the generic ciaaPOSIX_IOCTL_* requests
+ ** and apart from the ones of the other drivers.
+ **/
+#define CIAADRVDIO_IOCTL_BASE                   0x0300
+
+/** \brief enable or disable the input change events
+ **
+ ** param: true to enable. While enabled each change of the inputs is
+ ** queued with its time and the new value of the inputs, and read returns
+ ** whole ciaaDriverDio_eventType records instead of the current value, 0
+ ** bytes when the queue is empty. Enabling it discards the queued events.
+ **/
+#define CIAADRVDIO_IOCTL_SET_EVENTS             (CIAADRVDIO_IOCTL_BASE + 0)
+
+/** \brief set outputs
+ **
+ ** The outputs of the mask are set and the others kept, without a read,
+ ** modify and write of the whole byte by the caller. Safe against other
+ ** tasks changing other outputs of the same device.
+ **
+ ** param: mask of the outputs, bit 0 is output 0
+ **/
+#define CIAADRVDIO_IOCTL_SET_BITS               (CIAADRVDIO_IOCTL_BASE + 1)
+
+/** \brief clear outputs, see CIAADRVDIO_IOCTL_SET_BITS
+ **
+ ** param: mask of the outputs
+ **/
+#define CIAADRVDIO_IOCTL_CLEAR_BITS             (CIAADRVDIO_IOCTL_BASE + 2)
+
+/** \brief toggle outputs, see CIAADRVDIO_IOCTL_SET_BITS
+ **
+ ** param: mask of the outputs
+ **/
+#define CIAADRVDIO_IOCTL_TOGGLE_BITS            (CIAADRVDIO_IOCTL_BASE + 3)
+
+/** \brief write the outputs of a mask, see CIAADRVDIO_IOCTL_SET_BITS
+ **
+ ** param: pointer to a ciaaDriverDio_maskedType, the ioctl fails if NULL
+ **/
+#define CIAADRVDIO_IOCTL_WRITE_MASKED           (CIAADRVDIO_IOCTL_BASE + 4)
+
+/** \brief start or stop a capture of the inputs
+ **
+ ** The inputs are sampled at a fixed rate into a buffer of the driver
+ ** without cpu load, starting when the inputs of the trigger mask reach
+ ** the trigger value. While a capture is set up read returns 0 bytes
+ ** until it is complete, then one byte per sample, oldest first. The
+ ** CIAADRVDIO_EVENTS_TASK is signalled when it completes. Only available
+ ** when the platform provides it. On lpc4337 it fails while UART1 uses
+ ** its DMA request lines, and UART1 transfers without DMA while a capture
+ ** is set up.
+ **
+ ** param: pointer to a ciaaDriverDio_captureType, rate is updated to the
+ **        rate achieved, or NULL to stop and go back to plain reads
+ **/
+#define CIAADRVDIO_IOCTL_START_CAPTURE          (CIAADRVDIO_IOCTL_BASE + 5)
+
+/** \brief drive outputs with a PWM signal
+ **
+ ** The outputs of the mask are driven by the hardware with a shared
+ ** frequency and a duty cycle each, the others go back to the value last
+ ** written, which write and the bit requests keep updating but do not
+ ** drive while the PWM does. Only the outputs the platform provides it
+ ** for are valid. Calling it again with the same frequency changes the
+ ** duty cycles at the end of the current period. Outputs driven from an
+ ** interrupt limit the frequency, a few kHz on lpc4337.
+ **
+ ** param: pointer to a ciaaDriverDio_pwmType, frequency is updated to the
+ **        frequency achieved, or NULL to stop the PWM of all the outputs
+ **/
+#define CIAADRVDIO_IOCTL_SET_PWM                (CIAADRVDIO_IOCTL_BASE + 6)
+
+/** \brief count of duty cycles of a ciaaDriverDio_pwmType */
+#define CIAADRVDIO_PWM_CHANNELS                 (8)
+
+/** \brief duty cycle of an output always on */
+#define CIAADRVDIO_PWM_DUTY_MAX                 (1000)
+
+/** \brief filter the inputs
+ **
+ ** The inputs of the mask only report a new value to read and to the
+ ** change events once it is steady. The inputs are sampled periodically
+ ** by the driver, the period is shared by all of them and the last one
+ ** set is used.
+ **
+ ** param: pointer to a ciaaDriverDio_debounceType
+ **/
+#define CIAADRVDIO_IOCTL_SET_DEBOUNCE           (CIAADRVDIO_IOCTL_BASE + 7)
+
+/** \brief no filter, the inputs are reported as they are */
+#define CIAADRVDIO_DEBOUNCE_NONE                0
+
+/** \brief integrator: counts up on each sample of the input high and down
+ ** on each sample low, the input changes when the count reaches an end */
+#define CIAADRVDIO_DEBOUNCE_INTEGRATOR          1
+
+/** \brief time window: the input changes when it was steady for the time
+ ** of the window, its changes are also followed between samples */
+#define CIAADRVDIO_DEBOUNCE_WINDOW              2
+
+/*==================[typedef]================================================*/
+/** \brief input change event, see CIAADRVDIO_IOCTL_SET_EVENTS */
+typedef struct {
+   uint64_t timestamp;     /** <= time of the change in ticks of the
+                                  platform time base */
+   uint32_t sequence;      /** <= count of events since enabled, a gap
+                                  tells that events were lost */
+   uint8_t value;          /** <= inputs after the change */
+   uint8_t changed;        /** <= inputs changed */
+} ciaaDriverDio_eventType;
+
+/** \brief masked write, see CIAADRVDIO_IOCTL_WRITE_MASKED */
+typedef struct {
+   uint8_t value;          /** <= new value of the outputs */
+   uint8_t mask;           /** <= outputs written, the others are kept */
+} ciaaDriverDio_maskedType;
+
+/** \brief capture of the inputs, see CIAADRVDIO_IOCTL_START_CAPTURE */
+typedef struct {
+   uint32_t rate;          /** <= samples per second */
+   uint32_t samples;       /** <= count of samples */
+   uint8_t mask;           /** <= inputs of the trigger, 0 starts at once */
+   uint8_t value;          /** <= value of those inputs which starts */
+} ciaaDriverDio_captureType;
+
+/** \brief PWM of the outputs, see CIAADRVDIO_IOCTL_SET_PWM */
+typedef struct {
+   uint32_t frequency;     /** <= periods per second */
+   uint8_t outputs;        /** <= outputs driven by the PWM */
+   uint16_t duty[CIAADRVDIO_PWM_CHANNELS]; /** <= duty cycle of each output
+                                  from 0 to CIAADRVDIO_PWM_DUTY_MAX */
+} ciaaDriverDio_pwmType;
+
+/** \brief filter of inputs, see CIAADRVDIO_IOCTL_SET_DEBOUNCE */
+typedef struct {
+   uint8_t inputs;         /** <= inputs filtered */
+   uint8_t mode;           /** <= one of CIAADRVDIO_DEBOUNCE_* */
+   uint16_t count;         /** <= integrator: samples to change */
+   uint32_t window;        /** <= time window in microseconds */
+   uint32_t period;        /** <= sampling period in microseconds */
+} ciaaDriverDio_debounceType;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERDIO_IOCTL_H_ */
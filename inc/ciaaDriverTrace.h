@@ -0,0 +1,152 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERTRACE_H_
+#define _CIAADRIVERTRACE_H_
+/** \brief Trace recorder of the DIO and AIO Drivers
+ **
+ ** When CIAADRVTRACE_SIZE is defined in the makefile the drivers record
+ ** each write of the outputs, each change of the inputs and each analog
+ ** sample in a ring in RAM, overwriting the oldest records. The ring is
+ ** taken as is by ciaaDriverTrace_copy or dumped by a debugger from the
+ ** symbol ciaaDriverTrace_ring, and tools/ciaaTrace2Vcd converts it to a
+ ** VCD file. Without CIAADRVTRACE_SIZE the recording compiles to nothing.
+ **
+ ** Records are reserved with an atomic increment, so tasks and irqs may
+ ** record concurrently. The ring is copied without locking, a record
+ ** written during the copy may be torn.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup Trace Trace recorder
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief written to magic of the ring */
+#define CIAADRVTRACE_MAGIC       0x45435254
+
+/** \brief version of the format */
+#define CIAADRVTRACE_VERSION     1
+
+/** \brief sources of the records */
+#define CIAADRVTRACE_DIO_IN      0     /** <= dio in/0, 8 bits */
+#define CIAADRVTRACE_DIO_OUT     1     /** <= dio out/0, 8 bits */
+#define CIAADRVTRACE_AIO_IN0     2     /** <= aio in/0, 16 bits */
+#define CIAADRVTRACE_AIO_IN1     3     /** <= aio in/1, 16 bits */
+#define CIAADRVTRACE_SOURCES     4
+
+#ifdef CIAADRVTRACE_SIZE
+#if ((CIAADRVTRACE_SIZE & (CIAADRVTRACE_SIZE - 1)) != 0)
+#error CIAADRVTRACE_SIZE shall be a power of two
+#endif
+#else
+/* recording disabled */
+#define ciaaDriverTrace_init(frequency)                  do { } while(0)
+#define ciaaDriverTrace_record(source, value, timestamp) do { } while(0)
+#endif
+
+/*==================[typedef]================================================*/
+/** \brief record of the ring, 8 bytes
+ **
+ ** The time keeps the lower 40 bits of the time base of the driver, the
+ ** converter unwraps it.
+ **/
+typedef struct {
+   uint32_t time;          /** <= bits 0 to 31 of the time */
+   uint8_t timeHigh;       /** <= bits 32 to 39 of the time */
+   uint8_t source;         /** <= one of CIAADRVTRACE_* */
+   uint16_t value;         /** <= value after the change */
+} ciaaDriverTrace_recordType;
+
+/** \brief header of the ring, followed by size records */
+typedef struct {
+   uint32_t magic;         /** <= CIAADRVTRACE_MAGIC */
+   uint32_t version;       /** <= CIAADRVTRACE_VERSION */
+   uint32_t frequency;     /** <= ticks per second of the time */
+   uint32_t size;          /** <= count of records of the ring */
+   uint32_t head;          /** <= count of records written, the next one
+                                  goes to head % size */
+} ciaaDriverTrace_headerType;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+#ifdef CIAADRVTRACE_SIZE
+/** \brief starts the ring if it is not yet
+ **
+ ** May be called by each driver recording.
+ **
+ ** \param[in] frequency  ticks per second of the timestamps
+ **/
+extern void ciaaDriverTrace_init(uint32_t frequency);
+
+/** \brief records a value
+ **
+ ** \param[in] source     one of CIAADRVTRACE_*
+ ** \param[in] value      value after the change
+ ** \param[in] timestamp  time of the change
+ **/
+extern void ciaaDriverTrace_record(uint8_t source, uint16_t value, uint64_t timestamp);
+#endif
+
+/** \brief copies the ring
+ **
+ ** \param[out] buffer    header followed by the records
+ ** \param[in] size       size of buffer in bytes
+ ** \return bytes copied, 0 if recording is disabled or buffer is too small
+ **         for the whole ring
+ **/
+extern uint32_t ciaaDriverTrace_copy(uint8_t * buffer, uint32_t size);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERTRACE_H_ */
@@ -0,0 +1,210 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERUART_IOCTL_H_
+#define _CIAADRIVERUART_IOCTL_H_
+/** \brief Platform specific ioctl requests of the UART Drivers
+ **
+ ** Requests and parameter types understood by the ciaaDriverUart_ioctl
+ ** function of the platforms supporting them, in addition to the generic
+ ** ciaaPOSIX_IOCTL_* requests.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup UART UART Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief first request number used by the UART platform ioctls
+ **
+ ** The value is chosen far above the generic ciaaPOSIX_IOCTL_* requests
+ ** and apart from the ones of the other drivers.
+ **/
+#define CIAADRVUART_IOCTL_BASE                  0x0200
+
+/** \brief get the count of received bytes lost
+ **
+ ** Counts the bytes lost because the receive buffer of the driver was full
+ ** and the hardware FIFO overruns.
+ **
+ ** param: pointer to an uint32_t where the count is stored
+ **/
+#define CIAADRVUART_IOCTL_GET_RX_OVERRUNS       (CIAADRVUART_IOCTL_BASE + 0)
+
+/** \brief set the min size of the writes transmitted by DMA
+ **
+ ** Writes of at least this size are copied to a driver buffer and sent by
+ ** DMA, the upper layer gets a single transmit confirmation with the count
+ ** of bytes sent. Smaller writes are written to the hardware FIFO, as are
+ ** all writes while another driver uses the DMA request line of the port
+ ** (on lpc4337 the inputs capture of the DIO driver and UART1).
+ **
+ ** param: size in bytes, 0 to never use the DMA
+ **/
+#define CIAADRVUART_IOCTL_SET_TX_DMA_THRESHOLD  (CIAADRVUART_IOCTL_BASE + 1)
+
+/** \brief enable or disable the DMA receive mode
+ **
+ ** param: true to enable. In DMA mode the received bytes are moved to the
+ ** receive buffer of the driver by DMA and the upper layer is notified
+ ** when a part of the buffer is filled and at the end of each burst,
+ ** detected by the character timeout of the UART. Enabling it discards
+ ** the bytes not read yet. Bytes overwritten before they are read are
+ ** counted as overruns. Enabling it fails while another driver uses the
+ ** DMA request line of the port, which keeps receiving without DMA.
+ **/
+#define CIAADRVUART_IOCTL_SET_RX_DMA            (CIAADRVUART_IOCTL_BASE + 2)
+
+/** \brief set the RS485 mode of a port
+ **
+ ** Only available in the ports wired to a RS485 transceiver. In the
+ ** multidrop modes the 9th bit of each character tells address bytes
+ ** (1) from data bytes (0). Only the bytes after a matching address byte,
+ ** this one included, reach the receive buffer, the rest of the bus
+ ** traffic is discarded by the UART.
+ **
+ ** param: pointer to a ciaaDriverUart_rs485Type
+ **/
+#define CIAADRVUART_IOCTL_SET_RS485             (CIAADRVUART_IOCTL_BASE + 3)
+
+/** \brief transmit an address byte in a RS485 multidrop mode
+ **
+ ** Waits until the previous bytes are sent and transmits the address with
+ ** the 9th bit set, the following writes are data bytes. Fails while a
+ ** DMA transmission is in progress.
+ **
+ ** param: the address, 0 to 255
+ **/
+#define CIAADRVUART_IOCTL_SEND_RS485_ADDRESS    (CIAADRVUART_IOCTL_BASE + 4)
+
+/** \brief add the received bytes to a CRC
+ **
+ ** Each byte read from the port is added to the CRC before read returns,
+ ** in both receive modes. The CRC shall be started with
+ ** ciaaDriverCrc_start and is read with ciaaDriverCrc_finish.
+ **
+ ** param: pointer to a ciaaDriverCrc_contextType, NULL to stop
+ **/
+#define CIAADRVUART_IOCTL_SET_RX_CRC            (CIAADRVUART_IOCTL_BASE + 5)
+
+/** \brief add the transmitted bytes to a CRC
+ **
+ ** Each byte accepted by write is added to the CRC, see
+ ** CIAADRVUART_IOCTL_SET_RX_CRC.
+ **
+ ** param: pointer to a ciaaDriverCrc_contextType, NULL to stop
+ **/
+#define CIAADRVUART_IOCTL_SET_TX_CRC            (CIAADRVUART_IOCTL_BASE + 6)
+
+/** \brief get the baud rate achieved
+ **
+ ** ciaaPOSIX_IOCTL_SET_BAUDRATE uses the fractional divider and returns
+ ** the rate achieved, or -1 when it differs from the requested one more
+ ** than the tolerance of the driver; the rate of the port is then left
+ ** unchanged.
+ **
+ ** param: pointer to an uint32_t where the rate is stored, 0 while an
+ ** autobaud is in progress
+ **/
+#define CIAADRVUART_IOCTL_GET_BAUDRATE          (CIAADRVUART_IOCTL_BASE + 7)
+
+/** \brief start an autobaud
+ **
+ ** The UART measures the start bit of the next 'A' or 'a' received and sets
+ ** its baud rate, the measure restarts after each timeout. The result is
+ ** read with CIAADRVUART_IOCTL_GET_BAUDRATE.
+ **
+ ** param: CIAADRVUART_AUTOBAUD_MODE0 or CIAADRVUART_AUTOBAUD_MODE1
+ **/
+#define CIAADRVUART_IOCTL_START_AUTOBAUD        (CIAADRVUART_IOCTL_BASE + 8)
+
+/** \brief autobaud mode 0: measures the start bit and the LSB */
+#define CIAADRVUART_AUTOBAUD_MODE0              0
+
+/** \brief autobaud mode 1: measures the start bit only */
+#define CIAADRVUART_AUTOBAUD_MODE1              1
+
+/** \brief RS485 mode: 8 bits characters, every byte is received */
+#define CIAADRVUART_RS485_NORMAL                0
+
+/** \brief RS485 mode: normal multidrop
+ **
+ ** The driver compares each address byte with the own address and enables
+ ** or disables the receiver, data bytes are discarded by the UART while
+ ** the receiver is disabled. Not available in DMA receive mode.
+ **/
+#define CIAADRVUART_RS485_MULTIDROP             1
+
+/** \brief RS485 mode: auto address detection
+ **
+ ** The UART compares the address bytes with the own address and enables or
+ ** disables its receiver without CPU intervention.
+ **/
+#define CIAADRVUART_RS485_AUTO_ADDRESS          2
+
+/*==================[typedef]================================================*/
+/** \brief RS485 configuration, see CIAADRVUART_IOCTL_SET_RS485 */
+typedef struct {
+   uint8_t mode;           /** <= one of CIAADRVUART_RS485_* */
+   uint8_t address;        /** <= own address in the multidrop modes */
+   uint8_t delay;          /** <= bit times the direction pin is kept
+                                  after the last stop bit */
+} ciaaDriverUart_rs485Type;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERUART_IOCTL_H_ */
+
@@ -0,0 +1,142 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERUART_RING_H_
+#define _CIAADRIVERUART_RING_H_
+/** \brief Receive ring of the UART Drivers
+ **
+ ** A ring of a power of two size with free running indexes: the count of
+ ** bytes in the ring is head - tail and the position in the buffer is the
+ ** index masked with size - 1. The irq or the dma is the only writer of
+ ** head and read the only writer of tail, the driver stores the indexes
+ ** back with the barriers its platform needs.
+ **
+ ** The dma does not wait for the reader, so head may run ahead of tail
+ ** by more than the size of the ring, the overwritten bytes are counted
+ ** as overruns by ciaaDriverUart_ringGet.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup UART UART Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+#include "ciaaPOSIX_stdbool.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/** \brief stores a byte if the ring is not full
+ **
+ ** \param[inout] ring   buffer of the ring
+ ** \param[in] mask      size of the ring - 1
+ ** \param[inout] head   head index, advanced if the byte is stored
+ ** \param[in] tail      tail index
+ ** \param[in] data      byte to store
+ ** \return true if stored, false if the ring is full
+ **/
+extern bool ciaaDriverUart_ringPut(uint8_t * ring, uint32_t mask, uint32_t * head,
+      uint32_t tail, uint8_t data);
+
+/** \brief copies bytes out of the ring
+ **
+ ** \param[in] ring      buffer of the ring
+ ** \param[in] mask      size of the ring - 1
+ ** \param[in] head      head index
+ ** \param[inout] tail   tail index, advanced past the bytes copied and the
+ **                      ones overwritten
+ ** \param[out] buffer   destination
+ ** \param[in] size      size of buffer
+ ** \param[inout] overruns incremented by the count of bytes overwritten
+ ** \return count of bytes copied
+ **/
+extern uint32_t ciaaDriverUart_ringGet(uint8_t const * ring, uint32_t mask, uint32_t head,
+      uint32_t * tail, uint8_t * buffer, uint32_t size, uint32_t * overruns);
+
+/** \brief drops the bytes copied out of a ring which a writer not waiting
+ ** for the reader, like the dma, overwrote during the copy
+ **
+ ** The writer runs in order, so they are the first ones of the copy. The
+ ** others are moved to the start of the buffer.
+ **
+ ** \param[in] mask      size of the ring - 1
+ ** \param[in] position  index next written by the writer after the copy
+ ** \param[in] start     index of the first byte copied
+ ** \param[inout] buffer bytes copied
+ ** \param[in] count     count of bytes copied
+ ** \param[inout] overruns incremented by the count of bytes dropped
+ ** \return count of bytes left in buffer
+ **/
+extern uint32_t ciaaDriverUart_ringLapped(uint32_t mask, uint32_t position, uint32_t start,
+      uint8_t * buffer, uint32_t count, uint32_t * overruns);
+
+/** \brief gets the head of a ring filled by dma
+ **
+ ** The position of the dma is the start of the block being filled plus
+ ** the transfers already done in it. When a block was completed but its
+ ** irq is still pending the position seems to go back, then the head is
+ ** kept.
+ **
+ ** \param[in] head      head index
+ ** \param[in] base      index of the start of the block being filled
+ ** \param[in] block     size of a dma block
+ ** \param[in] remaining transfers left in the block
+ ** \return the new head index
+ **/
+extern uint32_t ciaaDriverUart_ringDmaHead(uint32_t head, uint32_t base, uint32_t block,
+      uint32_t remaining);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERUART_RING_H_ */
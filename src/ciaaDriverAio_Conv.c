@@ -0,0 +1,340 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Sample format conversions of the AIO Drivers
+ **
+ ** The bulk loops use the DSP and FPU instructions of the Cortex-M4 and
+ ** SSE2/AVX2 on x86 when the compiler provides them, and plain C otherwise.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup AIO AIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverAio_Conv.h"
+#include "ciaaPOSIX_string.h"
+
+#if defined(__ARM_FEATURE_DSP)
+#include "chip.h"
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/** \brief extracts the 10 bits sample of a converter register */
+static inline int16_t ciaaDriverAio_regSample(uint32_t reg)
+{
+   return (int16_t) ((reg >> CIAADRVAIO_CONV_REG_SHIFT) & CIAADRVAIO_CONV_MAX_10BITS);
+}
+
+/** \brief saturates a sample to 10 bits and moves it to its register position */
+static inline uint32_t ciaaDriverAio_dacReg(int32_t sample, uint32_t flags)
+{
+#if defined(__ARM_FEATURE_DSP)
+   uint32_t ret = __USAT(sample, 10);
+#else
+   uint32_t ret = (sample < 0) ? 0 :
+      ((sample > CIAADRVAIO_CONV_MAX_10BITS) ? CIAADRVAIO_CONV_MAX_10BITS : (uint32_t) sample);
+#endif
+
+   return (ret << CIAADRVAIO_CONV_REG_SHIFT) | flags;
+}
+
+/** \brief rounds a float sample to the nearest integer */
+static inline int32_t ciaaDriverAio_round(float sample)
+{
+   /* samples out of the int32_t range saturate anyway */
+   if (sample > 65535.0f)
+   {
+      sample = 65535.0f;
+   }
+   else if (sample < -65536.0f)
+   {
+      sample = -65536.0f;
+   }
+
+   return (int32_t) ((sample < 0.0f) ? (sample - 0.5f) : (sample + 0.5f));
+}
+
+#if defined(__SSE2__)
+/** \brief saturates four 32 bits lanes to 10 bits and moves them to their
+ ** register position */
+static inline __m128i ciaaDriverAio_dacReg4(__m128i sample, __m128i flags)
+{
+   /* packing to 16 bits saturates, min/max do the rest */
+   sample = _mm_packs_epi32(sample, sample);
+   sample = _mm_max_epi16(sample, _mm_setzero_si128());
+   sample = _mm_min_epi16(sample, _mm_set1_epi16(CIAADRVAIO_CONV_MAX_10BITS));
+   sample = _mm_unpacklo_epi16(sample, _mm_setzero_si128());
+
+   return _mm_or_si128(_mm_slli_epi32(sample, CIAADRVAIO_CONV_REG_SHIFT), flags);
+}
+#endif
+
+/*==================[external functions definition]==========================*/
+extern void ciaaDriverAio_convRegToInt16(int16_t * dst, uint32_t const * src, uint32_t count)
+{
+   uint32_t i = 0;
+
+#if defined(__ARM_FEATURE_DSP)
+   uint32_t pair;
+
+   for(; (i + 2) <= count; i += 2)
+   {
+      /* two samples per store, the destination may be unaligned and the
+       * copy is left to the compiler as a single str */
+      pair = (uint32_t) ciaaDriverAio_regSample(src[i]) |
+             ((uint32_t) ciaaDriverAio_regSample(src[i + 1]) << 16);
+      ciaaPOSIX_memcpy(&dst[i], &pair, sizeof(pair));
+   }
+#elif defined(__SSE2__)
+   __m128i mask = _mm_set1_epi32(CIAADRVAIO_CONV_MAX_10BITS);
+   __m128i lo;
+   __m128i hi;
+
+   for(; (i + 8) <= count; i += 8)
+   {
+      lo = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((__m128i const *) &src[i]),
+               CIAADRVAIO_CONV_REG_SHIFT), mask);
+      hi = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((__m128i const *) &src[i + 4]),
+               CIAADRVAIO_CONV_REG_SHIFT), mask);
+      _mm_storeu_si128((__m128i *) &dst[i], _mm_packs_epi32(lo, hi));
+   }
+#endif
+
+   for(; i < count; i++)
+   {
+      dst[i] = ciaaDriverAio_regSample(src[i]);
+   }
+}
+
+extern void ciaaDriverAio_convPacked10ToInt16(int16_t * dst, uint8_t const * src, uint32_t count)
+{
+   uint32_t i = 0;
+   uint32_t lo;
+   uint8_t hi;
+
+#if defined(__ARM_FEATURE_DSP)
+   uint32_t pair;
+#elif defined(__SSE2__)
+   __m128i mask = _mm_set1_epi64x(CIAADRVAIO_CONV_MAX_10BITS);
+   __m128i val;
+   __m128i out;
+
+   /* a group per 64 bits lane, the four samples are moved to the four
+    * 16 bits words of the lane. Each load reads 8 bytes for the 5 of a
+    * group, so the last groups are left to the scalar loop */
+   for(; (i + 12) <= count; i += 8)
+   {
+      val = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i const *) src),
+            _mm_loadl_epi64((__m128i const *) &src[5]));
+      out = _mm_and_si128(val, mask);
+      out = _mm_or_si128(out, _mm_slli_epi64(_mm_and_si128(_mm_srli_epi64(val, 10), mask), 16));
+      out = _mm_or_si128(out, _mm_slli_epi64(_mm_and_si128(_mm_srli_epi64(val, 20), mask), 32));
+      out = _mm_or_si128(out, _mm_slli_epi64(_mm_and_si128(_mm_srli_epi64(val, 30), mask), 48));
+      _mm_storeu_si128((__m128i *) &dst[i], out);
+
+      src += 10;
+   }
+#endif
+
+   /* the groups are not aligned to a word, the bytes are read one by one
+    * and the shifts are left to the barrel shifter */
+   for(; (i + 4) <= count; i += 4)
+   {
+      lo = (uint32_t) src[0] | ((uint32_t) src[1] << 8) |
+           ((uint32_t) src[2] << 16) | ((uint32_t) src[3] << 24);
+      hi = src[4];
+
+#if defined(__ARM_FEATURE_DSP)
+      /* two samples per store as in ciaaDriverAio_convRegToInt16 */
+      pair = (lo & CIAADRVAIO_CONV_MAX_10BITS) |
+             (((lo >> 10) & CIAADRVAIO_CONV_MAX_10BITS) << 16);
+      ciaaPOSIX_memcpy(&dst[i], &pair, sizeof(pair));
+      pair = ((lo >> 20) & CIAADRVAIO_CONV_MAX_10BITS) |
+             (((lo >> 30) | ((uint32_t) hi << 2)) << 16);
+      ciaaPOSIX_memcpy(&dst[i + 2], &pair, sizeof(pair));
+#else
+      dst[i] = (int16_t) (lo & CIAADRVAIO_CONV_MAX_10BITS);
+      dst[i + 1] = (int16_t) ((lo >> 10) & CIAADRVAIO_CONV_MAX_10BITS);
+      dst[i + 2] = (int16_t) ((lo >> 20) & CIAADRVAIO_CONV_MAX_10BITS);
+      dst[i + 3] = (int16_t) ((lo >> 30) | ((uint32_t) hi << 2));
+#endif
+
+      src += 5;
+   }
+}
+
+extern void ciaaDriverAio_convInt16ToFloat(float * dst, int16_t const * src, uint32_t count,
+      float gain, float offset)
+{
+   uint32_t i = 0;
+
+#if defined(__AVX2__)
+   __m256 gain8 = _mm256_set1_ps(gain);
+   __m256 offset8 = _mm256_set1_ps(offset);
+   __m256 val;
+
+   for(; (i + 8) <= count; i += 8)
+   {
+      val = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const *) &src[i])));
+      _mm256_storeu_ps(&dst[i], _mm256_add_ps(_mm256_mul_ps(val, gain8), offset8));
+   }
+#endif
+#if defined(__SSE2__)
+   __m128 gain4 = _mm_set1_ps(gain);
+   __m128 offset4 = _mm_set1_ps(offset);
+   __m128i raw;
+
+   for(; (i + 4) <= count; i += 4)
+   {
+      /* sign extend by placing the samples in the upper halves */
+      raw = _mm_loadl_epi64((__m128i const *) &src[i]);
+      raw = _mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16);
+      _mm_storeu_ps(&dst[i], _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(raw), gain4), offset4));
+   }
+#elif defined(__ARM_FP)
+   /* no vector unit on the M4, unroll to hide the FPU latency */
+   for(; (i + 4) <= count; i += 4)
+   {
+      dst[i] = (float) src[i] * gain + offset;
+      dst[i + 1] = (float) src[i + 1] * gain + offset;
+      dst[i + 2] = (float) src[i + 2] * gain + offset;
+      dst[i + 3] = (float) src[i + 3] * gain + offset;
+   }
+#endif
+
+   for(; i < count; i++)
+   {
+      dst[i] = (float) src[i] * gain + offset;
+   }
+}
+
+extern void ciaaDriverAio_convInt16ToDac(uint32_t * dst, int16_t const * src, uint32_t count,
+      uint32_t flags)
+{
+   uint32_t i = 0;
+
+#if defined(__AVX2__)
+   __m256i flags8 = _mm256_set1_epi32((int32_t) flags);
+   __m256i val;
+
+   for(; (i + 8) <= count; i += 8)
+   {
+      val = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const *) &src[i]));
+      val = _mm256_max_epi32(val, _mm256_setzero_si256());
+      val = _mm256_min_epi32(val, _mm256_set1_epi32(CIAADRVAIO_CONV_MAX_10BITS));
+      _mm256_storeu_si256((__m256i *) &dst[i],
+            _mm256_or_si256(_mm256_slli_epi32(val, CIAADRVAIO_CONV_REG_SHIFT), flags8));
+   }
+#endif
+#if defined(__SSE2__)
+   __m128i flags4 = _mm_set1_epi32((int32_t) flags);
+   __m128i raw;
+
+   for(; (i + 8) <= count; i += 8)
+   {
+      raw = _mm_loadu_si128((__m128i const *) &src[i]);
+      raw = _mm_max_epi16(raw, _mm_setzero_si128());
+      raw = _mm_min_epi16(raw, _mm_set1_epi16(CIAADRVAIO_CONV_MAX_10BITS));
+      _mm_storeu_si128((__m128i *) &dst[i], _mm_or_si128(_mm_slli_epi32(
+                  _mm_unpacklo_epi16(raw, _mm_setzero_si128()), CIAADRVAIO_CONV_REG_SHIFT), flags4));
+      _mm_storeu_si128((__m128i *) &dst[i + 4], _mm_or_si128(_mm_slli_epi32(
+                  _mm_unpackhi_epi16(raw, _mm_setzero_si128()), CIAADRVAIO_CONV_REG_SHIFT), flags4));
+   }
+#elif defined(__ARM_FEATURE_DSP)
+   for(; (i + 2) <= count; i += 2)
+   {
+      dst[i] = ciaaDriverAio_dacReg(src[i], flags);
+      dst[i + 1] = ciaaDriverAio_dacReg(src[i + 1], flags);
+   }
+#endif
+
+   for(; i < count; i++)
+   {
+      dst[i] = ciaaDriverAio_dacReg(src[i], flags);
+   }
+}
+
+extern void ciaaDriverAio_convFloatToDac(uint32_t * dst, float const * src, uint32_t count,
+      uint32_t flags)
+{
+   uint32_t i = 0;
+
+#if defined(__SSE2__)
+   __m128i flags4 = _mm_set1_epi32((int32_t) flags);
+   __m128 sign = _mm_set1_ps(-0.0f);
+   __m128 val;
+
+   for(; (i + 4) <= count; i += 4)
+   {
+      /* same rounding as the scalar tail: clamp, add +-0.5 and truncate */
+      val = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i]), _mm_set1_ps(-65536.0f)),
+            _mm_set1_ps(65535.0f));
+      val = _mm_add_ps(val, _mm_or_ps(_mm_and_ps(val, sign), _mm_set1_ps(0.5f)));
+      _mm_storeu_si128((__m128i *) &dst[i],
+            ciaaDriverAio_dacReg4(_mm_cvttps_epi32(val), flags4));
+   }
+#endif
+
+   for(; i < count; i++)
+   {
+      dst[i] = ciaaDriverAio_dacReg(ciaaDriverAio_round(src[i]), flags);
+   }
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+
@@ -0,0 +1,308 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Oversampling and filter stage of the AIO Drivers
+ **
+ ** Implements the decimation and FIR filter of the analog inputs. The inner
+ ** loops use the DSP instructions of the Cortex-M4 and SSE2/AVX2 on x86
+ ** when the compiler provides them, and plain C otherwise.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup AIO AIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverAio_Filter.h"
+#include "ciaaPOSIX_stdlib.h"
+
+#if defined(__ARM_FEATURE_DSP)
+#include "chip.h"
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+#if defined(__ARM_FEATURE_DSP)
+/** \brief loads two consecutive samples, the address may be unaligned */
+static inline uint32_t ciaaDriverAio_pair(int16_t const * p)
+{
+   return (uint32_t)(uint16_t)p[0] | ((uint32_t)(uint16_t)p[1] << 16);
+}
+
+/** \brief dual 16 bits multiply with 32 bits accumulate */
+static inline int32_t ciaaDriverAio_smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+   return (int32_t) __SMLAD(x, y, (uint32_t) acc);
+}
+#elif defined(__SSE2__)
+/** \brief adds the four 32 bits lanes of a vector */
+static inline int32_t ciaaDriverAio_hadd(__m128i acc)
+{
+   acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+   acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+
+   return _mm_cvtsi128_si32(acc);
+}
+#endif
+
+/** \brief dot product of two vectors of 16 bits samples */
+static int32_t ciaaDriverAio_dot(int16_t const * a, int16_t const * b, uint32_t n)
+{
+   int32_t ret = 0;
+   uint32_t i = 0;
+
+#if defined(__ARM_FEATURE_DSP)
+   for(; (i + 4) <= n; i += 4)
+   {
+      ret = ciaaDriverAio_smlad(ciaaDriverAio_pair(&a[i]), ciaaDriverAio_pair(&b[i]), ret);
+      ret = ciaaDriverAio_smlad(ciaaDriverAio_pair(&a[i + 2]), ciaaDriverAio_pair(&b[i + 2]), ret);
+   }
+#elif defined(__SSE2__)
+   __m128i acc = _mm_setzero_si128();
+#if defined(__AVX2__)
+   __m256i acc256 = _mm256_setzero_si256();
+
+   for(; (i + 16) <= n; i += 16)
+   {
+      acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(
+               _mm256_loadu_si256((__m256i const *) &a[i]),
+               _mm256_loadu_si256((__m256i const *) &b[i])));
+   }
+   acc = _mm_add_epi32(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+#endif
+   for(; (i + 8) <= n; i += 8)
+   {
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(
+               _mm_loadu_si128((__m128i const *) &a[i]),
+               _mm_loadu_si128((__m128i const *) &b[i])));
+   }
+   ret = ciaaDriverAio_hadd(acc);
+#endif
+
+   for(; i < n; i++)
+   {
+      ret += (int32_t) a[i] * b[i];
+   }
+
+   return ret;
+}
+
+/** \brief sum of a vector of 16 bits samples */
+static int32_t ciaaDriverAio_sum(int16_t const * a, uint32_t n)
+{
+   int32_t ret = 0;
+   uint32_t i = 0;
+
+#if defined(__ARM_FEATURE_DSP)
+   for(; (i + 4) <= n; i += 4)
+   {
+      ret = ciaaDriverAio_smlad(ciaaDriverAio_pair(&a[i]), 0x00010001, ret);
+      ret = ciaaDriverAio_smlad(ciaaDriverAio_pair(&a[i + 2]), 0x00010001, ret);
+   }
+#elif defined(__SSE2__)
+   __m128i acc = _mm_setzero_si128();
+   __m128i ones = _mm_set1_epi16(1);
+
+   for(; (i + 8) <= n; i += 8)
+   {
+      acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((__m128i const *) &a[i]), ones));
+   }
+   ret = ciaaDriverAio_hadd(acc);
+#endif
+
+   for(; i < n; i++)
+   {
+      ret += a[i];
+   }
+
+   return ret;
+}
+
+/** \brief shifts the accumulator and saturates it to 16 bits */
+static int16_t ciaaDriverAio_output(ciaaDriverAio_filterType const * filter, int32_t acc)
+{
+   acc >>= filter->shift;
+   if (acc > INT16_MAX)
+   {
+      acc = INT16_MAX;
+   }
+   else if (acc < INT16_MIN)
+   {
+      acc = INT16_MIN;
+   }
+
+   return (int16_t) acc;
+}
+
+/*==================[external functions definition]==========================*/
+extern int32_t ciaaDriverAio_filterInit(ciaaDriverAio_filterType * filter,
+      ciaaDriverAio_filterConfigType const * config)
+{
+   int32_t ret = -1;
+   uint8_t taps;
+   uint8_t i;
+
+   if (config == NULL)
+   {
+      filter->enabled = false;
+      ret = 0;
+   }
+   else if ((config->oversampling != 0) &&
+            (config->shift < 32) &&
+            (config->taps <= CIAADRVAIO_FILTER_MAX_TAPS) &&
+            ((config->taps == 0) || (config->coef != NULL)))
+   {
+      /* use an even count of taps, padded with a zero for the oldest sample */
+      taps = (config->taps + 1) & ~1;
+
+      filter->oversampling = config->oversampling;
+      filter->count = 0;
+      filter->shift = config->shift;
+      filter->taps = taps;
+      filter->pos = 0;
+      filter->acc = 0;
+      for(i = 0; i < taps; i++)
+      {
+         /* coef[0] weights the oldest sample of the history */
+         filter->coef[taps - 1 - i] = (i < config->taps) ? config->coef[i] : 0;
+         filter->history[i] = 0;
+         filter->history[i + taps] = 0;
+      }
+      filter->enabled = (config->oversampling > 1) || (taps > 0);
+      ret = 0;
+   }
+
+   return ret;
+}
+
+extern uint32_t ciaaDriverAio_filterProcess(ciaaDriverAio_filterType * filter,
+      int16_t * samples, uint32_t count)
+{
+   uint32_t in = 0;
+   uint32_t out = 0;
+   uint32_t run;
+
+   if (filter->enabled == false)
+   {
+      out = count;
+   }
+   else if (filter->taps == 0)
+   {
+      /* accumulate and dump */
+      while (in < count)
+      {
+         run = filter->oversampling - filter->count;
+         if (run > (count - in))
+         {
+            run = count - in;
+         }
+         filter->acc += ciaaDriverAio_sum(&samples[in], run);
+         filter->count += run;
+         in += run;
+
+         if (filter->count == filter->oversampling)
+         {
+            samples[out] = ciaaDriverAio_output(filter, filter->acc);
+            out++;
+            filter->acc = 0;
+            filter->count = 0;
+         }
+      }
+   }
+   else
+   {
+      /* FIR filter, only evaluated for the samples kept after decimation */
+      for(in = 0; in < count; in++)
+      {
+         /* each sample is stored twice, so the last taps samples are
+          * always contiguous from pos on */
+         filter->history[filter->pos] = samples[in];
+         filter->history[filter->pos + filter->taps] = samples[in];
+         filter->pos++;
+         if (filter->pos == filter->taps)
+         {
+            filter->pos = 0;
+         }
+
+         filter->count++;
+         if (filter->count == filter->oversampling)
+         {
+            samples[out] = ciaaDriverAio_output(filter,
+                  ciaaDriverAio_dot(filter->coef, &(filter->history[filter->pos]), filter->taps));
+            out++;
+            filter->count = 0;
+         }
+      }
+   }
+
+   return out;
+}
+
+extern uint32_t ciaaDriverAio_filterNext(ciaaDriverAio_filterType const * filter)
+{
+   uint32_t ret = 0;
+
+   if (filter->enabled)
+   {
+      /* count input samples are already in the accumulator or history */
+      ret = filter->oversampling - 1 - filter->count;
+   }
+
+   return ret;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+
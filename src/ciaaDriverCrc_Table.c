@@ -0,0 +1,370 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief CRC Driver, table implementation
+ **
+ ** Used on the platforms without CRC engine. A constant table of 256
+ ** entries per CRC type consumes a byte per step. On x86 seven more tables
+ ** per type let each step consume 8 bytes, they take 21 KB and are only
+ ** built there, once for all the types.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup CRC CRC Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverCrc.h"
+#include "ciaaPlatforms.h"
+#include "ciaaPOSIX_stdbool.h"
+
+#if !( ( ARCH == cortexM4 ) && ( CPUTYPE == lpc43xx ) )
+
+#if ( ARCH == x86 )
+#include <pthread.h>
+#endif
+
+/*==================[macros and definitions]=================================*/
+/** \brief parameters of a CRC type
+ **
+ ** The values are given in the format of the register: reflected CRCs are
+ ** computed LSB first, the others MSB first with the register left aligned
+ ** in 32 bits.
+ **/
+typedef struct {
+   uint32_t poly;          /** <= polynomial */
+   uint32_t init;          /** <= initial value of the register */
+   uint32_t xorout;        /** <= final xor */
+   uint8_t width;          /** <= bits of the CRC */
+   bool reflected;         /** <= LSB first */
+} ciaaDriverCrc_paramType;
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief parameters, indexed by CIAADRVCRC_* */
+static ciaaDriverCrc_paramType const ciaaDriverCrc_param[CIAADRVCRC_TYPES] = {
+   { 0x0000A001, 0x0000FFFF, 0x00000000, 16, true },     /* CIAADRVCRC_16_MODBUS */
+   { 0x10210000, 0xFFFF0000, 0x00000000, 16, false },    /* CIAADRVCRC_16_CCITT */
+   { 0xEDB88320, 0xFFFFFFFF, 0xFFFFFFFF, 32, true }      /* CIAADRVCRC_32 */
+};
+
+/** \brief tables, table[n] is the CRC of byte n, generated with the
+ ** parameters above */
+static uint32_t const ciaaDriverCrc_table[CIAADRVCRC_TYPES][256] = {
+   {  /* CIAADRVCRC_16_MODBUS */
+      0x00000000, 0x0000C0C1, 0x0000C181, 0x00000140, 0x0000C301, 0x000003C0,
+      0x00000280, 0x0000C241, 0x0000C601, 0x000006C0, 0x00000780, 0x0000C741,
+      0x00000500, 0x0000C5C1, 0x0000C481, 0x00000440, 0x0000CC01, 0x00000CC0,
+      0x00000D80, 0x0000CD41, 0x00000F00, 0x0000CFC1, 0x0000CE81, 0x00000E40,
+      0x00000A00, 0x0000CAC1, 0x0000CB81, 0x00000B40, 0x0000C901, 0x000009C0,
+      0x00000880, 0x0000C841, 0x0000D801, 0x000018C0, 0x00001980, 0x0000D941,
+      0x00001B00, 0x0000DBC1, 0x0000DA81, 0x00001A40, 0x00001E00, 0x0000DEC1,
+      0x0000DF81, 0x00001F40, 0x0000DD01, 0x00001DC0, 0x00001C80, 0x0000DC41,
+      0x00001400, 0x0000D4C1, 0x0000D581, 0x00001540, 0x0000D701, 0x000017C0,
+      0x00001680, 0x0000D641, 0x0000D201, 0x000012C0, 0x00001380, 0x0000D341,
+      0x00001100, 0x0000D1C1, 0x0000D081, 0x00001040, 0x0000F001, 0x000030C0,
+      0x00003180, 0x0000F141, 0x00003300, 0x0000F3C1, 0x0000F281, 0x00003240,
+      0x00003600, 0x0000F6C1, 0x0000F781, 0x00003740, 0x0000F501, 0x000035C0,
+      0x00003480, 0x0000F441, 0x00003C00, 0x0000FCC1, 0x0000FD81, 0x00003D40,
+      0x0000FF01, 0x00003FC0, 0x00003E80, 0x0000FE41, 0x0000FA01, 0x00003AC0,
+      0x00003B80, 0x0000FB41, 0x00003900, 0x0000F9C1, 0x0000F881, 0x00003840,
+      0x00002800, 0x0000E8C1, 0x0000E981, 0x00002940, 0x0000EB01, 0x00002BC0,
+      0x00002A80, 0x0000EA41, 0x0000EE01, 0x00002EC0, 0x00002F80, 0x0000EF41,
+      0x00002D00, 0x0000EDC1, 0x0000EC81, 0x00002C40, 0x0000E401, 0x000024C0,
+      0x00002580, 0x0000E541, 0x00002700, 0x0000E7C1, 0x0000E681, 0x00002640,
+      0x00002200, 0x0000E2C1, 0x0000E381, 0x00002340, 0x0000E101, 0x000021C0,
+      0x00002080, 0x0000E041, 0x0000A001, 0x000060C0, 0x00006180, 0x0000A141,
+      0x00006300, 0x0000A3C1, 0x0000A281, 0x00006240, 0x00006600, 0x0000A6C1,
+      0x0000A781, 0x00006740, 0x0000A501, 0x000065C0, 0x00006480, 0x0000A441,
+      0x00006C00, 0x0000ACC1, 0x0000AD81, 0x00006D40, 0x0000AF01, 0x00006FC0,
+      0x00006E80, 0x0000AE41, 0x0000AA01, 0x00006AC0, 0x00006B80, 0x0000AB41,
+      0x00006900, 0x0000A9C1, 0x0000A881, 0x00006840, 0x00007800, 0x0000B8C1,
+      0x0000B981, 0x00007940, 0x0000BB01, 0x00007BC0, 0x00007A80, 0x0000BA41,
+      0x0000BE01, 0x00007EC0, 0x00007F80, 0x0000BF41, 0x00007D00, 0x0000BDC1,
+      0x0000BC81, 0x00007C40, 0x0000B401, 0x000074C0, 0x00007580, 0x0000B541,
+      0x00007700, 0x0000B7C1, 0x0000B681, 0x00007640, 0x00007200, 0x0000B2C1,
+      0x0000B381, 0x00007340, 0x0000B101, 0x000071C0, 0x00007080, 0x0000B041,
+      0x00005000, 0x000090C1, 0x00009181, 0x00005140, 0x00009301, 0x000053C0,
+      0x00005280, 0x00009241, 0x00009601, 0x000056C0, 0x00005780, 0x00009741,
+      0x00005500, 0x000095C1, 0x00009481, 0x00005440, 0x00009C01, 0x00005CC0,
+      0x00005D80, 0x00009D41, 0x00005F00, 0x00009FC1, 0x00009E81, 0x00005E40,
+      0x00005A00, 0x00009AC1, 0x00009B81, 0x00005B40, 0x00009901, 0x000059C0,
+      0x00005880, 0x00009841, 0x00008801, 0x000048C0, 0x00004980, 0x00008941,
+      0x00004B00, 0x00008BC1, 0x00008A81, 0x00004A40, 0x00004E00, 0x00008EC1,
+      0x00008F81, 0x00004F40, 0x00008D01, 0x00004DC0, 0x00004C80, 0x00008C41,
+      0x00004400, 0x000084C1, 0x00008581, 0x00004540, 0x00008701, 0x000047C0,
+      0x00004680, 0x00008641, 0x00008201, 0x000042C0, 0x00004380, 0x00008341,
+      0x00004100, 0x000081C1, 0x00008081, 0x00004040
+   },
+   {  /* CIAADRVCRC_16_CCITT */
+      0x00000000, 0x10210000, 0x20420000, 0x30630000, 0x40840000, 0x50A50000,
+      0x60C60000, 0x70E70000, 0x81080000, 0x91290000, 0xA14A0000, 0xB16B0000,
+      0xC18C0000, 0xD1AD0000, 0xE1CE0000, 0xF1EF0000, 0x12310000, 0x02100000,
+      0x32730000, 0x22520000, 0x52B50000, 0x42940000, 0x72F70000, 0x62D60000,
+      0x93390000, 0x83180000, 0xB37B0000, 0xA35A0000, 0xD3BD0000, 0xC39C0000,
+      0xF3FF0000, 0xE3DE0000, 0x24620000, 0x34430000, 0x04200000, 0x14010000,
+      0x64E60000, 0x74C70000, 0x44A40000, 0x54850000, 0xA56A0000, 0xB54B0000,
+      0x85280000, 0x95090000, 0xE5EE0000, 0xF5CF0000, 0xC5AC0000, 0xD58D0000,
+      0x36530000, 0x26720000, 0x16110000, 0x06300000, 0x76D70000, 0x66F60000,
+      0x56950000, 0x46B40000, 0xB75B0000, 0xA77A0000, 0x97190000, 0x87380000,
+      0xF7DF0000, 0xE7FE0000, 0xD79D0000, 0xC7BC0000, 0x48C40000, 0x58E50000,
+      0x68860000, 0x78A70000, 0x08400000, 0x18610000, 0x28020000, 0x38230000,
+      0xC9CC0000, 0xD9ED0000, 0xE98E0000, 0xF9AF0000, 0x89480000, 0x99690000,
+      0xA90A0000, 0xB92B0000, 0x5AF50000, 0x4AD40000, 0x7AB70000, 0x6A960000,
+      0x1A710000, 0x0A500000, 0x3A330000, 0x2A120000, 0xDBFD0000, 0xCBDC0000,
+      0xFBBF0000, 0xEB9E0000, 0x9B790000, 0x8B580000, 0xBB3B0000, 0xAB1A0000,
+      0x6CA60000, 0x7C870000, 0x4CE40000, 0x5CC50000, 0x2C220000, 0x3C030000,
+      0x0C600000, 0x1C410000, 0xEDAE0000, 0xFD8F0000, 0xCDEC0000, 0xDDCD0000,
+      0xAD2A0000, 0xBD0B0000, 0x8D680000, 0x9D490000, 0x7E970000, 0x6EB60000,
+      0x5ED50000, 0x4EF40000, 0x3E130000, 0x2E320000, 0x1E510000, 0x0E700000,
+      0xFF9F0000, 0xEFBE0000, 0xDFDD0000, 0xCFFC0000, 0xBF1B0000, 0xAF3A0000,
+      0x9F590000, 0x8F780000, 0x91880000, 0x81A90000, 0xB1CA0000, 0xA1EB0000,
+      0xD10C0000, 0xC12D0000, 0xF14E0000, 0xE16F0000, 0x10800000, 0x00A10000,
+      0x30C20000, 0x20E30000, 0x50040000, 0x40250000, 0x70460000, 0x60670000,
+      0x83B90000, 0x93980000, 0xA3FB0000, 0xB3DA0000, 0xC33D0000, 0xD31C0000,
+      0xE37F0000, 0xF35E0000, 0x02B10000, 0x12900000, 0x22F30000, 0x32D20000,
+      0x42350000, 0x52140000, 0x62770000, 0x72560000, 0xB5EA0000, 0xA5CB0000,
+      0x95A80000, 0x85890000, 0xF56E0000, 0xE54F0000, 0xD52C0000, 0xC50D0000,
+      0x34E20000, 0x24C30000, 0x14A00000, 0x04810000, 0x74660000, 0x64470000,
+      0x54240000, 0x44050000, 0xA7DB0000, 0xB7FA0000, 0x87990000, 0x97B80000,
+      0xE75F0000, 0xF77E0000, 0xC71D0000, 0xD73C0000, 0x26D30000, 0x36F20000,
+      0x06910000, 0x16B00000, 0x66570000, 0x76760000, 0x46150000, 0x56340000,
+      0xD94C0000, 0xC96D0000, 0xF90E0000, 0xE92F0000, 0x99C80000, 0x89E90000,
+      0xB98A0000, 0xA9AB0000, 0x58440000, 0x48650000, 0x78060000, 0x68270000,
+      0x18C00000, 0x08E10000, 0x38820000, 0x28A30000, 0xCB7D0000, 0xDB5C0000,
+      0xEB3F0000, 0xFB1E0000, 0x8BF90000, 0x9BD80000, 0xABBB0000, 0xBB9A0000,
+      0x4A750000, 0x5A540000, 0x6A370000, 0x7A160000, 0x0AF10000, 0x1AD00000,
+      0x2AB30000, 0x3A920000, 0xFD2E0000, 0xED0F0000, 0xDD6C0000, 0xCD4D0000,
+      0xBDAA0000, 0xAD8B0000, 0x9DE80000, 0x8DC90000, 0x7C260000, 0x6C070000,
+      0x5C640000, 0x4C450000, 0x3CA20000, 0x2C830000, 0x1CE00000, 0x0CC10000,
+      0xEF1F0000, 0xFF3E0000, 0xCF5D0000, 0xDF7C0000, 0xAF9B0000, 0xBFBA0000,
+      0x8FD90000, 0x9FF80000, 0x6E170000, 0x7E360000, 0x4E550000, 0x5E740000,
+      0x2E930000, 0x3EB20000, 0x0ED10000, 0x1EF00000
+   },
+   {  /* CIAADRVCRC_32 */
+      0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
+      0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
+      0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
+      0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+      0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9,
+      0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
+      0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+      0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+      0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423,
+      0xCFBA9599, 0xB8BDA50F, 0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924,
+      0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D, 0x76DC4190, 0x01DB7106,
+      0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+      0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D,
+      0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+      0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950,
+      0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+      0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7,
+      0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
+      0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9, 0x5005713C, 0x270241AA,
+      0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+      0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+      0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A,
+      0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84,
+      0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+      0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB,
+      0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC,
+      0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8, 0xA1D1937E,
+      0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+      0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55,
+      0x316E8EEF, 0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236,
+      0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28,
+      0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+      0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F,
+      0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38,
+      0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+      0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+      0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69,
+      0x616BFFD3, 0x166CCF45, 0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2,
+      0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC,
+      0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+      0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693,
+      0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+      0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+   }
+};
+
+#if ( ARCH == x86 )
+/** \brief tables of the 8 bytes steps, slice[k - 1][n] is the CRC of byte
+ ** n followed by k zeros */
+static uint32_t ciaaDriverCrc_slice[CIAADRVCRC_TYPES][7][256];
+
+/** \brief builds the slices once, also with several threads starting */
+static pthread_once_t ciaaDriverCrc_sliceOnce = PTHREAD_ONCE_INIT;
+#endif
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+#if ( ARCH == x86 )
+/** \brief builds the slices of all the CRC types */
+static void ciaaDriverCrc_buildSlices(void)
+{
+   uint32_t const * table;
+   uint32_t (* slice)[256];
+   uint32_t crc;
+   uint8_t type;
+   uint32_t loopi;
+   uint32_t loopj;
+
+   for(type = 0; type < CIAADRVCRC_TYPES; type++)
+   {
+      table = ciaaDriverCrc_table[type];
+      slice = ciaaDriverCrc_slice[type];
+
+      for(loopi = 0; loopi < 256; loopi++)
+      {
+         crc = table[loopi];
+         for(loopj = 0; loopj < 7; loopj++)
+         {
+            if(ciaaDriverCrc_param[type].reflected)
+            {
+               crc = (crc >> 8) ^ table[crc & 0xFF];
+            }
+            else
+            {
+               crc = (crc << 8) ^ table[crc >> 24];
+            }
+            slice[loopj][loopi] = crc;
+         }
+      }
+   }
+}
+#endif
+
+/*==================[external functions definition]==========================*/
+extern void ciaaDriverCrc_start(ciaaDriverCrc_contextType * context, uint8_t type)
+{
+#if ( ARCH == x86 )
+   pthread_once(&ciaaDriverCrc_sliceOnce, ciaaDriverCrc_buildSlices);
+#endif
+
+   context->type = type;
+   context->state = ciaaDriverCrc_param[type].init;
+}
+
+extern void ciaaDriverCrc_update(ciaaDriverCrc_contextType * context, uint8_t const * data, uint32_t size)
+{
+   uint32_t const * table = ciaaDriverCrc_table[context->type];
+   uint32_t crc = context->state;
+#if ( ARCH == x86 )
+   uint32_t (* slice)[256] = ciaaDriverCrc_slice[context->type];
+   uint32_t first;
+   uint32_t second;
+#endif
+
+   if(ciaaDriverCrc_param[context->type].reflected)
+   {
+#if ( ARCH == x86 )
+      for(; size >= 8; size -= 8, data += 8)
+      {
+         first = crc ^ ((uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+               ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+         second = (uint32_t)data[4] | ((uint32_t)data[5] << 8) |
+               ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+         crc = slice[6][first & 0xFF] ^ slice[5][(first >> 8) & 0xFF] ^
+               slice[4][(first >> 16) & 0xFF] ^ slice[3][first >> 24] ^
+               slice[2][second & 0xFF] ^ slice[1][(second >> 8) & 0xFF] ^
+               slice[0][(second >> 16) & 0xFF] ^ table[second >> 24];
+      }
+#endif
+      for(; size > 0; size--, data++)
+      {
+         crc = (crc >> 8) ^ table[(crc ^ *data) & 0xFF];
+      }
+   }
+   else
+   {
+#if ( ARCH == x86 )
+      for(; size >= 8; size -= 8, data += 8)
+      {
+         first = crc ^ (((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+               ((uint32_t)data[2] << 8) | (uint32_t)data[3]);
+         second = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) |
+               ((uint32_t)data[6] << 8) | (uint32_t)data[7];
+         crc = slice[6][first >> 24] ^ slice[5][(first >> 16) & 0xFF] ^
+               slice[4][(first >> 8) & 0xFF] ^ slice[3][first & 0xFF] ^
+               slice[2][second >> 24] ^ slice[1][(second >> 16) & 0xFF] ^
+               slice[0][(second >> 8) & 0xFF] ^ table[second & 0xFF];
+      }
+#endif
+      for(; size > 0; size--, data++)
+      {
+         crc = (crc << 8) ^ table[(crc >> 24) ^ *data];
+      }
+   }
+
+   context->state = crc;
+}
+
+extern uint32_t ciaaDriverCrc_finish(ciaaDriverCrc_contextType const * context)
+{
+   ciaaDriverCrc_paramType const * param = &ciaaDriverCrc_param[context->type];
+   uint32_t ret = context->state;
+
+   if(param->reflected == false)
+   {
+      ret >>= 32 - param->width;
+   }
+
+   return ret ^ param->xorout;
+}
+
+extern uint32_t ciaaDriverCrc_compute(uint8_t type, uint8_t const * data, uint32_t size)
+{
+   ciaaDriverCrc_contextType context;
+
+   ciaaDriverCrc_start(&context, type);
+   ciaaDriverCrc_update(&context, data, size);
+
+   return ciaaDriverCrc_finish(&context);
+}
+
+#endif /* !( ( ARCH == cortexM4 ) && ( CPUTYPE == lpc43xx ) ) */
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
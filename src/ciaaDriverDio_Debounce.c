@@ -0,0 +1,163 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Debounce of the DIO inputs
+ **
+ ** Platform independent filter used by the DIO drivers, see
+ ** ciaaDriverDio_Debounce.h.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup DIO DIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverDio_Debounce.h"
+#include "ciaaDriverDio_Ioctl.h"
+
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+extern void ciaaDriverDio_debounceInit(ciaaDriverDio_debounceStateType * state, uint8_t raw)
+{
+   state->raw = raw;
+   state->stable = raw;
+   state->integrator = 0;
+   state->window = 0;
+}
+
+extern void ciaaDriverDio_debounceConfig(ciaaDriverDio_debounceStateType * state,
+      uint8_t inputs, uint8_t mode, uint16_t count, uint64_t length, uint64_t now)
+{
+   uint8_t loopi;
+
+   state->integrator &= ~inputs;
+   state->window &= ~inputs;
+
+   for(loopi = 0; loopi < CIAADRVDIO_DEBOUNCE_INPUTS; loopi++)
+   {
+      if(inputs & (1 << loopi))
+      {
+         state->limit[loopi] = (count == 0) ? 1 : count;
+         state->count[loopi] = (state->stable & (1 << loopi)) ? state->limit[loopi] : 0;
+         state->length[loopi] = length;
+         state->changed[loopi] = now;
+      }
+   }
+
+   switch(mode)
+   {
+      case CIAADRVDIO_DEBOUNCE_INTEGRATOR:
+         state->integrator |= inputs;
+         break;
+
+      case CIAADRVDIO_DEBOUNCE_WINDOW:
+         state->window |= inputs;
+         break;
+
+      default:
+         /* the inputs follow the raw value again */
+         state->stable = (state->stable & ~inputs) | (state->raw & inputs);
+         break;
+   }
+}
+
+extern uint8_t ciaaDriverDio_debounceSample(ciaaDriverDio_debounceStateType * state,
+      uint8_t raw, uint64_t now, bool periodic)
+{
+   uint8_t filtered = state->integrator | state->window;
+   uint8_t changes = raw ^ state->raw;
+   uint8_t bit;
+   uint8_t loopi;
+
+   state->raw = raw;
+
+   for(loopi = 0; loopi < CIAADRVDIO_DEBOUNCE_INPUTS; loopi++)
+   {
+      bit = 1 << loopi;
+      if(changes & bit)
+      {
+         state->changed[loopi] = now;
+      }
+
+      if((state->integrator & bit) && periodic)
+      {
+         /* count up while high and down while low, switch at the ends */
+         if((raw & bit) && (state->count[loopi] < state->limit[loopi]))
+         {
+            state->count[loopi]++;
+         }
+         else if(((raw & bit) == 0) && (state->count[loopi] > 0))
+         {
+            state->count[loopi]--;
+         }
+
+         if(state->count[loopi] == state->limit[loopi])
+         {
+            state->stable |= bit;
+         }
+         else if(state->count[loopi] == 0)
+         {
+            state->stable &= ~bit;
+         }
+      }
+      else if((state->window & bit) && ((now - state->changed[loopi]) >= state->length[loopi]))
+      {
+         state->stable = (state->stable & ~bit) | (raw & bit);
+      }
+   }
+
+   state->stable = (state->stable & filtered) | (raw & ~filtered);
+
+   return state->stable;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
@@ -0,0 +1,123 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Trace recorder of the DIO and AIO Drivers
+ **
+ ** Platform independent ring, see ciaaDriverTrace.h.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup Trace Trace recorder
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverTrace.h"
+#include "ciaaPOSIX_string.h"
+
+/*==================[macros and definitions]=================================*/
+#ifdef CIAADRVTRACE_SIZE
+/** \brief ring, the header first so a debugger dump is a valid image */
+typedef struct {
+   ciaaDriverTrace_headerType header;                       /** <= header */
+   ciaaDriverTrace_recordType records[CIAADRVTRACE_SIZE];   /** <= records */
+} ciaaDriverTrace_ringType;
+#endif
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+#ifdef CIAADRVTRACE_SIZE
+/** \brief ring of records, not static so it can be dumped by symbol */
+ciaaDriverTrace_ringType ciaaDriverTrace_ring;
+#endif
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+#ifdef CIAADRVTRACE_SIZE
+extern void ciaaDriverTrace_init(uint32_t frequency)
+{
+   ciaaDriverTrace_headerType * header = &ciaaDriverTrace_ring.header;
+
+   if(header->magic != CIAADRVTRACE_MAGIC)
+   {
+      header->version = CIAADRVTRACE_VERSION;
+      header->frequency = frequency;
+      header->size = CIAADRVTRACE_SIZE;
+      header->head = 0;
+      header->magic = CIAADRVTRACE_MAGIC;
+   }
+}
+
+extern void ciaaDriverTrace_record(uint8_t source, uint16_t value, uint64_t timestamp)
+{
+   ciaaDriverTrace_recordType * record;
+   uint32_t slot;
+
+   slot = __atomic_fetch_add(&ciaaDriverTrace_ring.header.head, 1, __ATOMIC_RELAXED);
+   record = &ciaaDriverTrace_ring.records[slot & (CIAADRVTRACE_SIZE - 1)];
+   record->time = (uint32_t) timestamp;
+   record->timeHigh = (uint8_t) (timestamp >> 32);
+   record->source = source;
+   record->value = value;
+}
+#endif
+
+extern uint32_t ciaaDriverTrace_copy(uint8_t * buffer, uint32_t size)
+{
+   uint32_t ret = 0;
+
+#ifdef CIAADRVTRACE_SIZE
+   if(size >= sizeof(ciaaDriverTrace_ring))
+   {
+      ciaaPOSIX_memcpy(buffer, &ciaaDriverTrace_ring, sizeof(ciaaDriverTrace_ring));
+      ret = sizeof(ciaaDriverTrace_ring);
+   }
+#endif
+
+   return ret;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
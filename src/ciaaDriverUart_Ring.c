@@ -0,0 +1,146 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Receive ring of the UART Drivers
+ **
+ ** Platform independent index logic, see ciaaDriverUart_Ring.h.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup UART UART Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaDriverUart_Ring.h"
+#include "ciaaPOSIX_string.h"
+
+/*==================[macros and definitions]=================================*/
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+
+/*==================[external functions definition]==========================*/
+extern bool ciaaDriverUart_ringPut(uint8_t * ring, uint32_t mask, uint32_t * head,
+      uint32_t tail, uint8_t data)
+{
+   bool ret = false;
+
+   if((*head - tail) <= mask)
+   {
+      ring[*head & mask] = data;
+      (*head)++;
+      ret = true;
+   }
+
+   return ret;
+}
+
+extern uint32_t ciaaDriverUart_ringGet(uint8_t const * ring, uint32_t mask, uint32_t head,
+      uint32_t * tail, uint8_t * buffer, uint32_t size, uint32_t * overruns)
+{
+   uint32_t count = head - *tail;
+   uint32_t first;
+
+   if(count > (mask + 1))
+   {
+      /* the oldest bytes were overwritten */
+      *overruns += count - (mask + 1);
+      *tail += count - (mask + 1);
+      count = mask + 1;
+   }
+   if(count > size)
+   {
+      count = size;
+   }
+
+   /* copy up to the end of the ring and then from its start */
+   first = mask + 1 - (*tail & mask);
+   if(first > count)
+   {
+      first = count;
+   }
+   ciaaPOSIX_memcpy(buffer, &ring[*tail & mask], first);
+   ciaaPOSIX_memcpy(&buffer[first], ring, count - first);
+   *tail += count;
+
+   return count;
+}
+
+extern uint32_t ciaaDriverUart_ringLapped(uint32_t mask, uint32_t position, uint32_t start,
+      uint8_t * buffer, uint32_t count, uint32_t * overruns)
+{
+   /* bytes of the copy the writer reached once more */
+   int32_t lapped = (int32_t)(position - (mask + 1) - start);
+   uint32_t loopi;
+
+   if(lapped > (int32_t)count)
+   {
+      lapped = (int32_t)count;
+   }
+   if(lapped > 0)
+   {
+      *overruns += (uint32_t)lapped;
+      count -= (uint32_t)lapped;
+      for(loopi = 0; loopi < count; loopi++)
+      {
+         buffer[loopi] = buffer[loopi + (uint32_t)lapped];
+      }
+   }
+
+   return count;
+}
+
+extern uint32_t ciaaDriverUart_ringDmaHead(uint32_t head, uint32_t base, uint32_t block,
+      uint32_t remaining)
+{
+   uint32_t position = base + block - remaining;
+
+   return ((int32_t)(position - head) > 0) ? position : head;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
@@ -0,0 +1,295 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Host benchmark of the sample conversions of the AIO Drivers
+ **
+ ** Checks each kernel of ciaaDriverAio_Conv.c against a plain reference
+ ** and measures its rate. Built with the SIMD paths enabled by the target
+ ** flags and again without them for the comparison, e.g.:
+ **
+ **    gcc -O2 -I../inc -I../../posix/inc -o ciaaAioConvBench ciaaAioConvBench.c \
+ **       ../src/ciaaDriverAio_Conv.c
+ **    gcc -O2 -mno-sse2 ... (32 bits hosts) or -mavx2
+ **    ciaaAioConvBench
+ **
+ ** Returns 0 if all the kernels matched the reference.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup AIO AIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "ciaaDriverAio_Conv.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief samples per call, multiple of 4, plus 3 to run the tails */
+#define BENCH_SAMPLES         (4096 + 3)
+
+/** \brief calls per kernel */
+#define BENCH_CALLS           (20000)
+
+/** \brief flags or-ed to the dac registers */
+#define BENCH_DAC_FLAGS       (0x10000)
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief inputs, offset by one element to run unaligned */
+static uint32_t bench_reg[BENCH_SAMPLES + 1];
+static uint8_t bench_packed[BENCH_SAMPLES * 5 / 4 + 1];
+static int16_t bench_int16[BENCH_SAMPLES + 1];
+static float bench_float[BENCH_SAMPLES + 1];
+
+/** \brief outputs of the kernel and of the reference */
+static int16_t bench_outInt16[2][BENCH_SAMPLES + 1];
+static float bench_outFloat[2][BENCH_SAMPLES + 1];
+static uint32_t bench_outDac[2][BENCH_SAMPLES + 1];
+
+/** \brief count of kernels not matching the reference */
+static uint32_t bench_failed = 0;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static double bench_now(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static uint32_t bench_dacRef(int32_t sample)
+{
+   sample = (sample < 0) ? 0 : ((sample > CIAADRVAIO_CONV_MAX_10BITS) ? CIAADRVAIO_CONV_MAX_10BITS : sample);
+
+   return ((uint32_t) sample << CIAADRVAIO_CONV_REG_SHIFT) | BENCH_DAC_FLAGS;
+}
+
+static int32_t bench_roundRef(float sample)
+{
+   sample = (sample > 65535.0f) ? 65535.0f : ((sample < -65536.0f) ? -65536.0f : sample);
+
+   return (int32_t) ((sample < 0.0f) ? (sample - 0.5f) : (sample + 0.5f));
+}
+
+/** \brief fills the inputs with pseudo random samples, out of range ones
+ ** included */
+static void bench_fill(void)
+{
+   uint32_t seed = 1;
+   uint32_t loopi;
+
+   for(loopi = 0; loopi <= BENCH_SAMPLES; loopi++)
+   {
+      seed = seed * 1103515245 + 12345;
+      bench_reg[loopi] = seed;
+      bench_int16[loopi] = (int16_t) ((seed >> 8) % 1400) - 200;
+      bench_float[loopi] = ((float) (seed >> 8) / (1 << 24)) * 1400.0f - 200.0f;
+   }
+   for(loopi = 0; loopi < sizeof(bench_packed); loopi++)
+   {
+      seed = seed * 1103515245 + 12345;
+      bench_packed[loopi] = (uint8_t) (seed >> 16);
+   }
+   /* halves and far out of range values of the float conversion */
+   bench_float[1] = 2.5f;
+   bench_float[2] = -0.5f;
+   bench_float[3] = 1e9f;
+   bench_float[4] = -1e9f;
+}
+
+/** \brief the reference of each kernel, one sample at a time */
+static void bench_ref(uint32_t kernel, uint32_t count)
+{
+   uint32_t loopi;
+   uint8_t const * group;
+
+   for(loopi = 0; loopi < count; loopi++)
+   {
+      switch(kernel)
+      {
+         case 0:
+            bench_outInt16[1][loopi] = (int16_t) ((bench_reg[loopi + 1] >> CIAADRVAIO_CONV_REG_SHIFT) &
+                  CIAADRVAIO_CONV_MAX_10BITS);
+            break;
+
+         case 1:
+            group = &bench_packed[1 + (loopi / 4) * 5];
+            bench_outInt16[1][loopi] = (int16_t) ((((uint32_t) group[(loopi % 4) * 10 / 8] |
+                        ((uint32_t) group[(loopi % 4) * 10 / 8 + 1] << 8)) >> ((loopi % 4) * 2)) &
+                  CIAADRVAIO_CONV_MAX_10BITS);
+            break;
+
+         case 2:
+            bench_outFloat[1][loopi] = (float) bench_int16[loopi + 1] * 0.25f + 1.0f;
+            break;
+
+         case 3:
+            bench_outDac[1][loopi] = bench_dacRef(bench_int16[loopi + 1]);
+            break;
+
+         default:
+            bench_outDac[1][loopi] = bench_dacRef(bench_roundRef(bench_float[loopi + 1]));
+            break;
+      }
+   }
+}
+
+/** \brief runs a kernel once on the unaligned buffers */
+static void bench_kernel(uint32_t kernel, uint32_t count)
+{
+   switch(kernel)
+   {
+      case 0:
+         ciaaDriverAio_convRegToInt16(&bench_outInt16[0][1], &bench_reg[1], count);
+         break;
+
+      case 1:
+         ciaaDriverAio_convPacked10ToInt16(&bench_outInt16[0][1], &bench_packed[1], count & ~3u);
+         break;
+
+      case 2:
+         ciaaDriverAio_convInt16ToFloat(&bench_outFloat[0][1], &bench_int16[1], count, 0.25f, 1.0f);
+         break;
+
+      case 3:
+         ciaaDriverAio_convInt16ToDac(&bench_outDac[0][1], &bench_int16[1], count, BENCH_DAC_FLAGS);
+         break;
+
+      default:
+         ciaaDriverAio_convFloatToDac(&bench_outDac[0][1], &bench_float[1], count, BENCH_DAC_FLAGS);
+         break;
+   }
+}
+
+/** \brief compares the output of a kernel to the reference
+ **
+ ** \return 0 if equal
+ **/
+static int bench_compare(uint32_t kernel, uint32_t count)
+{
+   int ret;
+
+   if(kernel == 1)
+   {
+      count &= ~3u;
+   }
+
+   if(kernel < 2)
+   {
+      ret = memcmp(&bench_outInt16[0][1], bench_outInt16[1], count * sizeof(int16_t));
+   }
+   else if(kernel == 2)
+   {
+      ret = memcmp(&bench_outFloat[0][1], bench_outFloat[1], count * sizeof(float));
+   }
+   else
+   {
+      ret = memcmp(&bench_outDac[0][1], bench_outDac[1], count * sizeof(uint32_t));
+   }
+
+   return ret;
+}
+
+/*==================[external functions definition]==========================*/
+int main(void)
+{
+   static char const * const names[] = {
+      "RegToInt16", "Packed10ToInt16", "Int16ToFloat", "Int16ToDac", "FloatToDac"
+   };
+   uint32_t kernel;
+   uint32_t count;
+   uint32_t loopi;
+   double start;
+   double end;
+
+   bench_fill();
+
+   for(kernel = 0; kernel < sizeof(names) / sizeof(names[0]); kernel++)
+   {
+      /* every length up to some vectors, to cover the tails */
+      for(count = 0; count <= 64; count++)
+      {
+         memset(bench_outInt16, 0, sizeof(bench_outInt16));
+         memset(bench_outFloat, 0, sizeof(bench_outFloat));
+         memset(bench_outDac, 0, sizeof(bench_outDac));
+         bench_kernel(kernel, count);
+         bench_ref(kernel, count);
+         if(bench_compare(kernel, count) != 0)
+         {
+            fprintf(stderr, "%s does not match the reference for %u samples\n", names[kernel], count);
+            bench_failed++;
+         }
+      }
+
+      start = bench_now();
+      for(loopi = 0; loopi < BENCH_CALLS; loopi++)
+      {
+         bench_kernel(kernel, BENCH_SAMPLES);
+      }
+      end = bench_now();
+
+      bench_ref(kernel, BENCH_SAMPLES);
+      if(bench_compare(kernel, BENCH_SAMPLES) != 0)
+      {
+         fprintf(stderr, "%s does not match the reference\n", names[kernel]);
+         bench_failed++;
+      }
+
+      printf("%-16s %8.1f Msamples/s\n", names[kernel],
+            (double) BENCH_SAMPLES * BENCH_CALLS / (end - start) / 1e6);
+   }
+
+   printf("%s\n", (bench_failed == 0) ? "all kernels match" : "FAILED");
+
+   return (bench_failed == 0) ? 0 : 1;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
@@ -0,0 +1,624 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/** \brief Host model of the DAC dma lists of the lpc4337 AIO Drivers
+ **
+ ** Models the GPDMA channel walking the descriptors linked by
+ ** ciaaDriverAio_dacLink, loading each one when the previous one is
+ ** complete, and runs the driver updates of the stream and circular
+ ** modes against it:
+ ** - stream: the writes of any size filling the half not being output,
+ **   the halves primed before the start and the underruns, each half
+ **   output shall be the next samples written unless its underrun was
+ **   counted,
+ ** - circular: the new table linked after the last descriptor of the one
+ **   being output, also while that descriptor is already loaded and with
+ **   dma transfers between the stores of the link, each sample output
+ **   shall continue the table being output or start the new one after a
+ **   whole period, and the swap shall be confirmed once the new one is
+ **   output.
+ **
+ ** The samples are counted instead of bytes and the segments are short to
+ ** link several descriptors per table:
+ **
+ **    gcc -O2 -o ciaaAioDacModel ciaaAioDacModel.c
+ **    ciaaAioDacModel
+ **
+ ** Returns 0 if all the checks passed.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup AIO AIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*==================[macros and definitions]=================================*/
+/** \brief size of the buffer and max samples per descriptor, as
+ ** AIO_DAC_BUFFER_SIZE and AIO_DMA_MAX_TRANSFER of the driver */
+#define MODEL_BUFFER_SIZE     (64)
+#define MODEL_SEGMENT         (7)
+
+/** \brief descriptors per table and count of tables, as AIO_DAC_LLI_COUNT
+ ** and AIO_DAC_LLI_TABLES */
+#define MODEL_LLI_COUNT       ((MODEL_BUFFER_SIZE + MODEL_SEGMENT - 1) / MODEL_SEGMENT + 1)
+#define MODEL_LLI_TABLES      (2)
+
+/** \brief end of a list */
+#define MODEL_NONE            (0xffffffff)
+
+/** \brief samples output by each run and count of runs */
+#define MODEL_STEPS           (200000)
+#define MODEL_RUNS            (16)
+
+/** \brief records a failed check */
+#define MODEL_CHECK(cond)     model_check((cond), #cond, __LINE__)
+
+/** \brief a descriptor, as DMA_TransferDescriptor_t */
+typedef struct {
+   uint32_t src;                       /** <= first sample */
+   uint32_t size;                      /** <= count of samples */
+   uint32_t lli;                       /** <= next descriptor, MODEL_NONE: end */
+   bool irq;                           /** <= terminal count irq */
+} model_lliType;
+
+/** \brief the dma channel, with the copy of the descriptor loaded */
+typedef struct {
+   bool enabled;
+   uint32_t src;                       /** <= next sample, as SRCADDR */
+   uint32_t left;                      /** <= samples left of the descriptor */
+   uint32_t lli;
+   bool irq;
+   bool pending;                       /** <= terminal count irq not handled */
+} model_channelType;
+
+/** \brief state of the driver, as in ciaaDriverDacControlType */
+typedef struct {
+   bool busy;
+   uint8_t fill;
+   uint8_t play;
+   bool ready[2];
+   uint32_t filled;
+   uint32_t length;
+   uint32_t underruns;
+   uint8_t table;
+   bool swap;
+   uint32_t first[MODEL_LLI_TABLES];
+   uint32_t count[MODEL_LLI_TABLES];
+   uint32_t last[MODEL_LLI_TABLES];
+   uint32_t confirmed;                 /** <= samples of the last confirmation */
+} model_dacType;
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief the DAC buffer, each sample holds its value */
+static uint32_t model_buffer[MODEL_BUFFER_SIZE];
+
+/** \brief the descriptor lists */
+static model_lliType model_lli[MODEL_LLI_TABLES * MODEL_LLI_COUNT];
+
+/** \brief the dma channel */
+static model_channelType model_channel;
+
+/** \brief samples output during a write, checked after it */
+static uint32_t model_output[4];
+static uint32_t model_outputs = 0;
+
+/** \brief count of failed checks */
+static uint32_t model_failed = 0;
+
+/** \brief state of the pseudo random generator */
+static uint32_t model_seed;
+
+/** \brief counts of underruns, of swaps and of swaps linked while the last
+ ** descriptor of the table was loaded */
+static uint32_t model_underruns = 0;
+static uint32_t model_swaps = 0;
+static uint32_t model_lateSwaps = 0;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void model_check(int cond, char const * text, int line)
+{
+   if((!cond) && (model_failed++ < 10))
+   {
+      fprintf(stderr, "line %d: %s failed\n", line, text);
+   }
+}
+
+static uint32_t model_random(uint32_t range)
+{
+   model_seed = model_seed * 1103515245 + 12345;
+
+   return (model_seed >> 16) % range;
+}
+
+/** \brief the channel loads a descriptor */
+static void model_load(uint32_t index)
+{
+   model_channel.src = model_lli[index].src;
+   model_channel.left = model_lli[index].size;
+   model_channel.lli = model_lli[index].lli;
+   model_channel.irq = model_lli[index].irq;
+}
+
+/** \brief the channel outputs a sample
+ **
+ ** \return the sample, MODEL_NONE if the channel is disabled
+ **/
+static uint32_t model_dmaStep(void)
+{
+   uint32_t ret = MODEL_NONE;
+
+   if(model_channel.enabled)
+   {
+      ret = model_buffer[model_channel.src];
+      model_channel.src++;
+      model_channel.left--;
+      if(model_channel.left == 0)
+      {
+         model_channel.pending |= model_channel.irq;
+         if(model_channel.lli == MODEL_NONE)
+         {
+            model_channel.enabled = false;
+         }
+         else
+         {
+            model_load(model_channel.lli);
+         }
+      }
+   }
+
+   return ret;
+}
+
+/** \brief as ciaaDriverAio_dacStop */
+static void model_stop(model_dacType * dac)
+{
+   model_channel.enabled = false;
+   model_channel.pending = false;
+   dac->busy = false;
+   dac->fill = 0;
+   dac->play = 0;
+   dac->ready[0] = false;
+   dac->ready[1] = false;
+   dac->filled = 0;
+   dac->table = 0;
+   dac->swap = false;
+}
+
+/** \brief as ciaaDriverAio_dacLink
+ **
+ ** \return index of the last descriptor
+ **/
+static uint32_t model_link(uint8_t table, uint32_t first, uint32_t length, uint32_t segment,
+      bool irq, bool loop)
+{
+   uint32_t lli = table * MODEL_LLI_COUNT;
+   uint32_t offset = 0;
+   uint32_t n = 0;
+
+   while(offset < length)
+   {
+      model_lli[lli + n].src = first + offset;
+      model_lli[lli + n].size = ((length - offset) > segment) ? segment : (length - offset);
+      model_lli[lli + n].lli = lli + n + 1;
+      model_lli[lli + n].irq = irq;
+      offset += model_lli[lli + n].size;
+      n++;
+   }
+
+   MODEL_CHECK((n != 0) && (n <= MODEL_LLI_COUNT));
+   if(loop)
+   {
+      model_lli[lli + n - 1].lli = lli;
+   }
+   else
+   {
+      model_lli[lli + n - 1].lli = MODEL_NONE;
+      model_lli[lli + n - 1].irq = true;
+   }
+
+   return lli + n - 1;
+}
+
+/** \brief as ciaaDriverAio_dacStart */
+static void model_start(model_dacType * dac)
+{
+   model_load(dac->table * MODEL_LLI_COUNT);
+   model_channel.enabled = true;
+   model_channel.pending = false;
+   dac->busy = true;
+}
+
+/** \brief as ciaaDriverAio_dacIRQHandler in stream mode */
+static void model_streamIrq(model_dacType * dac)
+{
+   if((dac->busy) && (model_channel.pending))
+   {
+      model_channel.pending = false;
+      dac->ready[dac->play] = false;
+      dac->play ^= 1;
+      if(dac->ready[dac->play] == false)
+      {
+         dac->underruns++;
+         dac->ready[dac->play] = true;
+         dac->fill = dac->play ^ 1;
+         dac->filled = 0;
+      }
+      dac->confirmed = dac->length / 2;
+   }
+}
+
+/** \brief as ciaaDriverAio_write in stream mode
+ **
+ ** \return count of samples taken
+ **/
+static uint32_t model_streamWrite(model_dacType * dac, uint32_t value, uint32_t count)
+{
+   uint32_t half = dac->length / 2;
+   uint32_t ret = 0;
+
+   if(dac->ready[dac->fill] == false)
+   {
+      ret = ((half - dac->filled) < count) ? (half - dac->filled) : count;
+      while(count != 0)
+      {
+         count--;
+         if(count < ret)
+         {
+            model_buffer[dac->fill * half + dac->filled + count] = value + count;
+         }
+      }
+      dac->filled += ret;
+      if(dac->filled == half)
+      {
+         dac->ready[dac->fill] = true;
+         dac->fill ^= 1;
+         dac->filled = 0;
+      }
+
+      if((dac->busy == false) && (dac->ready[0]) && (dac->ready[1]))
+      {
+         dac->underruns = 0;
+         dac->play = 0;
+         model_link(0, 0, dac->length, half, true, true);
+         model_start(dac);
+      }
+   }
+
+   return ret;
+}
+
+/** \brief as ciaaDriverAio_dacIRQHandler in circular mode */
+static void model_circularIrq(model_dacType * dac)
+{
+   uint8_t next = dac->table ^ 1;
+
+   if((dac->busy) && (model_channel.pending))
+   {
+      model_channel.pending = false;
+      if((dac->swap) && ((model_channel.src - dac->first[next]) < dac->count[next]))
+      {
+         dac->table = next;
+         dac->swap = false;
+         dac->confirmed = dac->count[next];
+      }
+   }
+}
+
+/** \brief as ciaaDriverAio_write in circular mode, the table values are
+ ** tag << 16 | index
+ **
+ ** \param[out] restarted   the output was restarted with the new table
+ ** \return count of samples taken
+ **/
+static uint32_t model_circularWrite(model_dacType * dac, uint32_t tag, uint32_t count, bool * restarted)
+{
+   uint32_t ret = 0;
+   uint32_t loopi;
+   uint32_t between;
+   uint8_t next;
+
+   *restarted = false;
+   if((dac->swap) || (count == 0))
+   {
+   }
+   else if((dac->busy) && ((dac->count[dac->table] + count) <= MODEL_BUFFER_SIZE))
+   {
+      next = dac->table ^ 1;
+      dac->first[next] = (next == 0) ? 0 : (MODEL_BUFFER_SIZE - count);
+      dac->count[next] = count;
+      for(loopi = 0; loopi < count; loopi++)
+      {
+         model_buffer[dac->first[next] + loopi] = (tag << 16) | loopi;
+      }
+      ret = count;
+      dac->last[next] = model_link(next, dac->first[next], count, MODEL_SEGMENT, false, true);
+
+      if(model_channel.lli == (dac->table * MODEL_LLI_COUNT))
+      {
+         model_lateSwaps++;
+      }
+      dac->swap = true;
+      model_lli[dac->last[dac->table]].irq = true;
+      /* the dma goes on between the stores, its irq is masked */
+      for(between = model_random(3); between != 0; between--)
+      {
+         model_output[model_outputs++] = model_dmaStep();
+      }
+      model_lli[dac->last[dac->table]].lli = next * MODEL_LLI_COUNT;
+      model_swaps++;
+   }
+   else
+   {
+      model_stop(dac);
+      dac->first[0] = 0;
+      dac->count[0] = count;
+      for(loopi = 0; loopi < count; loopi++)
+      {
+         model_buffer[loopi] = (tag << 16) | loopi;
+      }
+      ret = count;
+      dac->last[0] = model_link(0, 0, count, MODEL_SEGMENT, false, true);
+      model_start(dac);
+      *restarted = true;
+   }
+
+   return ret;
+}
+
+/** \brief streams a run of samples written in chunks of 1 to chunk
+ ** samples, one write every period steps on average
+ **/
+static void model_stream(uint32_t length, uint32_t chunk, uint32_t period)
+{
+   model_dacType dac = { 0 };
+   uint32_t value = 1;
+   uint32_t half = length / 2;
+   uint32_t output = 0;
+   uint32_t fresh = 0;                 /** <= last sample of the last fresh half */
+   uint32_t start = 0;                 /** <= first sample of the half being output */
+   uint32_t sample;
+   uint32_t underruns = 0;
+   bool consecutive = true;
+   bool stale = false;
+   uint32_t step;
+
+   dac.length = length;
+   model_stop(&dac);
+
+   for(step = 0; step < MODEL_STEPS; step++)
+   {
+      if(model_random(period) == 0)
+      {
+         value += model_streamWrite(&dac, value, 1 + model_random(chunk));
+      }
+
+      sample = model_dmaStep();
+      if(sample != MODEL_NONE)
+      {
+         if((output % half) == 0)
+         {
+            start = sample;
+            consecutive = true;
+         }
+         else
+         {
+            consecutive = consecutive && (sample == (start + (output % half)));
+         }
+         output++;
+
+         if((output % half) == 0)
+         {
+            /* a whole half, fresh if it goes on with the samples written
+             * and its underrun was not counted */
+            if(consecutive && (start > fresh))
+            {
+               MODEL_CHECK(stale == false);
+               MODEL_CHECK((dac.underruns != 0) || (start == (fresh + 1)));
+               fresh = start + half - 1;
+            }
+            else
+            {
+               MODEL_CHECK(stale);
+            }
+            underruns = dac.underruns;
+            model_streamIrq(&dac);
+            stale = (dac.underruns != underruns);
+         }
+      }
+   }
+
+   MODEL_CHECK(output > (MODEL_STEPS / 2));
+   if(period == 1)
+   {
+      MODEL_CHECK(dac.underruns == 0);
+   }
+   model_underruns += dac.underruns;
+}
+
+/** \brief a run of random tables, written at random times while the
+ ** terminal count irqs are handled late
+ **/
+static void model_circular(void)
+{
+   model_dacType dac = { 0 };
+   uint32_t tag = 1;
+   uint32_t current = 0;               /** <= tag of the table being output */
+   uint32_t count = 0;                 /** <= its samples */
+   uint32_t index = 0;                 /** <= next index expected */
+   uint32_t swapped[2];                /** <= tags of the tables swapped in, in */
+   uint32_t swappedCount[2];           /** <= order, and their samples, the */
+   uint32_t swaps = 0;                 /** <= next one may be written once the */
+                                       /** <= first one is confirmed */
+   bool switching = false;             /** <= confirmed, the new table is next */
+   uint32_t latency = 0;
+   uint32_t sample;
+   uint32_t size;
+   uint32_t step;
+   uint32_t loopi;
+   bool restarted;
+
+   model_stop(&dac);
+
+   for(step = 0; step < MODEL_STEPS; step++)
+   {
+      model_outputs = 0;
+      if(model_random(64) == 0)
+      {
+         /* mostly tables which fit next to the one being output */
+         size = 1 + model_random((model_random(8) == 0) ? MODEL_BUFFER_SIZE : (MODEL_BUFFER_SIZE / 2));
+         if(model_circularWrite(&dac, tag, size, &restarted) != 0)
+         {
+            if(restarted)
+            {
+               current = tag;
+               count = size;
+               index = 0;
+               swaps = 0;
+               switching = false;
+            }
+            else
+            {
+               MODEL_CHECK(swaps < 2);
+               swapped[swaps] = tag;
+               swappedCount[swaps] = size;
+               swaps++;
+            }
+            tag++;
+         }
+         else
+         {
+            /* only refused until the swap is confirmed */
+            MODEL_CHECK(dac.swap);
+         }
+      }
+
+      /* the samples output during the write and one more */
+      model_output[model_outputs++] = model_dmaStep();
+      for(loopi = 0; loopi < model_outputs; loopi++)
+      {
+         sample = model_output[loopi];
+         if(sample != MODEL_NONE)
+         {
+            if((sample >> 16) != current)
+            {
+               /* the table swapped in, after a whole period */
+               MODEL_CHECK(swaps != 0);
+               MODEL_CHECK((sample >> 16) == swapped[0]);
+               MODEL_CHECK(index == 0);
+               current = swapped[0];
+               count = swappedCount[0];
+               swapped[0] = swapped[1];
+               swappedCount[0] = swappedCount[1];
+               swaps--;
+            }
+            else
+            {
+               /* once confirmed the new table is output */
+               MODEL_CHECK(switching == false);
+            }
+            switching = false;
+            MODEL_CHECK((sample & 0xffff) == index);
+            index = ((sample & 0xffff) + 1) % count;
+         }
+      }
+
+      /* the irq is handled some steps later */
+      if(model_channel.pending)
+      {
+         latency++;
+      }
+      if((latency > model_random(4)) || (model_random(8) == 0))
+      {
+         dac.confirmed = 0;
+         model_circularIrq(&dac);
+         if(dac.confirmed != 0)
+         {
+            /* the last table written, its first sample may be output */
+            MODEL_CHECK(swaps < 2);
+            MODEL_CHECK(dac.confirmed == ((swaps != 0) ? swappedCount[0] : count));
+            switching = (swaps != 0);
+         }
+         latency = 0;
+      }
+   }
+
+   /* the last swap completes */
+   for(step = 0; (step < (4 * MODEL_BUFFER_SIZE)) && (dac.swap); step++)
+   {
+      (void)model_dmaStep();
+      model_circularIrq(&dac);
+   }
+   MODEL_CHECK(dac.swap == false);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void)
+{
+   uint32_t loopi;
+
+   for(loopi = 0; loopi < MODEL_RUNS; loopi++)
+   {
+      model_seed = loopi;
+      /* a writer faster than the output never underruns */
+      model_stream(MODEL_BUFFER_SIZE, MODEL_BUFFER_SIZE, 1);
+      model_stream(2 * (1 + loopi), 3, 1);
+      /* a slower one does */
+      model_stream(MODEL_BUFFER_SIZE, 1 + loopi, 2 + (loopi % 3));
+      model_circular();
+   }
+
+   printf("%u runs, %u stream underruns, %u swaps, %u linked while the last descriptor was loaded\n",
+         MODEL_RUNS, model_underruns, model_swaps, model_lateSwaps);
+   printf("%s\n", (model_failed == 0) ? "all checks passed" : "FAILED");
+
+   return (model_failed == 0) ? 0 : 1;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
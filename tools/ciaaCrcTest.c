@@ -0,0 +1,220 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/** \brief Host test of the table CRC Driver
+ **
+ ** Checks ciaaDriverCrc_Table.c against the check values of the CRC
+ ** catalogue and against a bitwise reference over random buffers, at
+ ** unaligned addresses and added in random parts. Built for x86, which
+ ** uses the slicing-by-8 tables, and for another architecture, which uses
+ ** the byte table only:
+ **
+ **    gcc -O2 -DARCH=x86 -DCPUTYPE=ia64 -DCPU=none -I../inc -I../../posix/inc \
+ **       -o ciaaCrcTest ciaaCrcTest.c ../src/ciaaDriverCrc_Table.c -lpthread
+ **    gcc -O2 -DARCH=cortexM4 -DCPUTYPE=k60_120 -DCPU=mk60fx512vlq15 ...
+ **    ciaaCrcTest
+ **
+ ** Returns 0 if all the checks passed.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup CRC CRC Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ciaaDriverCrc.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief max size of the random buffers and count of them per type */
+#define TEST_SIZE             (300)
+#define TEST_BUFFERS          (2000)
+
+/** \brief records a failed check */
+#define TEST_CHECK(cond)      test_check((cond), #cond, __LINE__)
+
+/** \brief a CRC as given in the catalogue */
+typedef struct {
+   uint32_t poly;          /** <= polynomial, MSB first */
+   uint32_t init;          /** <= initial value */
+   uint32_t xorout;        /** <= final xor */
+   uint32_t check;         /** <= CRC of "123456789" */
+   uint8_t width;          /** <= bits of the CRC */
+   bool reflected;         /** <= input and output reflected */
+} test_referenceType;
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief the CRCs, indexed by CIAADRVCRC_* */
+static test_referenceType const test_reference[CIAADRVCRC_TYPES] = {
+   { 0x8005, 0xFFFF, 0x0000, 0x4B37, 16, true },                     /* CRC-16/MODBUS */
+   { 0x1021, 0xFFFF, 0x0000, 0x29B1, 16, false },                    /* CRC-16/CCITT-FALSE */
+   { 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, 0xCBF43926, 32, true }      /* CRC-32 */
+};
+
+/** \brief random bytes, one more to test unaligned buffers */
+static uint8_t test_buffer[TEST_SIZE + 1];
+
+/** \brief count of failed checks */
+static uint32_t test_failed = 0;
+
+/** \brief state of the pseudo random generator */
+static uint32_t test_seed = 1;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void test_check(int cond, char const * text, int line)
+{
+   if((!cond) && (test_failed++ < 10))
+   {
+      fprintf(stderr, "line %d: %s failed\n", line, text);
+   }
+}
+
+static uint32_t test_random(uint32_t range)
+{
+   test_seed = test_seed * 1103515245 + 12345;
+
+   return (test_seed >> 16) % range;
+}
+
+/** \brief reverses the lower width bits */
+static uint32_t test_reflect(uint32_t value, uint8_t width)
+{
+   uint32_t ret = 0;
+   uint8_t loopi;
+
+   for(loopi = 0; loopi < width; loopi++)
+   {
+      ret = (ret << 1) | ((value >> loopi) & 1);
+   }
+
+   return ret;
+}
+
+/** \brief bitwise CRC, MSB first with the bytes reflected as needed */
+static uint32_t test_crc(test_referenceType const * ref, uint8_t const * data, uint32_t size)
+{
+   uint32_t top = (uint32_t)1 << (ref->width - 1);
+   uint32_t mask = (ref->width == 32) ? 0xFFFFFFFF : ((top << 1) - 1);
+   uint32_t crc = ref->init;
+   uint32_t byte;
+   uint8_t loopi;
+
+   for(; size > 0; size--, data++)
+   {
+      byte = ref->reflected ? test_reflect(*data, 8) : *data;
+      crc ^= byte << (ref->width - 8);
+      for(loopi = 0; loopi < 8; loopi++)
+      {
+         crc = (crc & top) ? ((crc << 1) ^ ref->poly) : (crc << 1);
+      }
+      crc &= mask;
+   }
+   if(ref->reflected)
+   {
+      crc = test_reflect(crc, ref->width);
+   }
+
+   return (crc ^ ref->xorout) & mask;
+}
+
+/** \brief the CRC of the buffer added in random parts */
+static uint32_t test_parts(uint8_t type, uint8_t const * data, uint32_t size)
+{
+   ciaaDriverCrc_contextType context;
+   uint32_t part;
+
+   ciaaDriverCrc_start(&context, type);
+   while(size > 0)
+   {
+      part = test_random(size + 1);
+      ciaaDriverCrc_update(&context, data, part);
+      data += part;
+      size -= part;
+   }
+
+   return ciaaDriverCrc_finish(&context);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void)
+{
+   uint8_t const check[] = "123456789";
+   uint32_t loopi;
+   uint32_t size;
+   uint32_t offset;
+   uint8_t type;
+
+   for(loopi = 0; loopi < sizeof(test_buffer); loopi++)
+   {
+      test_buffer[loopi] = (uint8_t)test_random(256);
+   }
+
+   for(type = 0; type < CIAADRVCRC_TYPES; type++)
+   {
+      TEST_CHECK(test_crc(&test_reference[type], check, 9) == test_reference[type].check);
+      TEST_CHECK(ciaaDriverCrc_compute(type, check, 9) == test_reference[type].check);
+      TEST_CHECK(ciaaDriverCrc_compute(type, check, 0) == test_crc(&test_reference[type], check, 0));
+
+      for(loopi = 0; loopi < TEST_BUFFERS; loopi++)
+      {
+         size = test_random(TEST_SIZE + 1);
+         offset = test_random(2);
+         TEST_CHECK(ciaaDriverCrc_compute(type, &test_buffer[offset], size) ==
+               test_crc(&test_reference[type], &test_buffer[offset], size));
+         TEST_CHECK(test_parts(type, &test_buffer[offset], size) ==
+               test_crc(&test_reference[type], &test_buffer[offset], size));
+      }
+   }
+
+   printf("%u types, %u buffers each\n", CIAADRVCRC_TYPES, TEST_BUFFERS);
+   printf("%s\n", (test_failed == 0) ? "all checks passed" : "FAILED");
+
+   return (test_failed == 0) ? 0 : 1;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
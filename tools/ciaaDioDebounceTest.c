@@ -0,0 +1,233 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/** \brief Host test of the debounce of the DIO inputs
+ **
+ ** Runs ciaaDriverDio_Debounce.c through the integrator counting up and
+ ** down and switching only at its ends, the time windows shorter and
+ ** longer than the pulses, followed by the periodic samples and by the
+ ** changes alone, and the reconfiguration of filtered inputs, back to no
+ ** filter among them:
+ **
+ **    gcc -O2 -I../inc -I../../posix/inc -o ciaaDioDebounceTest \
+ **       ciaaDioDebounceTest.c ../src/ciaaDriverDio_Debounce.c
+ **    ciaaDioDebounceTest
+ **
+ ** Returns 0 if all the checks passed.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup DIO DIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ciaaDriverDio_Debounce.h"
+#include "ciaaDriverDio_Ioctl.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief records a failed check */
+#define TEST_CHECK(cond)      test_check((cond), #cond, __LINE__)
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief count of failed checks */
+static uint32_t test_failed = 0;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void test_check(int cond, char const * text, int line)
+{
+   if((!cond) && (test_failed++ < 10))
+   {
+      fprintf(stderr, "line %d: %s failed\n", line, text);
+   }
+}
+
+/** \brief the integrator of input 0 counts 4 periodic samples */
+static void test_integrator(void)
+{
+   ciaaDriverDio_debounceStateType state;
+   uint8_t loopi;
+
+   ciaaDriverDio_debounceInit(&state, 0x00);
+   ciaaDriverDio_debounceConfig(&state, 0x01, CIAADRVDIO_DEBOUNCE_INTEGRATOR, 4, 0, 0);
+
+   /* up to the top, the other inputs follow the raw value */
+   for(loopi = 1; loopi < 4; loopi++)
+   {
+      TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x81, loopi, true) == 0x80);
+   }
+   /* the changes alone do not step it */
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x01, 4, false) == 0x00);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x01, 5, true) == 0x01);
+   TEST_CHECK(state.count[0] == 4);
+
+   /* a short drop counts down and back up without switching */
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 6, true) == 0x01);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 7, true) == 0x01);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x01, 8, true) == 0x01);
+   TEST_CHECK(state.count[0] == 3);
+
+   /* a bounce stays between the ends */
+   for(loopi = 0; loopi < 20; loopi++)
+   {
+      TEST_CHECK(ciaaDriverDio_debounceSample(&state, loopi & 1, 9 + loopi, true) == 0x01);
+   }
+
+   /* down to the bottom */
+   for(loopi = 0; loopi < 2; loopi++)
+   {
+      TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 30 + loopi, true) == 0x01);
+   }
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 32, true) == 0x00);
+   TEST_CHECK(state.count[0] == 0);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 33, true) == 0x00);
+   TEST_CHECK(state.count[0] == 0);
+}
+
+/** \brief the window of input 1 is 10 time units */
+static void test_window(bool periodic)
+{
+   ciaaDriverDio_debounceStateType state;
+   uint64_t now;
+
+   ciaaDriverDio_debounceInit(&state, 0x00);
+   ciaaDriverDio_debounceConfig(&state, 0x02, CIAADRVDIO_DEBOUNCE_WINDOW, 0, 10, 0);
+
+   /* a pulse shorter than the window is filtered */
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 100, false) == 0x00);
+   if(periodic)
+   {
+      for(now = 101; now < 105; now++)
+      {
+         TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, now, true) == 0x00);
+      }
+   }
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 105, false) == 0x00);
+   if(periodic)
+   {
+      for(now = 106; now < 130; now++)
+      {
+         TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, now, true) == 0x00);
+      }
+   }
+
+   /* a longer one passes, delayed by the window at both edges */
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 200, false) == 0x00);
+   if(periodic)
+   {
+      for(now = 201; now < 210; now++)
+      {
+         TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, now, true) == 0x00);
+      }
+   }
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 210, periodic) == 0x02);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 215, false) == 0x02);
+   if(periodic)
+   {
+      for(now = 216; now < 225; now++)
+      {
+         TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, now, true) == 0x02);
+      }
+   }
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 225, periodic) == 0x00);
+
+   /* a bounce restarts the window */
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 300, false) == 0x00);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 308, false) == 0x00);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 309, false) == 0x00);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 318, periodic) == 0x00);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 319, periodic) == 0x02);
+}
+
+/** \brief the filters are changed while the inputs differ from their
+ ** debounced value */
+static void test_reconfig(void)
+{
+   ciaaDriverDio_debounceStateType state;
+
+   ciaaDriverDio_debounceInit(&state, 0x03);
+   ciaaDriverDio_debounceConfig(&state, 0x01, CIAADRVDIO_DEBOUNCE_INTEGRATOR, 4, 0, 0);
+   ciaaDriverDio_debounceConfig(&state, 0x02, CIAADRVDIO_DEBOUNCE_WINDOW, 0, 10, 0);
+
+   /* both inputs drop, the filters keep them high */
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 1, true) == 0x03);
+
+   /* without filter they follow the raw value at once */
+   ciaaDriverDio_debounceConfig(&state, 0x03, CIAADRVDIO_DEBOUNCE_NONE, 0, 0, 2);
+   TEST_CHECK(state.stable == 0x00);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x01, 3, true) == 0x01);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 4, false) == 0x02);
+
+   /* a new integrator starts steady at the debounced value, at its top */
+   ciaaDriverDio_debounceConfig(&state, 0x02, CIAADRVDIO_DEBOUNCE_INTEGRATOR, 3, 0, 5);
+   TEST_CHECK(state.count[1] == 3);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 6, true) == 0x02);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 7, true) == 0x02);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x00, 8, true) == 0x00);
+
+   /* a new window starts at the time of the change of mode */
+   ciaaDriverDio_debounceConfig(&state, 0x02, CIAADRVDIO_DEBOUNCE_WINDOW, 0, 10, 20);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 21, false) == 0x00);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 30, true) == 0x00);
+   TEST_CHECK(ciaaDriverDio_debounceSample(&state, 0x02, 31, true) == 0x02);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void)
+{
+   test_integrator();
+   test_window(true);
+   test_window(false);
+   test_reconfig();
+
+   printf("%s\n", (test_failed == 0) ? "all checks passed" : "FAILED");
+
+   return (test_failed == 0) ? 0 : 1;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
@@ -0,0 +1,237 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/** \brief Host test of the GPIO character device backend of the x86 DIO
+ ** Driver
+ **
+ ** Runs ciaaDriverDio_Gpiochip.c against a gpio-sim chip of 16 lines with
+ ** the default lines of ciaaDriverDio_Gpiochip.h: the outputs are checked
+ ** through the value of the simulated lines, the inputs are driven
+ ** through their pull, which also raises the edges waited for. As root:
+ **
+ **    modprobe gpio-sim
+ **    mkdir -p /sys/kernel/config/gpio-sim/ciaa/bank0
+ **    echo 16 > /sys/kernel/config/gpio-sim/ciaa/bank0/num_lines
+ **    echo 1 > /sys/kernel/config/gpio-sim/ciaa/live
+ **    chip=$(cat /sys/kernel/config/gpio-sim/ciaa/bank0/chip_name)
+ **    dev=$(cat /sys/kernel/config/gpio-sim/ciaa/dev_name)
+ **
+ **    gcc -O2 -DCIAADRVDIO_GPIOCHIP -I../inc -I../x86/inc -I../../posix/inc \
+ **       -o ciaaDioGpiochipTest ciaaDioGpiochipTest.c \
+ **       ../x86/src/ciaaDriverDio_Gpiochip.c ../../posix/src/ciaaPOSIX_string.c
+ **    ciaaDioGpiochipTest /dev/$chip /sys/devices/platform/$dev/$chip
+ **
+ **    echo 0 > /sys/kernel/config/gpio-sim/ciaa/live
+ **    rmdir /sys/kernel/config/gpio-sim/ciaa/bank0 /sys/kernel/config/gpio-sim/ciaa
+ **
+ ** Returns 0 if all the checks passed.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup DIO DIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include "ciaaDriverDio_Gpiochip.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief lines of each direction */
+#define TEST_LINES            (8)
+
+/** \brief longest wait of an edge in milliseconds */
+#define TEST_TIMEOUT          (1000)
+
+/** \brief records a failed check */
+#define TEST_CHECK(cond)      test_check((cond), #cond, __LINE__)
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief lines of the inputs and the outputs, as the driver */
+static uint32_t const test_inputs[TEST_LINES] = CIAADRVDIO_GPIOCHIP_INPUTS;
+static uint32_t const test_outputs[TEST_LINES] = CIAADRVDIO_GPIOCHIP_OUTPUTS;
+
+/** \brief sysfs directory of the simulated chip */
+static char const * test_sim;
+
+/** \brief count of failed checks */
+static uint32_t test_failed = 0;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void test_check(int cond, char const * text, int line)
+{
+   if((!cond) && (test_failed++ < 10))
+   {
+      fprintf(stderr, "line %d: %s failed\n", line, text);
+   }
+}
+
+/** \brief opens an attribute of a simulated line */
+static FILE * test_open(uint32_t line, char const * attribute, char const * mode)
+{
+   char path[256];
+
+   snprintf(path, sizeof(path), "%s/sim_gpio%u/%s", test_sim, line, attribute);
+
+   return fopen(path, mode);
+}
+
+/** \brief pulls the simulated input lines as the bits of value */
+static void test_setInputs(uint8_t value)
+{
+   FILE * file;
+   uint8_t loopi;
+
+   for(loopi = 0; loopi < TEST_LINES; loopi++)
+   {
+      file = test_open(test_inputs[loopi], "pull", "w");
+      TEST_CHECK(file != NULL);
+      if(file != NULL)
+      {
+         fputs(((value >> loopi) & 1) ? "pull-up" : "pull-down", file);
+         fclose(file);
+      }
+   }
+}
+
+/** \brief reads the simulated output lines, bit n is the n-th one */
+static uint8_t test_getOutputs(void)
+{
+   FILE * file;
+   uint8_t ret = 0;
+   uint8_t loopi;
+   int value;
+
+   for(loopi = 0; loopi < TEST_LINES; loopi++)
+   {
+      file = test_open(test_outputs[loopi], "value", "r");
+      TEST_CHECK(file != NULL);
+      if(file != NULL)
+      {
+         if((fscanf(file, "%d", &value) == 1) && (value != 0))
+         {
+            ret |= (uint8_t)(1 << loopi);
+         }
+         fclose(file);
+      }
+   }
+
+   return ret;
+}
+
+/** \brief counts the edges until none arrives in timeout milliseconds */
+static int32_t test_edges(int32_t timeout)
+{
+   int32_t ret = 0;
+   int32_t count;
+
+   do
+   {
+      count = ciaaDriverDio_gpiochipWait(timeout);
+      TEST_CHECK(count >= 0);
+      if(count > 0)
+      {
+         ret += count;
+      }
+   } while(count > 0);
+
+   return ret;
+}
+
+/*==================[external functions definition]==========================*/
+int main(int argc, char ** argv)
+{
+   uint8_t const patterns[] = { 0x01, 0x80, 0xA5, 0x5A, 0xFF, 0x00 };
+   uint8_t value;
+   uint8_t loopi;
+
+   if(argc != 3)
+   {
+      fprintf(stderr, "usage: %s /dev/gpiochipN /sys/devices/platform/gpio-sim.M/gpiochipN\n", argv[0]);
+      return 1;
+   }
+   test_sim = argv[2];
+
+   /* the lines start pulled down and the outputs low */
+   test_setInputs(0x00);
+   if(ciaaDriverDio_gpiochipOpen(argv[1]) != 0)
+   {
+      fprintf(stderr, "the lines of %s can not be requested\n", argv[1]);
+      return 1;
+   }
+   TEST_CHECK(test_getOutputs() == 0x00);
+
+   /* all the outputs are written at once */
+   for(loopi = 0; loopi < sizeof(patterns); loopi++)
+   {
+      TEST_CHECK(ciaaDriverDio_gpiochipSetOutputs(patterns[loopi]) == 0);
+      TEST_CHECK(test_getOutputs() == patterns[loopi]);
+   }
+
+   /* all the inputs are read at once */
+   for(loopi = 0; loopi < sizeof(patterns); loopi++)
+   {
+      test_setInputs(patterns[loopi]);
+      TEST_CHECK(ciaaDriverDio_gpiochipGetInputs(&value) == 0);
+      TEST_CHECK(value == patterns[loopi]);
+   }
+   (void)test_edges(100);
+
+   /* no edge times out, each input changed is an edge */
+   TEST_CHECK(ciaaDriverDio_gpiochipWait(100) == 0);
+   test_setInputs(0x01);
+   TEST_CHECK(ciaaDriverDio_gpiochipWait(TEST_TIMEOUT) >= 1);
+   test_setInputs(0x0E);
+   TEST_CHECK(test_edges(100) == 4);
+   test_setInputs(0x00);
+   TEST_CHECK(test_edges(100) == 3);
+
+   printf("%s\n", (test_failed == 0) ? "all checks passed" : "FAILED");
+
+   return (test_failed == 0) ? 0 : 1;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
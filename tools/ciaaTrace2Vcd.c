@@ -0,0 +1,256 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Converts a trace ring of the DIO and AIO Drivers to VCD
+ **
+ ** Host tool, reads the image of ciaaDriverTrace_ring as copied by
+ ** ciaaDriverTrace_copy or dumped by a debugger, e.g. with gdb:
+ **
+ **    dump binary value trace.bin ciaaDriverTrace_ring
+ **
+ ** and writes a VCD file which can be viewed with GTKWave:
+ **
+ **    gcc -I../inc -I../../posix/inc -o ciaaTrace2Vcd ciaaTrace2Vcd.c
+ **    ciaaTrace2Vcd trace.bin trace.vcd
+ **
+ ** The image shall have the byte order of the host.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup Trace Trace recorder
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "ciaaDriverTrace.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief bits of the time of the records */
+#define TRACE_TIME_BITS       40
+#define TRACE_TIME_MASK       ((((uint64_t) 1) << TRACE_TIME_BITS) - 1)
+
+/** \brief record with the unwrapped time */
+typedef struct {
+   uint64_t time;          /** <= time in ticks */
+   uint32_t index;         /** <= position in the ring, keeps the order of
+                                  records with the same time */
+   uint8_t source;         /** <= one of CIAADRVTRACE_* */
+   uint16_t value;         /** <= value after the change */
+} trace_eventType;
+
+/** \brief a signal of the VCD file */
+typedef struct {
+   char const * name;      /** <= name of the signal */
+   uint8_t width;          /** <= bits of the signal */
+   char id;                /** <= identifier code in the VCD file */
+} trace_signalType;
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief signals, indexed by source */
+static trace_signalType const trace_signals[CIAADRVTRACE_SOURCES] = {
+   { "dio_in", 8, '!' },
+   { "dio_out", 8, '"' },
+   { "aio_in0", 16, '#' },
+   { "aio_in1", 16, '$' },
+};
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/** \brief orders the events by time, then by position in the ring */
+static int trace_compare(void const * a, void const * b)
+{
+   trace_eventType const * ea = a;
+   trace_eventType const * eb = b;
+   int ret;
+
+   if(ea->time != eb->time)
+   {
+      ret = (ea->time < eb->time) ? -1 : 1;
+   }
+   else
+   {
+      ret = (ea->index < eb->index) ? -1 : (ea->index > eb->index);
+   }
+
+   return ret;
+}
+
+/** \brief writes a value in binary */
+static void trace_writeValue(FILE * out, trace_signalType const * signal, uint16_t value)
+{
+   int bit;
+
+   fputc('b', out);
+   for(bit = signal->width - 1; bit >= 0; bit--)
+   {
+      fputc((value & (1 << bit)) ? '1' : '0', out);
+   }
+   fprintf(out, " %c\n", signal->id);
+}
+
+/** \brief converts ticks to nanoseconds without overflow */
+static uint64_t trace_toNs(uint64_t ticks, uint32_t frequency)
+{
+   return (ticks / frequency) * 1000000000 + (ticks % frequency) * 1000000000 / frequency;
+}
+
+/*==================[external functions definition]==========================*/
+int main(int argc, char * argv[])
+{
+   ciaaDriverTrace_headerType header;
+   ciaaDriverTrace_recordType * records = NULL;
+   trace_eventType * events = NULL;
+   FILE * in = NULL;
+   FILE * out = NULL;
+   uint64_t last = 0;
+   uint64_t time;
+   uint64_t ns;
+   uint64_t lastNs = 0;
+   uint32_t first;
+   uint32_t count = 0;
+   uint32_t loopi;
+   int ret = 1;
+
+   if(argc != 3)
+   {
+      fprintf(stderr, "usage: %s <ring image> <vcd file>\n", argv[0]);
+   }
+   else if((in = fopen(argv[1], "rb")) == NULL)
+   {
+      perror(argv[1]);
+   }
+   else if((fread(&header, sizeof(header), 1, in) != 1) ||
+           (header.magic != CIAADRVTRACE_MAGIC) || (header.version != CIAADRVTRACE_VERSION) ||
+           (header.size == 0) || ((header.size & (header.size - 1)) != 0) || (header.frequency == 0))
+   {
+      fprintf(stderr, "%s: not a trace ring\n", argv[1]);
+   }
+   else if(((records = malloc(header.size * sizeof(*records))) == NULL) ||
+           ((events = malloc(header.size * sizeof(*events))) == NULL))
+   {
+      fprintf(stderr, "out of memory\n");
+   }
+   else if(fread(records, sizeof(*records), header.size, in) != header.size)
+   {
+      fprintf(stderr, "%s: truncated ring\n", argv[1]);
+   }
+   else if((out = fopen(argv[2], "w")) == NULL)
+   {
+      perror(argv[2]);
+   }
+   else
+   {
+      /* oldest record first, the older ones were overwritten */
+      first = (header.head > header.size) ? (header.head - header.size) : 0;
+      for(loopi = first; loopi != header.head; loopi++)
+      {
+         ciaaDriverTrace_recordType const * record = &records[loopi & (header.size - 1)];
+
+         if(record->source < CIAADRVTRACE_SOURCES)
+         {
+            /* unwrap to the value nearest to the previous record, the
+             * records of the analog blocks are stamped back in time */
+            time = (last & ~TRACE_TIME_MASK) |
+                  (((uint64_t) record->timeHigh << 32) | record->time);
+            if((time + (TRACE_TIME_MASK >> 1) < last) && (count > 0))
+            {
+               time += TRACE_TIME_MASK + 1;
+            }
+            else if((time > last + (TRACE_TIME_MASK >> 1)) && (time > TRACE_TIME_MASK))
+            {
+               time -= TRACE_TIME_MASK + 1;
+            }
+            events[count].time = time;
+            events[count].index = loopi - first;
+            events[count].source = record->source;
+            events[count].value = record->value;
+            last = time;
+            count++;
+         }
+      }
+      qsort(events, count, sizeof(*events), trace_compare);
+
+      fprintf(out, "$comment ciaaTrace2Vcd, %u records of %u, %u Hz $end\n",
+            count, header.head, header.frequency);
+      fprintf(out, "$timescale 1ns $end\n$scope module ciaa $end\n");
+      for(loopi = 0; loopi < CIAADRVTRACE_SOURCES; loopi++)
+      {
+         fprintf(out, "$var wire %u %c %s $end\n", trace_signals[loopi].width,
+               trace_signals[loopi].id, trace_signals[loopi].name);
+      }
+      fprintf(out, "$upscope $end\n$enddefinitions $end\n");
+
+      /* times are relative to the oldest record */
+      for(loopi = 0; loopi < count; loopi++)
+      {
+         ns = trace_toNs(events[loopi].time - events[0].time, header.frequency);
+         if((loopi == 0) || (ns != lastNs))
+         {
+            fprintf(out, "#%llu\n", (unsigned long long) ns);
+            lastNs = ns;
+         }
+         trace_writeValue(out, &trace_signals[events[loopi].source], events[loopi].value);
+      }
+      ret = 0;
+   }
+
+   if(out != NULL)
+   {
+      fclose(out);
+   }
+   if(in != NULL)
+   {
+      fclose(in);
+   }
+   free(events);
+   free(records);
+
+   return ret;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
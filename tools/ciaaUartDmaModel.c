@@ -0,0 +1,501 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Host model of the dma reception of the lpc4337 UART Drivers
+ **
+ ** Models the receive FIFO of the UART and the GPDMA moving its bytes to
+ ** the receive ring through the loop of linked blocks, and runs the driver
+ ** updates of the head against them:
+ ** - the flush done on each UART irq, rxdmabase + block - remaining, also
+ **   while the dma already moves the next block and the block irq is
+ **   still pending, then the block is counted from its pending irq,
+ ** - the wait of the flush for the dma to empty the FIFO, so the last
+ **   bytes of a burst are published at its character timeout,
+ ** - the block irq and the reads of the upper layer, also when the dma
+ **   laps the ring during the copy.
+ **
+ ** The model checks that the head never goes back nor passes the bytes
+ ** written by the dma and that the bytes are read in order and complete:
+ **
+ **    gcc -O2 -I../inc -I../../posix/inc -o ciaaUartDmaModel ciaaUartDmaModel.c \
+ **       ../src/ciaaDriverUart_Ring.c ../../posix/src/ciaaPOSIX_string.c
+ **    ciaaUartDmaModel
+ **
+ ** Returns 0 if all the checks passed.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup UART UART Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include "ciaaDriverUart_Ring.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief size of the modelled ring and count of its dma blocks, as the
+ ** UART_RX_DMA_BLOCKS of the driver */
+#define MODEL_RING_SIZE       (64)
+#define MODEL_DMA_BLOCKS      (4)
+#define MODEL_BLOCK           (MODEL_RING_SIZE / MODEL_DMA_BLOCKS)
+
+/** \brief receive FIFO, depth and trigger level of the dma requests, as
+ ** UART_RX_FIFO_DEPTH and UART_FCR_TRG_LEV2 of the driver */
+#define MODEL_FIFO_DEPTH      (16)
+#define MODEL_FIFO_TRIGGER    (8)
+
+/** \brief polls without progress of the flush, as UART_RX_DMA_DRAIN_POLLS */
+#define MODEL_DRAIN_POLLS     (64)
+
+/** \brief steps of each run and count of runs */
+#define MODEL_STEPS           (200000)
+#define MODEL_RUNS            (16)
+
+/** \brief records a failed check */
+#define MODEL_CHECK(cond)     model_check((cond), #cond, __LINE__)
+
+/** \brief state of the modelled UART and dma channel */
+typedef struct {
+   uint32_t received;                  /** <= bytes received by the UART */
+   uint32_t written;                   /** <= bytes written by the dma */
+   uint32_t remaining;                 /** <= transfers left of the current block */
+   uint32_t pending;                   /** <= block irqs not handled */
+   bool timeout;                       /** <= character timeout, the dma takes
+                                            the bytes below the trigger level */
+} model_dmaType;
+
+/** \brief state of the driver, as in ciaaDriverUartControl */
+typedef struct {
+   uint32_t rxhead;
+   uint32_t rxtail;
+   uint32_t rxdmabase;
+   uint32_t overruns;
+} model_driverType;
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief the receive ring */
+static uint8_t model_ring[MODEL_RING_SIZE];
+
+/** \brief count of failed checks */
+static uint32_t model_failed = 0;
+
+/** \brief state of the pseudo random generator */
+static uint32_t model_seed;
+
+/** \brief count of flushes done with a block irq pending */
+static uint32_t model_pendingFlushes = 0;
+
+/** \brief count of bytes the flushes waited for */
+static uint32_t model_drained = 0;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void model_check(int cond, char const * text, int line)
+{
+   if((!cond) && (model_failed++ < 10))
+   {
+      fprintf(stderr, "line %d: %s failed\n", line, text);
+   }
+}
+
+static uint32_t model_random(uint32_t range)
+{
+   model_seed = model_seed * 1103515245 + 12345;
+
+   return (model_seed >> 16) % range;
+}
+
+/** \brief the UART receives count bytes, up to the room in the FIFO */
+static void model_receive(model_dmaType * dma, uint32_t count)
+{
+   uint32_t fifo = dma->received - dma->written;
+
+   dma->received += (count > MODEL_FIFO_DEPTH - fifo) ? (MODEL_FIFO_DEPTH - fifo) : count;
+   dma->timeout = false;
+}
+
+/** \brief the dma requests bytes from the FIFO */
+static bool model_dmaRequest(model_dmaType const * dma)
+{
+   uint32_t fifo = dma->received - dma->written;
+
+   return (fifo >= MODEL_FIFO_TRIGGER) || ((dma->timeout) && (fifo > 0));
+}
+
+/** \brief the dma moves up to count bytes while requested, one block irq
+ ** per completed block
+ **
+ ** The CONTROL register of the channel is reloaded from the next linked
+ ** block as soon as a block completes, so its remaining transfers count
+ ** from the next block while the irq is pending.
+ **/
+static void model_dmaTransfer(model_dmaType * dma, uint32_t count)
+{
+   while((count > 0) && (model_dmaRequest(dma)))
+   {
+      model_ring[dma->written % MODEL_RING_SIZE] = (uint8_t) dma->written;
+      dma->written++;
+      dma->remaining--;
+      if(dma->remaining == 0)
+      {
+         dma->remaining = MODEL_BLOCK;
+         dma->pending++;
+      }
+      count--;
+   }
+}
+
+/** \brief as ciaaDriverUart_rxDmaIRQHandler */
+static void model_irq(model_driverType * driver, model_dmaType * dma)
+{
+   uint32_t head;
+
+   if(dma->pending > 0)
+   {
+      dma->pending--;
+      driver->rxdmabase += MODEL_BLOCK;
+      head = ciaaDriverUart_ringDmaHead(driver->rxhead, driver->rxdmabase,
+            MODEL_BLOCK, MODEL_BLOCK);
+
+      MODEL_CHECK((int32_t)(head - driver->rxhead) >= 0);
+      MODEL_CHECK((int32_t)(dma->written - head) >= 0);
+      driver->rxhead = head;
+   }
+}
+
+/** \brief as ciaaDriverUart_rxDmaBlock
+ **
+ ** \return index of the start of the block being filled
+ **/
+static uint32_t model_block(model_driverType const * driver, model_dmaType const * dma)
+{
+   return driver->rxdmabase + dma->pending * MODEL_BLOCK;
+}
+
+/** \brief as ciaaDriverUart_rxDmaFlush
+ **
+ ** \param[in] drain      waits for the dma to empty the FIFO first
+ **/
+static void model_flush(model_driverType * driver, model_dmaType * dma, bool drain)
+{
+   uint32_t head;
+   uint32_t drained = 0;
+   uint32_t polls = 0;
+
+   /* the dma moves a byte per poll if requested, the block irq may
+    * preempt the wait */
+   while((drain) && (dma->received != dma->written) &&
+         (drained < MODEL_FIFO_DEPTH) && (polls < MODEL_DRAIN_POLLS))
+   {
+      if((dma->pending > 0) && (dma->remaining == 1))
+      {
+         model_irq(driver, dma);
+      }
+      if(model_dmaRequest(dma))
+      {
+         model_dmaTransfer(dma, 1);
+         drained++;
+         polls = 0;
+      }
+      else
+      {
+         polls++;
+      }
+   }
+   model_drained += drained;
+
+   head = ciaaDriverUart_ringDmaHead(driver->rxhead, model_block(driver, dma),
+         MODEL_BLOCK, dma->remaining);
+
+   if(dma->pending > 0)
+   {
+      model_pendingFlushes++;
+   }
+   /* the head is exact */
+   MODEL_CHECK(head == dma->written);
+
+   MODEL_CHECK((int32_t)(head - driver->rxhead) >= 0);
+   MODEL_CHECK((int32_t)(dma->written - head) >= 0);
+   driver->rxhead = head;
+}
+
+/** \brief as ciaaDriverUart_read, checks the bytes read
+ **
+ ** \param[in] lap        bytes the dma writes during the copy, before the
+ **                       copy reads them
+ ** \return count of bytes read
+ **/
+static uint32_t model_read(model_driverType * driver, model_dmaType * dma, uint32_t size,
+      uint32_t lap)
+{
+   uint8_t buffer[MODEL_RING_SIZE];
+   uint32_t tail = driver->rxtail;
+   uint32_t head = driver->rxhead;
+   uint32_t overruns = driver->overruns;
+   uint32_t count;
+   uint32_t loopi;
+
+   /* the head was sampled before the dma went on */
+   if(lap > 0)
+   {
+      dma->timeout = true;
+      while(lap > 0)
+      {
+         model_receive(dma, 1);
+         dma->timeout = true;
+         if((dma->pending > 0) && (dma->remaining == 1))
+         {
+            model_irq(driver, dma);
+         }
+         model_dmaTransfer(dma, 1);
+         lap--;
+      }
+   }
+
+   count = ciaaDriverUart_ringGet(model_ring, MODEL_RING_SIZE - 1, head, &tail, buffer,
+         size, &driver->overruns);
+   if(count != 0)
+   {
+      count = ciaaDriverUart_ringLapped(MODEL_RING_SIZE - 1,
+            model_block(driver, dma) + MODEL_BLOCK - dma->remaining,
+            tail - count, buffer, count, &driver->overruns);
+   }
+   driver->rxtail = tail;
+
+   /* the bytes left are the last ones copied */
+   for(loopi = 0; loopi < count; loopi++)
+   {
+      MODEL_CHECK(buffer[loopi] == (uint8_t)(tail - count + loopi));
+   }
+
+   return count + (driver->overruns - overruns);
+}
+
+/** \brief a run of random bytes, dma transfers, UART irqs, block irqs and
+ ** reads
+ **
+ ** The dma does not complete a block with the irq of the former one still
+ ** pending nor laps the reader, as in the driver the irq latency is far
+ ** below the time of a block and the ring is sized to the reads.
+ **
+ ** \param[in] start initial value of the indexes, to cross their wrap
+ **/
+static void model_run(uint32_t start)
+{
+   model_dmaType dma = { start, start, MODEL_BLOCK, 0, false };
+   model_driverType driver = { start, start, start, 0 };
+   uint32_t read = 0;
+   uint32_t room;
+   uint32_t loopi;
+
+   for(loopi = 0; loopi < MODEL_STEPS; loopi++)
+   {
+      switch(model_random(6))
+      {
+         case 0:
+            /* bytes on the line, up to the room left in the ring */
+            room = MODEL_RING_SIZE - (dma.received - driver.rxtail);
+            model_receive(&dma, model_random(room + 1));
+            break;
+
+         case 1:
+            /* completing one block at most without its irq */
+            room = dma.remaining + (1 - dma.pending) * MODEL_BLOCK - 1;
+            model_dmaTransfer(&dma, model_random(room + 1));
+            break;
+
+         case 2:
+            /* an irq of the port, e.g. the transmitter */
+            model_flush(&driver, &dma, true);
+            break;
+
+         case 3:
+            /* the character timeout */
+            if(dma.received != dma.written)
+            {
+               dma.timeout = true;
+               model_flush(&driver, &dma, true);
+            }
+            break;
+
+         case 4:
+            model_irq(&driver, &dma);
+            break;
+
+         default:
+            read += model_read(&driver, &dma, model_random(MODEL_RING_SIZE) + 1, 0);
+            break;
+      }
+   }
+
+   /* the end of the burst: the character timeout, the block irq and the
+    * last read */
+   dma.timeout = true;
+   model_flush(&driver, &dma, true);
+   model_irq(&driver, &dma);
+   read += model_read(&driver, &dma, MODEL_RING_SIZE, 0);
+
+   MODEL_CHECK(dma.received == dma.written);
+   MODEL_CHECK(driver.rxhead == dma.written);
+   MODEL_CHECK(read == dma.written - start);
+   MODEL_CHECK(driver.overruns == 0);
+}
+
+/** \brief the flush with the block irq pending, where rxdmabase + block -
+ ** remaining goes back */
+static void model_pendingBlock(void)
+{
+   model_dmaType dma = { 0, 0, MODEL_BLOCK, 0, true };
+   model_driverType driver = { 0, 0, 0, 0 };
+
+   /* 10 bytes of the first block flushed */
+   model_receive(&dma, 10);
+   dma.timeout = true;
+   model_dmaTransfer(&dma, 10);
+   model_flush(&driver, &dma, true);
+   MODEL_CHECK(driver.rxhead == 10);
+
+   /* the block completes and 3 bytes of the next one arrive before its
+    * irq: rxdmabase + block - remaining is 3, behind the head, the pending
+    * irq moves it to the next block */
+   model_receive(&dma, MODEL_BLOCK - 10 + 3);
+   dma.timeout = true;
+   model_dmaTransfer(&dma, MODEL_BLOCK - 10 + 3);
+   MODEL_CHECK(ciaaDriverUart_ringDmaHead(driver.rxhead, driver.rxdmabase, MODEL_BLOCK,
+            dma.remaining) == 10);
+   model_flush(&driver, &dma, true);
+   MODEL_CHECK(driver.rxhead == MODEL_BLOCK + 3);
+
+   /* the irq does not take the head back */
+   model_irq(&driver, &dma);
+   MODEL_CHECK(driver.rxhead == MODEL_BLOCK + 3);
+   model_flush(&driver, &dma, true);
+   MODEL_CHECK(driver.rxhead == MODEL_BLOCK + 3);
+}
+
+/** \brief the tail of a burst still in the FIFO at its character timeout */
+static void model_burstTail(void)
+{
+   model_dmaType dma = { 0, 0, MODEL_BLOCK, 0, false };
+   model_driverType driver = { 0, 0, 0, 0 };
+
+   /* 13 bytes, the dma takes them down to the trigger level */
+   model_receive(&dma, 13);
+   model_dmaTransfer(&dma, 13);
+   MODEL_CHECK(dma.written == 13 - (MODEL_FIFO_TRIGGER - 1));
+
+   /* without waiting the timeout irq only sees those, its source clears
+    * once the dma empties the FIFO */
+   dma.timeout = true;
+   model_flush(&driver, &dma, false);
+   MODEL_CHECK(driver.rxhead == 13 - (MODEL_FIFO_TRIGGER - 1));
+
+   /* waiting it publishes the whole burst */
+   model_flush(&driver, &dma, true);
+   MODEL_CHECK(driver.rxhead == 13);
+
+   /* below the trigger level without timeout the wait gives up */
+   model_receive(&dma, 3);
+   model_flush(&driver, &dma, true);
+   MODEL_CHECK(driver.rxhead == 13);
+   MODEL_CHECK(dma.written == 13);
+}
+
+/** \brief the dma laps the ring while the reader copies it */
+static void model_lap(void)
+{
+   model_dmaType dma = { 0, 0, MODEL_BLOCK, 0, false };
+   model_driverType driver = { 0, 0, 0, 0 };
+   uint32_t count;
+
+   /* the ring nearly full */
+   while(dma.written < MODEL_RING_SIZE - 4)
+   {
+      model_receive(&dma, 4);
+      dma.timeout = true;
+      model_dmaTransfer(&dma, MODEL_FIFO_TRIGGER);
+      model_irq(&driver, &dma);
+   }
+   dma.timeout = true;
+   model_flush(&driver, &dma, true);
+   MODEL_CHECK(driver.rxhead == MODEL_RING_SIZE - 4);
+
+   /* 10 bytes more during the copy, the first 6 copied are new ones */
+   count = model_read(&driver, &dma, MODEL_RING_SIZE, 10);
+   MODEL_CHECK(driver.overruns == 6);
+   MODEL_CHECK(count == MODEL_RING_SIZE - 4);
+
+   /* the next read gets the bytes of the lap */
+   dma.timeout = true;
+   model_flush(&driver, &dma, true);
+   MODEL_CHECK(model_read(&driver, &dma, MODEL_RING_SIZE, 0) == 10);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void)
+{
+   uint32_t loopi;
+
+   model_pendingBlock();
+   model_burstTail();
+   model_lap();
+
+   for(loopi = 0; loopi < MODEL_RUNS; loopi++)
+   {
+      model_seed = loopi;
+      /* half of the runs cross the wrap of the indexes */
+      model_run((loopi & 1) ? (0 - (loopi * 1000)) : 0);
+   }
+
+   printf("%u runs of %u steps, %u flushes with a block irq pending, %u bytes drained\n",
+         MODEL_RUNS, MODEL_STEPS, model_pendingFlushes, model_drained);
+   printf("%s\n", (model_failed == 0) ? "all checks passed" : "FAILED");
+
+   return (model_failed == 0) ? 0 : 1;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
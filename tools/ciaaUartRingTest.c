@@ -0,0 +1,287 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Host test and benchmark of the receive ring of the UART Drivers
+ **
+ ** Checks the index logic of ciaaDriverUart_Ring.c, wrap of the indexes
+ ** included, and measures its throughput, one byte put at a time as the
+ ** irq does and read in blocks:
+ **
+ **    gcc -O2 -I../inc -I../../posix/inc -o ciaaUartRingTest ciaaUartRingTest.c \
+ **       ../src/ciaaDriverUart_Ring.c ../../posix/src/ciaaPOSIX_string.c
+ **    ciaaUartRingTest
+ **
+ ** Returns 0 if all the checks passed.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup UART UART Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "ciaaDriverUart_Ring.h"
+
+/*==================[macros and definitions]=================================*/
+/** \brief size of the ring under test */
+#define TEST_RING_SIZE        (16)
+#define TEST_RING_MASK        (TEST_RING_SIZE - 1)
+
+/** \brief size of the ring and of the reads of the benchmark */
+#define BENCH_RING_SIZE       (256)
+#define BENCH_READ_SIZE       (64)
+
+/** \brief bytes moved by the benchmark */
+#define BENCH_BYTES           (64u * 1024u * 1024u)
+
+/** \brief records a failed check */
+#define TEST_CHECK(cond)      test_check((cond), #cond, __LINE__)
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief count of failed checks */
+static uint32_t test_failed = 0;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+static void test_check(int cond, char const * text, int line)
+{
+   if(!cond)
+   {
+      fprintf(stderr, "line %d: %s failed\n", line, text);
+      test_failed++;
+   }
+}
+
+/** \brief bytes in and out in order, the indexes wrap at 2^32 */
+static void test_wrap(void)
+{
+   uint8_t ring[TEST_RING_SIZE];
+   uint8_t buffer[TEST_RING_SIZE];
+   uint32_t head = 0xFFFFFFF0;
+   uint32_t tail = head;
+   uint32_t overruns = 0;
+   uint8_t in = 0;
+   uint8_t out = 0;
+   uint32_t count;
+   uint32_t loopi;
+   uint32_t loopj;
+
+   for(loopi = 0; loopi < 1000; loopi++)
+   {
+      /* chunks of 1 to 11 bytes read in blocks of 10 to 16, so the copy
+       * is split at every position of the ring */
+      for(loopj = 0; loopj < (loopi % 11) + 1; loopj++)
+      {
+         TEST_CHECK(ciaaDriverUart_ringPut(ring, TEST_RING_MASK, &head, tail, in));
+         in++;
+      }
+      count = ciaaDriverUart_ringGet(ring, TEST_RING_MASK, head, &tail, buffer,
+            (loopi % 7) + 10, &overruns);
+      for(loopj = 0; loopj < count; loopj++)
+      {
+         TEST_CHECK(buffer[loopj] == out);
+         out++;
+      }
+   }
+   count = ciaaDriverUart_ringGet(ring, TEST_RING_MASK, head, &tail, buffer, sizeof(buffer), &overruns);
+   for(loopj = 0; loopj < count; loopj++)
+   {
+      TEST_CHECK(buffer[loopj] == out);
+      out++;
+   }
+   TEST_CHECK(in == out);
+   TEST_CHECK(head == tail);
+   TEST_CHECK(overruns == 0);
+}
+
+/** \brief a full ring refuses bytes until it is read */
+static void test_full(void)
+{
+   uint8_t ring[TEST_RING_SIZE];
+   uint8_t buffer[TEST_RING_SIZE];
+   uint32_t head = 5;
+   uint32_t tail = 5;
+   uint32_t overruns = 0;
+   uint32_t loopi;
+
+   for(loopi = 0; loopi < TEST_RING_SIZE; loopi++)
+   {
+      TEST_CHECK(ciaaDriverUart_ringPut(ring, TEST_RING_MASK, &head, tail, (uint8_t) loopi));
+   }
+   TEST_CHECK(ciaaDriverUart_ringPut(ring, TEST_RING_MASK, &head, tail, 0xFF) == false);
+   TEST_CHECK(head - tail == TEST_RING_SIZE);
+
+   TEST_CHECK(ciaaDriverUart_ringGet(ring, TEST_RING_MASK, head, &tail, buffer, 1, &overruns) == 1);
+   TEST_CHECK(buffer[0] == 0);
+   TEST_CHECK(ciaaDriverUart_ringPut(ring, TEST_RING_MASK, &head, tail, 0xFF));
+   TEST_CHECK(ciaaDriverUart_ringPut(ring, TEST_RING_MASK, &head, tail, 0xFF) == false);
+
+   TEST_CHECK(ciaaDriverUart_ringGet(ring, TEST_RING_MASK, head, &tail, buffer, sizeof(buffer),
+            &overruns) == TEST_RING_SIZE);
+   TEST_CHECK(buffer[0] == 1);
+   TEST_CHECK(buffer[TEST_RING_SIZE - 1] == 0xFF);
+   TEST_CHECK(ciaaDriverUart_ringGet(ring, TEST_RING_MASK, head, &tail, buffer, sizeof(buffer),
+            &overruns) == 0);
+   TEST_CHECK(overruns == 0);
+}
+
+/** \brief the bytes overwritten by a writer not waiting, like the dma,
+ ** are counted and skipped */
+static void test_overrun(void)
+{
+   uint8_t ring[TEST_RING_SIZE];
+   uint8_t buffer[TEST_RING_SIZE];
+   uint32_t head = 0xFFFFFFFA;
+   uint32_t tail = head;
+   uint32_t overruns = 0;
+   uint32_t loopi;
+
+   for(loopi = 0; loopi < TEST_RING_SIZE + 5; loopi++)
+   {
+      ring[head & TEST_RING_MASK] = (uint8_t) loopi;
+      head++;
+   }
+   TEST_CHECK(ciaaDriverUart_ringGet(ring, TEST_RING_MASK, head, &tail, buffer, sizeof(buffer),
+            &overruns) == TEST_RING_SIZE);
+   TEST_CHECK(overruns == 5);
+   TEST_CHECK(buffer[0] == 5);
+   TEST_CHECK(buffer[TEST_RING_SIZE - 1] == TEST_RING_SIZE + 4);
+   TEST_CHECK(head == tail);
+}
+
+/** \brief the bytes a writer not waiting overwrote during a copy are
+ ** dropped from its start */
+static void test_lapped(void)
+{
+   uint8_t buffer[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+   uint32_t overruns = 0;
+
+   /* 8 bytes copied from index 0xFFFFFFFE of a ring of 16, the writer
+    * is still behind the end of the copy + 16 */
+   TEST_CHECK(ciaaDriverUart_ringLapped(TEST_RING_MASK, 0xFFFFFFFE + TEST_RING_SIZE, 0xFFFFFFFE,
+            buffer, 8, &overruns) == 8);
+   TEST_CHECK(overruns == 0);
+
+   /* the writer passed the first 3 bytes of the copy */
+   TEST_CHECK(ciaaDriverUart_ringLapped(TEST_RING_MASK, 0xFFFFFFFE + TEST_RING_SIZE + 3, 0xFFFFFFFE,
+            buffer, 8, &overruns) == 5);
+   TEST_CHECK(overruns == 3);
+   TEST_CHECK((buffer[0] == 3) && (buffer[4] == 7));
+
+   /* and all of them */
+   TEST_CHECK(ciaaDriverUart_ringLapped(TEST_RING_MASK, 40, 0, buffer, 5, &overruns) == 0);
+   TEST_CHECK(overruns == 8);
+}
+
+/** \brief the head follows the dma, also with a block irq pending */
+static void test_dmaHead(void)
+{
+   /* a block of 8 at 16 with 3 transfers done */
+   TEST_CHECK(ciaaDriverUart_ringDmaHead(16, 16, 8, 5) == 19);
+   /* the block completed and the next one started before its irq: the
+    * position seems to go back */
+   TEST_CHECK(ciaaDriverUart_ringDmaHead(23, 16, 8, 6) == 23);
+   /* the irq advanced the base */
+   TEST_CHECK(ciaaDriverUart_ringDmaHead(23, 24, 8, 8) == 24);
+   /* across the wrap of the indexes */
+   TEST_CHECK(ciaaDriverUart_ringDmaHead(0xFFFFFFFC, 0xFFFFFFF8, 8, 0) == 0);
+}
+
+/** \brief moves BENCH_BYTES through a ring
+ **
+ ** \return bytes per second
+ **/
+static double bench(void)
+{
+   static uint8_t ring[BENCH_RING_SIZE];
+   uint8_t buffer[BENCH_READ_SIZE];
+   struct timespec start;
+   struct timespec end;
+   uint32_t head = 0;
+   uint32_t tail = 0;
+   uint32_t overruns = 0;
+   uint32_t sum = 0;
+   uint32_t loopi;
+   uint32_t loopj;
+   uint32_t count;
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   for(loopi = 0; loopi < BENCH_BYTES; loopi += BENCH_READ_SIZE)
+   {
+      for(loopj = 0; loopj < BENCH_READ_SIZE; loopj++)
+      {
+         (void) ciaaDriverUart_ringPut(ring, BENCH_RING_SIZE - 1, &head, tail, (uint8_t) loopj);
+      }
+      count = ciaaDriverUart_ringGet(ring, BENCH_RING_SIZE - 1, head, &tail, buffer,
+            sizeof(buffer), &overruns);
+      sum += buffer[count - 1];
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   TEST_CHECK(sum == (BENCH_BYTES / BENCH_READ_SIZE) * (BENCH_READ_SIZE - 1));
+
+   return BENCH_BYTES / ((end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9);
+}
+
+/*==================[external functions definition]==========================*/
+int main(void)
+{
+   test_wrap();
+   test_full();
+   test_overrun();
+   test_lapped();
+   test_dmaHead();
+
+   printf("ring: %.1f MB/s, one put per byte and reads of %u bytes\n",
+         bench() / 1e6, BENCH_READ_SIZE);
+   printf("%s\n", (test_failed == 0) ? "all checks passed" : "FAILED");
+
+   return (test_failed == 0) ? 0 : 1;
+}
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
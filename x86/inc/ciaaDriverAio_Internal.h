@@ -57,6 +57,7 @@
 
 /*==================[inclusions]=============================================*/
 #include "ciaaPOSIX_stdint.h"
+#include "ciaaDriverAio_Filter.h"
 
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
@@ -76,6 +77,11 @@ typedef struct {
 typedef struct {
    ciaaDriverAio_bufferType rxBuffer;
    ciaaDriverAio_bufferType txBuffer;
+   ciaaDriverAio_filterType filter;
+   bool header;                  /** <= read returns a block header */
+   uint32_t rate;                /** <= sample rate in Hz, 0 if unknown */
+   uint32_t sequence;            /** <= sequence of the first sample in rxBuffer */
+   uint64_t timestamp;           /** <= CLOCK_MONOTONIC time of the rxBuffer data in ns */
 } ciaaDriverAio_uartType;
 
 /*==================[external data declaration]==============================*/
@@ -0,0 +1,131 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERDIO_GPIOCHIP_H_
+#define _CIAADRIVERDIO_GPIOCHIP_H_
+/** \brief Linux GPIO character device backend of the x86 DIO Driver
+ **
+ ** When CIAADRVDIO_GPIOCHIP is defined in the makefile, e.g. as
+ ** "/dev/gpiochip0", the x86 DIO Driver maps in/0 and out/0 to lines of
+ ** that chip through the GPIO v2 uAPI instead of the shared memory bank.
+ ** Bit n of in/0 and out/0 is the n-th line of CIAADRVDIO_GPIOCHIP_INPUTS
+ ** and CIAADRVDIO_GPIOCHIP_OUTPUTS. All the inputs are read and all the
+ ** outputs are written with a single ioctl, the edges of the inputs are
+ ** reported as line events. If the chip can not be opened the shared
+ ** memory bank is used, which is reported on stderr.
+ **
+ ** The default lines match a simulated chip of 16 lines, a gpio-sim bank
+ ** with num_lines 16 or:
+ **
+ **    modprobe gpio-mockup gpio_mockup_ranges=-1,16
+ **
+ ** tools/ciaaDioGpiochipTest.c runs this backend against a gpio-sim bank.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup DIO DIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief lines of in/0, bit 0 first, may be set in the makefile */
+#ifndef CIAADRVDIO_GPIOCHIP_INPUTS
+#define CIAADRVDIO_GPIOCHIP_INPUTS     { 0, 1, 2, 3, 4, 5, 6, 7 }
+#endif
+
+/** \brief lines of out/0, bit 0 first, may be set in the makefile */
+#ifndef CIAADRVDIO_GPIOCHIP_OUTPUTS
+#define CIAADRVDIO_GPIOCHIP_OUTPUTS    { 8, 9, 10, 11, 12, 13, 14, 15 }
+#endif
+
+/** \brief consumer label of the requested lines */
+#define CIAADRVDIO_GPIOCHIP_CONSUMER   "ciaaDio"
+
+/*==================[typedef]================================================*/
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+/** \brief requests the input and the output lines
+ **
+ ** The outputs start low.
+ **
+ ** \param[in] path      path of the chip
+ ** \return 0 on success, -1 on error
+ **/
+extern int32_t ciaaDriverDio_gpiochipOpen(char const * path);
+
+/** \brief reads all the inputs
+ **
+ ** \param[out] value    inputs, bit n is the n-th input line
+ ** \return 0 on success, -1 on error
+ **/
+extern int32_t ciaaDriverDio_gpiochipGetInputs(uint8_t * value);
+
+/** \brief writes all the outputs
+ **
+ ** \param[in] value     outputs, bit n is the n-th output line
+ ** \return 0 on success, -1 on error
+ **/
+extern int32_t ciaaDriverDio_gpiochipSetOutputs(uint8_t value);
+
+/** \brief waits for edges of the inputs
+ **
+ ** The pending line events are consumed.
+ **
+ ** \param[in] timeout   longest wait in milliseconds
+ ** \return count of edges, 0 on timeout, -1 on error
+ **/
+extern int32_t ciaaDriverDio_gpiochipWait(int32_t timeout);
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERDIO_GPIOCHIP_H_ */
@@ -0,0 +1,103 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _CIAADRIVERDIO_SHM_H_
+#define _CIAADRIVERDIO_SHM_H_
+/** \brief Shared memory GPIO bank of the x86 DIO Driver
+ **
+ ** The x86 DIO Driver maps in/0 and out/0 to a POSIX shared memory object
+ ** so other processes, like a plant model or a test, can drive the inputs
+ ** and watch the outputs. The object is created by whoever opens it first
+ ** and is not removed by the driver. Every word is accessed with atomic
+ ** operations.
+ **
+ ** The counters are futex words. Each change of the outputs increments
+ ** outputsSeq and wakes its waiters, the other processes shall do the
+ ** same with inputsSeq after changing the inputs. A process waits for the
+ ** outputs with FUTEX_WAIT on outputsSeq, not the private variant, from
+ ** the value it last saw.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup DIO DIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#include "ciaaPOSIX_stdint.h"
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==================[macros]=================================================*/
+/** \brief name of the shared memory object, may be set in the makefile */
+#ifndef CIAADRVDIO_SHM_NAME
+#define CIAADRVDIO_SHM_NAME      "/ciaaDio"
+#endif
+
+/** \brief written to magic once the driver mapped the bank */
+#define CIAADRVDIO_SHM_MAGIC     0x4F494443
+
+/** \brief version of the layout */
+#define CIAADRVDIO_SHM_VERSION   1
+
+/*==================[typedef]================================================*/
+/** \brief GPIO bank in the shared memory object */
+typedef struct {
+   uint32_t magic;         /** <= CIAADRVDIO_SHM_MAGIC */
+   uint32_t version;       /** <= CIAADRVDIO_SHM_VERSION */
+   uint32_t inputs;        /** <= in/0, written by the other processes */
+   uint32_t outputs;       /** <= out/0, written by the driver */
+   uint32_t inputsSeq;     /** <= count of changes of the inputs */
+   uint32_t outputsSeq;    /** <= count of changes of the outputs */
+} ciaaDriverDio_shmType;
+
+/*==================[external data declaration]==============================*/
+
+/*==================[external functions declaration]=========================*/
+
+/*==================[cplusplus]==============================================*/
+#ifdef __cplusplus
+}
+#endif
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
+#endif /* #ifndef _CIAADRIVERDIO_SHM_H_ */
@@ -63,6 +63,7 @@
 #include <netinet/in.h>
 #include "ciaaPOSIX_stdint.h"
 #include "ciaaPOSIX_stdbool.h"
+#include "ciaaDriverCrc.h"
 
 /*==================[cplusplus]==============================================*/
 #ifdef __cplusplus
@@ -123,6 +124,8 @@ typedef struct {
 typedef struct {
    ciaaDriverUart_bufferType rxBuffer;
    ciaaDriverUart_bufferType txBuffer;
+   ciaaDriverCrc_contextType * rxcrc;  /** <= CRC of the bytes read, NULL: none */
+   ciaaDriverCrc_contextType * txcrc;  /** <= CRC of the bytes written, NULL: none */
 #ifdef CIAADRVUART_ENABLE_FUNCIONALITY
    pthread_t handlerThread;
    int fileDescriptor;
@@ -58,9 +58,12 @@
 /*==================[inclusions]=============================================*/
 #include "ciaaDriverAio.h"
 #include "ciaaDriverAio_Internal.h"
+#include "ciaaDriverAio_Ioctl.h"
+#include "ciaaDriverTrace.h"
 #include "ciaaPOSIX_stdlib.h"
 #include "ciaaPOSIX_string.h"
 #include "os.h"
+#include <time.h>
 
 /*==================[macros and definitions]=================================*/
 /** \brief Pointer to Devices */
@@ -124,6 +127,11 @@ static void ciaaDriverAio_rxIndication(ciaaDevices_deviceType const * const devi
 {
    /* receive the data and forward to upper layer */
    ciaaDriverAio_uartType * uart = device->layer;
+   struct timespec now;
+
+   /* the data is stamped when it arrives */
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   uart->timestamp = (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
 
    ciaaSerialDevices_rxIndication(device->upLayer, uart->rxBuffer.length);
 }
@@ -150,13 +158,45 @@ extern int32_t ciaaDriverAio_close(ciaaDevices_deviceType const * const device)
 
 extern int32_t ciaaDriverAio_ioctl(ciaaDevices_deviceType const * const device, int32_t const request, void * param)
 {
-   return -1;
+   ciaaDriverAio_uartType * uart = device->layer;
+   int32_t ret = -1;
+
+   switch(request)
+   {
+      case CIAADRVAIO_IOCTL_SET_FILTER:
+         ret = ciaaDriverAio_filterInit(&uart->filter, (ciaaDriverAio_filterConfigType const *) param);
+         break;
+
+      case CIAADRVAIO_IOCTL_SET_HEADER:
+         uart->header = (bool)(intptr_t)param;
+         ret = 0;
+         break;
+
+      case ciaaPOSIX_IOCTL_SET_SAMPLE_RATE:
+         uart->rate = (uint32_t)(intptr_t)param;
+         ret = 0;
+         break;
+   }
+
+   return ret;
 }
 
 extern int32_t ciaaDriverAio_read(ciaaDevices_deviceType const * const device, uint8_t* buffer, uint32_t size)
 {
    /* receive the data and forward to upper layer */
    ciaaDriverAio_uartType * uart = device->layer;
+   ciaaDriverAio_headerType header;
+   uint8_t * data = buffer;
+#ifdef CIAADRVTRACE_SIZE
+   uint32_t loopi;
+#endif
+
+   if (uart->header)
+   {
+      /* the samples are stored after the header */
+      data = &buffer[sizeof(ciaaDriverAio_headerType)];
+      size = (size > sizeof(ciaaDriverAio_headerType)) ? (size - sizeof(ciaaDriverAio_headerType)) : 0;
+   }
 
    if (size > uart->rxBuffer.length)
    {
@@ -164,7 +204,37 @@ extern int32_t ciaaDriverAio_read(ciaaDevices_deviceType const * const device, u
    }
 
    /* copy received bytes to upper layer */
-   ciaaPOSIX_memcpy(buffer, &uart->rxBuffer.buffer[0], size);
+   ciaaPOSIX_memcpy(data, &uart->rxBuffer.buffer[0], size);
+
+   header.timestamp = uart->timestamp;
+   header.frequency = 1000000000;
+   header.period = (uart->rate == 0) ? 0 : (1000000000 / uart->rate);
+   header.sequence = uart->sequence;
+   uart->sequence += size / sizeof(int16_t);
+
+#ifdef CIAADRVTRACE_SIZE
+   /* the samples are traced before the filter */
+   for (loopi = 0; loopi < size / sizeof(int16_t); loopi++)
+   {
+      ciaaDriverTrace_record((device == &ciaaDriverAio_device0) ? CIAADRVTRACE_AIO_IN0 : CIAADRVTRACE_AIO_IN1,
+            ((uint16_t *) data)[loopi], header.timestamp + (uint64_t) loopi * header.period);
+   }
+#endif
+
+   if (uart->filter.enabled)
+   {
+      /* decimate in place */
+      size = sizeof(int16_t) * ciaaDriverAio_filterProcess(&uart->filter,
+            (int16_t *) data, size / sizeof(int16_t));
+      header.period *= uart->filter.oversampling;
+   }
+
+   if ((uart->header) && (size > 0))
+   {
+      header.size = size;
+      ciaaPOSIX_memcpy(buffer, &header, sizeof(ciaaDriverAio_headerType));
+      size += sizeof(ciaaDriverAio_headerType);
+   }
 
    return size;
 }
@@ -195,10 +265,14 @@ void ciaaDriverAio_init(void)
 {
    uint8_t loopi;
 
+   ciaaDriverTrace_init(1000000000);
+
    /* add uart driver to the list of devices */
    for(loopi = 0; loopi < ciaaDriverAioConst.countOfDevices; loopi++) {
       /* add each device */
       ciaaSerialDevices_addDriver(ciaaDriverAioConst.devices[loopi]);
+      /* filter stage disabled */
+      ciaaDriverAio_filterInit(&((ciaaDriverAio_uartType *) ciaaDriverAioConst.devices[loopi]->layer)->filter, NULL);
    }
 }
 
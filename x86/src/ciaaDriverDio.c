@@ -58,8 +58,26 @@
 /*==================[inclusions]=============================================*/
 #include "ciaaDriverDio.h"
 #include "ciaaDriverDio_Internal.h"
+#include "ciaaDriverDio_Ioctl.h"
+#include "ciaaDriverDio_Debounce.h"
+#include "ciaaDriverDio_Shm.h"
+#include "ciaaDriverDio_Gpiochip.h"
+#include "ciaaDriverTrace.h"
 #include "ciaaPOSIX_stdlib.h"
 #include "ciaaPOSIX_string.h"
+#include "os.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 /*==================[macros and definitions]=================================*/
 /** \brief Pointer to Devices */
@@ -68,6 +86,50 @@ typedef struct  {
    uint8_t countOfDevices;
 } ciaaDriverConstType;
 
+/** \brief debounce of the emulated inputs
+ **
+ ** A thread takes the periodic samples while any input is filtered, the
+ ** mutex serializes it with the reads and the configuration. The control
+ ** mutex serializes the configurations, so the sampler stopped by one is
+ ** joined before another one starts a new sampler.
+ **/
+typedef struct {
+   ciaaDriverDio_debounceStateType state; /** <= debounce */
+   pthread_mutex_t mutex;        /** <= protects the whole structure */
+   pthread_mutex_t control;      /** <= protects thread, taken before mutex */
+   pthread_t thread;             /** <= periodic sampler */
+   bool running;                 /** <= the sampler runs */
+   uint32_t period;              /** <= sampling period in microseconds */
+} ciaaDriverDio_debounceControlType;
+
+/** \brief size of the input event queue, power of two */
+#define DIO_EVENTS         (16)
+
+/** \brief longest wait of the watcher for a change of the inputs, so it
+ ** sees when the events are disabled, in nanoseconds */
+#define DIO_WATCH_TIMEOUT  (100000000)
+
+/** \brief input change events
+ **
+ ** The counterpart of the pin interrupts: a thread waits on the futex
+ ** inputsSeq of the GPIO bank, or for the line events of the GPIO chip,
+ ** and samples the inputs each time they change, the debounce sampler
+ ** also queues the changes it makes steady. When CIAADRVDIO_EVENTS_TASK
+ ** and CIAADRVDIO_EVENTS_EVENT are defined in the makefile each event is
+ ** signalled to that task. The queue is protected by the mutex of the
+ ** debounce.
+ **/
+typedef struct {
+   bool enabled;                 /** <= events enabled */
+   bool watching;                /** <= the watcher runs */
+   pthread_t thread;             /** <= watcher */
+   uint8_t last;                 /** <= inputs at the last event */
+   uint32_t sequence;            /** <= count of events, lost ones included */
+   uint32_t head;                /** <= next event written */
+   uint32_t tail;                /** <= next event read */
+   ciaaDriverDio_eventType events[DIO_EVENTS]; /** <= queue */
+} ciaaDriverDio_eventQueueType;
+
 /*==================[internal data declaration]==============================*/
 
 /*==================[internal functions declaration]=========================*/
@@ -111,6 +173,32 @@ static ciaaDriverConstType const ciaaDriverDioConst = {
    2
 };
 
+/** \brief GPIO bank in shared memory, NULL when it could not be mapped and
+ ** the layer data of the devices are used */
+static ciaaDriverDio_shmType * ciaaDriverDio_shm = NULL;
+
+/** \brief changes of the inputs written by the other processes, in the
+ ** GPIO bank when it is mapped */
+static uint32_t ciaaDriverDio_localInputsSeq = 0;
+static uint32_t * ciaaDriverDio_inputsSeq = &ciaaDriverDio_localInputsSeq;
+
+#ifdef CIAADRVDIO_GPIOCHIP
+/** \brief in/0 and out/0 are lines of the GPIO chip */
+static bool ciaaDriverDio_gpiochip = false;
+
+/** \brief serializes the writes of the outputs to the GPIO chip */
+static pthread_mutex_t ciaaDriverDio_gpiochipMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/** \brief input change events */
+static ciaaDriverDio_eventQueueType ciaaDriverDio_inputEvents;
+
+/** \brief debounce of in/0 */
+static ciaaDriverDio_debounceControlType ciaaDriverDio_debounce = {
+   .mutex = PTHREAD_MUTEX_INITIALIZER,
+   .control = PTHREAD_MUTEX_INITIALIZER
+};
+
 /*==================[external data definition]===============================*/
 /** \brief Dio 0 */
 ciaaDriverDio_dioType ciaaDriverDio_dio0;
@@ -119,6 +207,373 @@ ciaaDriverDio_dioType ciaaDriverDio_dio0;
 ciaaDriverDio_dioType ciaaDriverDio_dio1;
 
 /*==================[internal functions definition]==========================*/
+/** \brief current time in nanoseconds */
+static uint64_t ciaaDriverDio_now(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/** \brief maps the GPIO bank in shared memory
+ **
+ ** On success the layer data of the devices are moved to the bank, else
+ ** they stay in the process.
+ **/
+static void ciaaDriverDio_shmOpen(void)
+{
+   ciaaDriverDio_shmType * shm;
+   struct stat st;
+   int fd;
+
+   fd = shm_open(CIAADRVDIO_SHM_NAME, O_RDWR | O_CREAT, 0660);
+   if(fd >= 0)
+   {
+      if((fstat(fd, &st) == 0) &&
+         (((size_t) st.st_size >= sizeof(ciaaDriverDio_shmType)) ||
+          (ftruncate(fd, sizeof(ciaaDriverDio_shmType)) == 0)))
+      {
+         shm = mmap(NULL, sizeof(ciaaDriverDio_shmType), PROT_READ | PROT_WRITE,
+               MAP_SHARED, fd, 0);
+         if(shm != MAP_FAILED)
+         {
+            /* the inputs are kept, another process may have set them */
+            __atomic_store_n(&shm->version, CIAADRVDIO_SHM_VERSION, __ATOMIC_SEQ_CST);
+            __atomic_store_n(&shm->outputs, 0, __ATOMIC_SEQ_CST);
+            __atomic_store_n(&shm->magic, CIAADRVDIO_SHM_MAGIC, __ATOMIC_SEQ_CST);
+
+            ciaaDriverDio_device0.layer = &shm->inputs;
+            ciaaDriverDio_device1.layer = &shm->outputs;
+            ciaaDriverDio_inputsSeq = &shm->inputsSeq;
+            ciaaDriverDio_shm = shm;
+         }
+      }
+      /* the mapping stays valid */
+      close(fd);
+   }
+}
+
+/** \brief reads the raw inputs
+ **
+ ** The lines of the GPIO chip are copied to the layer data of in/0.
+ **/
+static uint8_t ciaaDriverDio_rawInputs(void)
+{
+   ciaaDriverDio_dioType * inputs =
+      (ciaaDriverDio_dioType *)ciaaDriverDio_device0.layer;
+#ifdef CIAADRVDIO_GPIOCHIP
+   uint8_t value;
+
+   if((ciaaDriverDio_gpiochip) &&
+      (ciaaDriverDio_gpiochipGetInputs(&value) == 0))
+   {
+      __atomic_store_n(inputs, value, __ATOMIC_SEQ_CST);
+   }
+#endif
+
+   return (uint8_t)__atomic_load_n(inputs, __ATOMIC_SEQ_CST);
+}
+
+/** \brief tells the other processes that the outputs changed
+ **
+ ** With the GPIO chip the outputs are written to its lines, the value is
+ ** loaded under the mutex so the last change is the one left.
+ **/
+static void ciaaDriverDio_publishOutputs(void)
+{
+#ifdef CIAADRVDIO_GPIOCHIP
+   if(ciaaDriverDio_gpiochip)
+   {
+      pthread_mutex_lock(&ciaaDriverDio_gpiochipMutex);
+      (void) ciaaDriverDio_gpiochipSetOutputs((uint8_t)__atomic_load_n(
+               (ciaaDriverDio_dioType *)ciaaDriverDio_device1.layer,
+               __ATOMIC_SEQ_CST));
+      pthread_mutex_unlock(&ciaaDriverDio_gpiochipMutex);
+   }
+#endif
+
+   ciaaDriverTrace_record(CIAADRVTRACE_DIO_OUT,
+         (uint8_t)__atomic_load_n(
+            (ciaaDriverDio_dioType *)ciaaDriverDio_device1.layer,
+            __ATOMIC_SEQ_CST),
+         ciaaDriverDio_now());
+
+   if(ciaaDriverDio_shm != NULL)
+   {
+      __atomic_fetch_add(&ciaaDriverDio_shm->outputsSeq, 1, __ATOMIC_SEQ_CST);
+      syscall(SYS_futex, &ciaaDriverDio_shm->outputsSeq, FUTEX_WAKE, INT_MAX,
+            NULL, NULL, 0);
+   }
+}
+
+/** \brief queues an input change event
+ **
+ ** Called with the mutex of the debounce taken. The event is lost when
+ ** the queue is full, its sequence number is skipped anyway.
+ **
+ ** \param[in] value     inputs after the change
+ ** \param[in] timestamp time of the change in nanoseconds
+ **/
+static void ciaaDriverDio_queueEvent(uint8_t value, uint64_t timestamp)
+{
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+   ciaaDriverDio_eventType * event;
+
+   if((queue->head - queue->tail) < DIO_EVENTS)
+   {
+      event = &(queue->events[queue->head & (DIO_EVENTS - 1)]);
+      event->timestamp = timestamp;
+      event->sequence = queue->sequence;
+      event->value = value;
+      event->changed = value ^ queue->last;
+      queue->head++;
+   }
+   queue->sequence++;
+   queue->last = value;
+}
+
+/** \brief reads the emulated inputs through the debounce
+ **
+ ** A change of the value is queued when the events are enabled. The raw
+ ** inputs are traced when they differ from the previous sample.
+ **
+ ** \param[in] periodic  the call is the periodic sample of the thread
+ ** \return the debounced inputs
+ **/
+static uint8_t ciaaDriverDio_sampleInputs(bool periodic)
+{
+   ciaaDriverDio_debounceControlType * debounce = &ciaaDriverDio_debounce;
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+   uint64_t now = ciaaDriverDio_now();
+   bool queued = false;
+   uint8_t value;
+   uint8_t raw;
+
+   pthread_mutex_lock(&debounce->mutex);
+   raw = ciaaDriverDio_rawInputs();
+   if(raw != debounce->state.raw)
+   {
+      ciaaDriverTrace_record(CIAADRVTRACE_DIO_IN, raw, now);
+   }
+   value = ciaaDriverDio_debounceSample(&debounce->state, raw, now, periodic);
+   if((queue->enabled) && (value != queue->last))
+   {
+      ciaaDriverDio_queueEvent(value, now);
+      queued = true;
+   }
+   pthread_mutex_unlock(&debounce->mutex);
+
+#ifdef CIAADRVDIO_EVENTS_TASK
+   if(queued)
+   {
+      SetEvent(CIAADRVDIO_EVENTS_TASK, CIAADRVDIO_EVENTS_EVENT);
+   }
+#else
+   (void) queued;
+#endif
+
+   return value;
+}
+
+/** \brief waits for the changes of the inputs written by other processes */
+static void * ciaaDriverDio_watchHandler(void * param)
+{
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+   struct timespec timeout = { 0, DIO_WATCH_TIMEOUT };
+   uint32_t seen = __atomic_load_n(ciaaDriverDio_inputsSeq, __ATOMIC_SEQ_CST);
+   uint32_t current;
+
+   while(__atomic_load_n(&queue->watching, __ATOMIC_SEQ_CST))
+   {
+      /* returns at once if the inputs changed since they were seen */
+      syscall(SYS_futex, ciaaDriverDio_inputsSeq, FUTEX_WAIT, seen, &timeout, NULL, 0);
+
+      current = __atomic_load_n(ciaaDriverDio_inputsSeq, __ATOMIC_SEQ_CST);
+      if(current != seen)
+      {
+         seen = current;
+         (void) ciaaDriverDio_sampleInputs(false);
+      }
+   }
+
+   return NULL;
+}
+
+#ifdef CIAADRVDIO_GPIOCHIP
+/** \brief waits for the line events of the inputs of the GPIO chip */
+static void * ciaaDriverDio_gpiochipWatchHandler(void * param)
+{
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+
+   while(__atomic_load_n(&queue->watching, __ATOMIC_SEQ_CST))
+   {
+      if(ciaaDriverDio_gpiochipWait(DIO_WATCH_TIMEOUT / 1000000) > 0)
+      {
+         (void) ciaaDriverDio_sampleInputs(false);
+      }
+   }
+
+   return NULL;
+}
+#endif
+
+/** \brief enables or disables the input change events
+ **
+ ** \param[in] enable    true to enable, the queued events are discarded
+ ** \return 0 on success, -1 if the watcher could not be started
+ **/
+static int32_t ciaaDriverDio_setEvents(bool enable)
+{
+   ciaaDriverDio_debounceControlType * debounce = &ciaaDriverDio_debounce;
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+   void * (* watchHandler)(void *) = ciaaDriverDio_watchHandler;
+   int32_t ret = 0;
+
+#ifdef CIAADRVDIO_GPIOCHIP
+   if(ciaaDriverDio_gpiochip)
+   {
+      watchHandler = ciaaDriverDio_gpiochipWatchHandler;
+   }
+#endif
+
+   pthread_mutex_lock(&debounce->mutex);
+   queue->enabled = enable;
+   if(enable)
+   {
+      queue->head = 0;
+      queue->tail = 0;
+      queue->sequence = 0;
+      queue->last = ciaaDriverDio_debounceSample(&debounce->state,
+            ciaaDriverDio_rawInputs(), ciaaDriverDio_now(), false);
+   }
+   pthread_mutex_unlock(&debounce->mutex);
+
+   if(enable && (queue->watching == false))
+   {
+      __atomic_store_n(&queue->watching, true, __ATOMIC_SEQ_CST);
+      if(pthread_create(&queue->thread, NULL, watchHandler, NULL) != 0)
+      {
+         __atomic_store_n(&queue->watching, false, __ATOMIC_SEQ_CST);
+         ret = -1;
+      }
+   }
+   else if((enable == false) && (queue->watching))
+   {
+      __atomic_store_n(&queue->watching, false, __ATOMIC_SEQ_CST);
+      syscall(SYS_futex, ciaaDriverDio_inputsSeq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+      pthread_join(queue->thread, NULL);
+   }
+
+   return ret;
+}
+
+/** \brief copies the queued events to the buffer of read */
+static int32_t ciaaDriverDio_readEvents(uint8_t * buffer, uint32_t size)
+{
+   ciaaDriverDio_debounceControlType * debounce = &ciaaDriverDio_debounce;
+   ciaaDriverDio_eventQueueType * queue = &ciaaDriverDio_inputEvents;
+   int32_t ret = 0;
+
+   pthread_mutex_lock(&debounce->mutex);
+   while(((ret + sizeof(ciaaDriverDio_eventType)) <= size) && (queue->tail != queue->head))
+   {
+      ciaaPOSIX_memcpy(&buffer[ret], &(queue->events[queue->tail & (DIO_EVENTS - 1)]),
+            sizeof(ciaaDriverDio_eventType));
+      queue->tail++;
+      ret += sizeof(ciaaDriverDio_eventType);
+   }
+   pthread_mutex_unlock(&debounce->mutex);
+
+   return ret;
+}
+
+/** \brief takes the periodic samples of the debounce */
+static void * ciaaDriverDio_debounceHandler(void * param)
+{
+   ciaaDriverDio_debounceControlType * debounce = &ciaaDriverDio_debounce;
+   struct timespec period;
+   bool running = true;
+
+   while(running)
+   {
+      pthread_mutex_lock(&debounce->mutex);
+      period.tv_sec = debounce->period / 1000000;
+      period.tv_nsec = (debounce->period % 1000000) * 1000;
+      running = debounce->running;
+      pthread_mutex_unlock(&debounce->mutex);
+
+      if(running)
+      {
+         nanosleep(&period, NULL);
+         (void) ciaaDriverDio_sampleInputs(true);
+      }
+   }
+
+   return NULL;
+}
+
+/** \brief sets the debounce of some inputs
+ **
+ ** The sampler thread is started with the first filtered input and
+ ** stopped when none is left.
+ **
+ ** \param[in] param     filter of the inputs
+ ** \return 0 if the filter was set, -1 if it is not valid
+ **/
+static int32_t ciaaDriverDio_setDebounce(ciaaDriverDio_debounceType const * param)
+{
+   ciaaDriverDio_debounceControlType * debounce = &ciaaDriverDio_debounce;
+   bool start = false;
+   bool stop = false;
+   int32_t ret = -1;
+
+   if((param != NULL) && (param->mode <= CIAADRVDIO_DEBOUNCE_WINDOW) &&
+      ((param->mode == CIAADRVDIO_DEBOUNCE_NONE) || (param->period != 0)))
+   {
+      /* the sampler only takes mutex, it is joined with control taken */
+      pthread_mutex_lock(&debounce->control);
+      pthread_mutex_lock(&debounce->mutex);
+
+      ciaaDriverDio_debounceConfig(&debounce->state, param->inputs, param->mode, param->count,
+            (uint64_t) param->window * 1000, ciaaDriverDio_now());
+
+      if(param->mode != CIAADRVDIO_DEBOUNCE_NONE)
+      {
+         debounce->period = param->period;
+         start = !debounce->running;
+         debounce->running = true;
+      }
+      else if((debounce->running) &&
+              ((debounce->state.integrator | debounce->state.window) == 0))
+      {
+         debounce->running = false;
+         stop = true;
+      }
+
+      pthread_mutex_unlock(&debounce->mutex);
+
+      ret = 0;
+      if(start)
+      {
+         if(pthread_create(&debounce->thread, NULL, ciaaDriverDio_debounceHandler, NULL) != 0)
+         {
+            pthread_mutex_lock(&debounce->mutex);
+            debounce->running = false;
+            pthread_mutex_unlock(&debounce->mutex);
+            ret = -1;
+         }
+      }
+      if(stop)
+      {
+         pthread_join(debounce->thread, NULL);
+      }
+
+      pthread_mutex_unlock(&debounce->control);
+   }
+
+   return ret;
+}
 
 /*==================[external functions definition]==========================*/
 extern ciaaDevices_deviceType * ciaaDriverDio_open(char const * path,
@@ -134,28 +589,145 @@ extern int32_t ciaaDriverDio_close(ciaaDevices_deviceType const * const device)
 
 extern int32_t ciaaDriverDio_ioctl(ciaaDevices_deviceType const * const device, int32_t const request, void * param)
 {
-   return -1;
+   ciaaDriverDio_dioType * dio = (ciaaDriverDio_dioType *)device->layer;
+   ciaaDriverDio_maskedType const * masked;
+   ciaaDriverDio_dioType value;
+   int32_t ret = -1;
+
+   if(device == ciaaDioDevices[0])
+   {
+      switch(request)
+      {
+         case CIAADRVDIO_IOCTL_SET_EVENTS:
+            ret = ciaaDriverDio_setEvents((bool)(intptr_t)param);
+            break;
+
+         case CIAADRVDIO_IOCTL_SET_DEBOUNCE:
+            ret = ciaaDriverDio_setDebounce((ciaaDriverDio_debounceType const *)param);
+            break;
+      }
+   }
+   /* the emulated outputs are changed with atomic operations, the
+    * counterpart of the SET, CLR and NOT registers */
+   else if(device == ciaaDioDevices[1])
+   {
+      switch(request)
+      {
+         case CIAADRVDIO_IOCTL_SET_BITS:
+            __atomic_fetch_or(dio, (uint8_t)(intptr_t)param, __ATOMIC_SEQ_CST);
+            ret = 0;
+            break;
+
+         case CIAADRVDIO_IOCTL_CLEAR_BITS:
+            __atomic_fetch_and(dio, ~(ciaaDriverDio_dioType)(uint8_t)(intptr_t)param, __ATOMIC_SEQ_CST);
+            ret = 0;
+            break;
+
+         case CIAADRVDIO_IOCTL_TOGGLE_BITS:
+            __atomic_fetch_xor(dio, (uint8_t)(intptr_t)param, __ATOMIC_SEQ_CST);
+            ret = 0;
+            break;
+
+         case CIAADRVDIO_IOCTL_WRITE_MASKED:
+            masked = (ciaaDriverDio_maskedType const *)param;
+            if(masked != NULL)
+            {
+               value = __atomic_load_n(dio, __ATOMIC_SEQ_CST);
+               while(!__atomic_compare_exchange_n(dio, &value,
+                        (value & ~(ciaaDriverDio_dioType)masked->mask) | (masked->value & masked->mask),
+                        false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+               {
+                  /* value was reloaded, retry */
+               }
+               ret = 0;
+            }
+            break;
+      }
+
+      if(ret == 0)
+      {
+         ciaaDriverDio_publishOutputs();
+      }
+   }
+   return ret;
 }
 
 extern int32_t ciaaDriverDio_read(ciaaDevices_deviceType const * const device, uint8_t* buffer, uint32_t size)
 {
-   return 0;
+   int32_t ret = -1;
+
+   if((size != 0) && (device == ciaaDioDevices[0]) && (ciaaDriverDio_inputEvents.enabled))
+   {
+      ret = ciaaDriverDio_readEvents(buffer, size);
+   }
+   else if((size != 0) && (device == ciaaDioDevices[0]))
+   {
+      /* the emulated inputs in layer data go through the debounce */
+      buffer[0] = ciaaDriverDio_sampleInputs(false);
+      ret = 1;
+   }
+   else if(size != 0)
+   {
+      /* read the emulated state from layer data */
+      buffer[0] = (uint8_t)__atomic_load_n((ciaaDriverDio_dioType *)device->layer, __ATOMIC_SEQ_CST);
+      ret = 1;
+   }
+   return ret;
 }
 
 extern int32_t ciaaDriverDio_write(ciaaDevices_deviceType const * const device, uint8_t const * const buffer, uint32_t const size)
 {
-   return 0;
+   int32_t ret = -1;
+
+   if((size != 0) && (device == ciaaDioDevices[1]))
+   {
+      /* save the emulated outputs in layer data */
+      __atomic_store_n((ciaaDriverDio_dioType *)device->layer, buffer[0], __ATOMIC_SEQ_CST);
+      ciaaDriverDio_publishOutputs();
+      ret = 1;
+   }
+   return ret;
 }
 
 void ciaaDriverDio_init(void)
 {
    uint8_t loopi;
+   char const * backend;
+#ifdef CIAADRVDIO_GPIOCHIP
+   int error;
+
+   /* the lines of the GPIO chip are used if they can be requested */
+   ciaaDriverDio_gpiochip = (ciaaDriverDio_gpiochipOpen(CIAADRVDIO_GPIOCHIP) == 0);
+   error = errno;
+   if(ciaaDriverDio_gpiochip == false)
+#endif
+   {
+      /* the layer data are moved to shared memory if it can be mapped */
+      ciaaDriverDio_shmOpen();
+
+      /* the backend fallen back to is reported */
+      backend = (ciaaDriverDio_shm != NULL) ? "the shared memory bank " CIAADRVDIO_SHM_NAME :
+         "the memory of the process";
+#ifdef CIAADRVDIO_GPIOCHIP
+      fprintf(stderr, "ciaaDio: lines of %s not requested (%s), using %s\n",
+            CIAADRVDIO_GPIOCHIP, strerror(error), backend);
+#else
+      if(ciaaDriverDio_shm == NULL)
+      {
+         fprintf(stderr, "ciaaDio: %s not mapped, using %s\n", CIAADRVDIO_SHM_NAME, backend);
+      }
+#endif
+   }
+   ciaaDriverTrace_init(1000000000);
 
    /* add dio driver to the list of devices */
    for(loopi = 0; loopi < ciaaDriverDioConst.countOfDevices; loopi++) {
       /* add each device */
       ciaaDioDevices_addDriver(ciaaDriverDioConst.devices[loopi]);
    }
+
+   /* no input is filtered until the debounce is set */
+   ciaaDriverDio_debounceInit(&ciaaDriverDio_debounce.state, ciaaDriverDio_rawInputs());
 }
 
 
@@ -0,0 +1,207 @@
+/* Copyright 2014, ACSE & CADIEEL
+ *    ACSE   : http://www.sase.com.ar/asociacion-civil-sistemas-embebidos/ciaa/
+ *    CADIEEL: http://www.cadieel.org.ar
+ *
+ * This file is part of CIAA Firmware.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/** \brief Linux GPIO character device backend of the x86 DIO Driver
+ **
+ ** Built only when CIAADRVDIO_GPIOCHIP is defined, see
+ ** ciaaDriverDio_Gpiochip.h.
+ **
+ **/
+
+/** \addtogroup CIAA_Firmware CIAA Firmware
+ ** @{ */
+/** \addtogroup Drivers CIAA Drivers
+ ** @{ */
+/** \addtogroup DIO DIO Drivers
+ ** @{ */
+
+/*==================[inclusions]=============================================*/
+#ifdef CIAADRVDIO_GPIOCHIP
+#include "ciaaDriverDio_Gpiochip.h"
+#include "ciaaPOSIX_string.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+/*==================[macros and definitions]=================================*/
+/** \brief count of lines of each request */
+#define DIO_GPIOCHIP_LINES    (8)
+
+/** \brief line events consumed by each read */
+#define DIO_GPIOCHIP_EVENTS   (16)
+
+/*==================[internal data declaration]==============================*/
+
+/*==================[internal functions declaration]=========================*/
+
+/*==================[internal data definition]===============================*/
+/** \brief lines of in/0 and out/0 */
+static uint32_t const ciaaDriverDio_gpiochipInputs[DIO_GPIOCHIP_LINES] = CIAADRVDIO_GPIOCHIP_INPUTS;
+static uint32_t const ciaaDriverDio_gpiochipOutputs[DIO_GPIOCHIP_LINES] = CIAADRVDIO_GPIOCHIP_OUTPUTS;
+
+/** \brief file descriptors of the line requests, -1 if not requested */
+static int ciaaDriverDio_gpiochipInputsFd = -1;
+static int ciaaDriverDio_gpiochipOutputsFd = -1;
+
+/*==================[external data definition]===============================*/
+
+/*==================[internal functions definition]==========================*/
+/** \brief requests 8 lines of the chip
+ **
+ ** \param[in] chip      file descriptor of the chip
+ ** \param[in] offsets   lines, bit 0 first
+ ** \param[in] flags     GPIO_V2_LINE_FLAG_* of all the lines
+ ** \return file descriptor of the request, -1 on error
+ **/
+static int ciaaDriverDio_gpiochipRequest(int chip, uint32_t const * offsets, uint64_t flags)
+{
+   /* the other fields are zero: no attributes, default event buffer */
+   struct gpio_v2_line_request request = {
+      .num_lines = DIO_GPIOCHIP_LINES,
+      .config.flags = flags,
+   };
+   int ret = -1;
+
+   ciaaPOSIX_memcpy(request.offsets, offsets, sizeof(uint32_t) * DIO_GPIOCHIP_LINES);
+   ciaaPOSIX_memcpy(request.consumer, CIAADRVDIO_GPIOCHIP_CONSUMER, sizeof(CIAADRVDIO_GPIOCHIP_CONSUMER));
+
+   if(ioctl(chip, GPIO_V2_GET_LINE_IOCTL, &request) == 0)
+   {
+      ret = request.fd;
+   }
+
+   return ret;
+}
+
+/*==================[external functions definition]==========================*/
+extern int32_t ciaaDriverDio_gpiochipOpen(char const * path)
+{
+   int32_t ret = -1;
+   int chip;
+
+   chip = open(path, O_RDWR | O_CLOEXEC);
+   if(chip >= 0)
+   {
+      ciaaDriverDio_gpiochipInputsFd = ciaaDriverDio_gpiochipRequest(chip, ciaaDriverDio_gpiochipInputs,
+            GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING);
+      ciaaDriverDio_gpiochipOutputsFd = ciaaDriverDio_gpiochipRequest(chip, ciaaDriverDio_gpiochipOutputs,
+            GPIO_V2_LINE_FLAG_OUTPUT);
+
+      if((ciaaDriverDio_gpiochipInputsFd >= 0) && (ciaaDriverDio_gpiochipOutputsFd >= 0))
+      {
+         ret = 0;
+      }
+      else
+      {
+         /* the lines are released with their requests */
+         if(ciaaDriverDio_gpiochipInputsFd >= 0)
+         {
+            close(ciaaDriverDio_gpiochipInputsFd);
+            ciaaDriverDio_gpiochipInputsFd = -1;
+         }
+         if(ciaaDriverDio_gpiochipOutputsFd >= 0)
+         {
+            close(ciaaDriverDio_gpiochipOutputsFd);
+            ciaaDriverDio_gpiochipOutputsFd = -1;
+         }
+      }
+      /* the requests stay valid */
+      close(chip);
+   }
+
+   return ret;
+}
+
+extern int32_t ciaaDriverDio_gpiochipGetInputs(uint8_t * value)
+{
+   struct gpio_v2_line_values values;
+   int32_t ret = -1;
+
+   values.bits = 0;
+   values.mask = (1 << DIO_GPIOCHIP_LINES) - 1;
+   if(ioctl(ciaaDriverDio_gpiochipInputsFd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == 0)
+   {
+      *value = (uint8_t) values.bits;
+      ret = 0;
+   }
+
+   return ret;
+}
+
+extern int32_t ciaaDriverDio_gpiochipSetOutputs(uint8_t value)
+{
+   struct gpio_v2_line_values values;
+   int32_t ret = -1;
+
+   values.bits = value;
+   values.mask = (1 << DIO_GPIOCHIP_LINES) - 1;
+   if(ioctl(ciaaDriverDio_gpiochipOutputsFd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) == 0)
+   {
+      ret = 0;
+   }
+
+   return ret;
+}
+
+extern int32_t ciaaDriverDio_gpiochipWait(int32_t timeout)
+{
+   struct gpio_v2_line_event events[DIO_GPIOCHIP_EVENTS];
+   struct pollfd fd;
+   ssize_t size;
+   int32_t ret;
+
+   fd.fd = ciaaDriverDio_gpiochipInputsFd;
+   fd.events = POLLIN;
+   ret = poll(&fd, 1, timeout);
+   if(ret > 0)
+   {
+      /* the edges are only counted, the inputs are read afterwards */
+      size = read(ciaaDriverDio_gpiochipInputsFd, events, sizeof(events));
+      ret = (size > 0) ? (int32_t) (size / sizeof(events[0])) : -1;
+   }
+   else if(ret < 0)
+   {
+      ret = -1;
+   }
+
+   return ret;
+}
+#endif /* #ifdef CIAADRVDIO_GPIOCHIP */
+
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/** @} doxygen end group definition */
+/*==================[end of file]============================================*/
@@ -61,6 +61,7 @@
 /*==================[inclusions]=============================================*/
 #include "ciaaDriverUart.h"
 #include "ciaaDriverUart_Internal.h"
+#include "ciaaDriverUart_Ioctl.h"
 #include "ciaaPOSIX_stdio.h"
 #include "ciaaPOSIX_string.h"
 #include "os.h"
@@ -467,8 +468,6 @@ extern int32_t ciaaDriverUart_close(ciaaDevices_deviceType const * const device)
 extern int32_t ciaaDriverUart_ioctl(ciaaDevices_deviceType const * const device, int32_t const request, void * param)
 {
    int32_t ret = -1;
-
-#ifdef CIAADRVUART_ENABLE_FUNCIONALITY
    ciaaDriverUart_uartType * uart = device->layer;
 
    if((device == ciaaDriverUartConst.devices[0]) ||
@@ -476,6 +475,7 @@ extern int32_t ciaaDriverUart_ioctl(ciaaDevices_deviceType const * const device,
    {
       switch(request)
       {
+#ifdef CIAADRVUART_ENABLE_FUNCIONALITY
          /* signal to start transmition */
          case ciaaPOSIX_IOCTL_STARTTX:
             if (uart->fileDescriptor)
@@ -494,10 +494,21 @@ extern int32_t ciaaDriverUart_ioctl(ciaaDevices_deviceType const * const device,
             }
          break;
 #endif /* CIAADRVUART_ENABLE_TRANSMITION */
+#endif /* CIAADRVUART_ENABLE_FUNCIONALITY */
 
+         /* add the bytes read to a CRC */
+         case CIAADRVUART_IOCTL_SET_RX_CRC:
+            uart->rxcrc = (ciaaDriverCrc_contextType *)param;
+            ret = 0;
+         break;
+
+         /* add the bytes written to a CRC */
+         case CIAADRVUART_IOCTL_SET_TX_CRC:
+            uart->txcrc = (ciaaDriverCrc_contextType *)param;
+            ret = 0;
+         break;
       }
    }
-#endif /* CIAADRVUART_ENABLE_FUNCIONALITY */
    return ret;
 }
 
@@ -514,6 +525,11 @@ extern int32_t ciaaDriverUart_read(ciaaDevices_deviceType const * const device,
    /* copy received bytes to upper layer */
    ciaaPOSIX_memcpy(buffer, &uart->rxBuffer.buffer[0], size);
 
+   if (uart->rxcrc != NULL)
+   {
+      ciaaDriverCrc_update(uart->rxcrc, buffer, size);
+   }
+
    return size;
 }
 
@@ -536,6 +552,11 @@ extern int32_t ciaaDriverUart_write(ciaaDevices_deviceType const * const device,
       uart->txBuffer.length = size;
    }
 
+   if ((uart->txcrc != NULL) && (ret > 0))
+   {
+      ciaaDriverCrc_update(uart->txcrc, buffer, ret);
+   }
+
    return ret;
 }
 